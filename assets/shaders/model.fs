@@ -4,6 +4,7 @@ out vec4 FragColor;
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoords;
+in vec3 InstanceColor;
 
 // Материальные свойства из Assimp
 uniform vec3 material_ambient;
@@ -14,6 +15,7 @@ uniform float material_shininess;
 // Переопределение материала
 uniform bool use_material_override;
 uniform vec3 material_override_diffuse;
+uniform bool use_instancing;            // Цвет берется из данных экземпляра
 
 // Улучшения для отображения материалов
 uniform float materialBrightness;
@@ -53,7 +55,7 @@ void main()
 
     if (use_material_override) {
         // Используем переопределенный цвет
-        finalMaterialColor = material_override_diffuse;
+        finalMaterialColor = use_instancing ? InstanceColor : material_override_diffuse;
     } else {
         // Используем цвет материала из модели (.mtl файла)
         finalMaterialColor = material_diffuse;
@@ -0,0 +1,335 @@
+#include "CargoTables.h"
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+
+namespace {
+
+// Столбцы таблиц (ColumnUserID); порядок совпадает с порядком TableSetupColumn
+enum TypeColumn { TYPE_SKU, TYPE_SIZE, TYPE_WEIGHT, TYPE_QUANTITY, TYPE_LOADED, TYPE_CLASS, TYPE_COLUMN_COUNT };
+enum ItemColumn { ITEM_INDEX, ITEM_SKU, ITEM_STOP, ITEM_STATUS, ITEM_COLUMN_COUNT };
+enum PlacementColumn {
+    PLACEMENT_ORDER, PLACEMENT_ITEM, PLACEMENT_SKU, PLACEMENT_X, PLACEMENT_Y, PLACEMENT_Z,
+    PLACEMENT_SIZE, PLACEMENT_ORIENTATION, PLACEMENT_COLUMN_COUNT
+};
+
+const char* const ORIENTATION_NAMES[ORIENTATION_COUNT] = {"WHD", "DHW", "WDH", "HDW", "DWH", "HWD"};
+
+const ImGuiTableFlags TABLE_FLAGS = ImGuiTableFlags_Sortable | ImGuiTableFlags_SortMulti | ImGuiTableFlags_RowBg |
+                                    ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_Resizable |
+                                    ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingFixedFit;
+
+template <typename T>
+int compareKeys(const T& a, const T& b) {
+    return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+} // namespace
+
+void CargoTables::setData(const Manifest& manifest, const LoadPlan& plan) {
+    this->manifest = &manifest;
+    this->plan = &plan;
+    rebuildSummary();
+    applyFilter();
+}
+
+void CargoTables::clear() {
+    manifest = nullptr;
+    plan = nullptr;
+    typeQuantity.clear();
+    typeLoaded.clear();
+    typeSkuRank.clear();
+    itemPlacement.clear();
+    typeVisible.clear();
+    for (auto& table : rows) table.clear();
+}
+
+void CargoTables::rebuildSummary() {
+    const size_t typeCount = manifest->types.size();
+    typeQuantity.assign(typeCount, 0);
+    typeLoaded.assign(typeCount, 0);
+    for (uint32_t type : manifest->items) typeQuantity[type]++;
+
+    itemPlacement.assign(manifest->items.size(), -1);
+    for (size_t i = 0; i < plan->placements.size(); i++) {
+        uint32_t item = plan->placements[i].item;
+        if (item >= itemPlacement.size()) continue;
+        itemPlacement[item] = static_cast<int32_t>(i);
+        typeLoaded[manifest->items[item]]++;
+    }
+
+    // Строки сравниваются один раз на тип, а не на каждую пару коробок при сортировке
+    std::vector<uint32_t> byName(typeCount);
+    std::iota(byName.begin(), byName.end(), 0u);
+    std::sort(byName.begin(), byName.end(), [this](uint32_t a, uint32_t b) {
+        return manifest->types[a].sku < manifest->types[b].sku;
+    });
+    typeSkuRank.resize(typeCount);
+    for (size_t rank = 0; rank < typeCount; rank++) typeSkuRank[byName[rank]] = static_cast<uint32_t>(rank);
+}
+
+void CargoTables::applyFilter() {
+    const size_t typeCount = manifest->types.size();
+    typeVisible.resize(typeCount);
+    for (size_t type = 0; type < typeCount; type++) {
+        typeVisible[type] = filter.PassFilter(manifest->types[type].sku.c_str()) ? 1 : 0;
+    }
+
+    std::vector<uint32_t>& types = rows[TABLE_TYPES];
+    types.clear();
+    for (uint32_t type = 0; type < typeCount; type++) {
+        if (typeVisible[type]) types.push_back(type);
+    }
+
+    std::vector<uint32_t>& items = rows[TABLE_ITEMS];
+    items.clear();
+    for (uint32_t item = 0; item < manifest->items.size(); item++) {
+        if (!typeVisible[manifest->items[item]]) continue;
+        if (onlyUnplaced && itemPlacement[item] >= 0) continue;
+        items.push_back(item);
+    }
+
+    std::vector<uint32_t>& placements = rows[TABLE_PLACEMENTS];
+    placements.clear();
+    for (uint32_t i = 0; i < plan->placements.size(); i++) {
+        uint32_t item = plan->placements[i].item;
+        if (item < manifest->items.size() && typeVisible[manifest->items[item]]) placements.push_back(i);
+    }
+
+    sortPending.fill(true);
+}
+
+void CargoTables::sortRows(Table table, const ImGuiTableSortSpecs* specs) {
+    auto compareTypes = [this](ImGuiID column, uint32_t a, uint32_t b) {
+        const BoxType& typeA = manifest->types[a];
+        const BoxType& typeB = manifest->types[b];
+        switch (column) {
+            case TYPE_SKU:      return compareKeys(typeSkuRank[a], typeSkuRank[b]);
+            case TYPE_SIZE:     return compareKeys(typeA.volume(), typeB.volume());
+            case TYPE_WEIGHT:   return compareKeys(typeA.weight, typeB.weight);
+            case TYPE_QUANTITY: return compareKeys(typeQuantity[a], typeQuantity[b]);
+            case TYPE_LOADED:   return compareKeys(typeLoaded[a], typeLoaded[b]);
+            case TYPE_CLASS:    return compareKeys(typeA.compatibilityClass, typeB.compatibilityClass);
+            default:            return 0;
+        }
+    };
+    auto compareItems = [this](ImGuiID column, uint32_t a, uint32_t b) {
+        switch (column) {
+            case ITEM_SKU:    return compareKeys(typeSkuRank[manifest->items[a]], typeSkuRank[manifest->items[b]]);
+            case ITEM_STOP:   return compareKeys(manifest->itemStops[a], manifest->itemStops[b]);
+            case ITEM_STATUS: return compareKeys(itemPlacement[a], itemPlacement[b]);
+            default:          return compareKeys(a, b);
+        }
+    };
+    auto comparePlacements = [this](ImGuiID column, uint32_t a, uint32_t b) {
+        const Placement& placementA = plan->placements[a];
+        const Placement& placementB = plan->placements[b];
+        switch (column) {
+            case PLACEMENT_ITEM:  return compareKeys(placementA.item, placementB.item);
+            case PLACEMENT_SKU:
+                return compareKeys(typeSkuRank[manifest->items[placementA.item]],
+                                   typeSkuRank[manifest->items[placementB.item]]);
+            case PLACEMENT_X:     return compareKeys(placementA.x, placementB.x);
+            case PLACEMENT_Y:     return compareKeys(placementA.y, placementB.y);
+            case PLACEMENT_Z:     return compareKeys(placementA.z, placementB.z);
+            case PLACEMENT_SIZE:  return compareKeys(placementA.volume(), placementB.volume());
+            case PLACEMENT_ORIENTATION: return compareKeys(placementA.orientation, placementB.orientation);
+            default:              return compareKeys(a, b);
+        }
+    };
+
+    // Один проход сортировки на смену столбца; при равенстве - исходный порядок строк
+    std::sort(rows[table].begin(), rows[table].end(), [&](uint32_t a, uint32_t b) {
+        for (int i = 0; i < specs->SpecsCount; i++) {
+            const ImGuiTableColumnSortSpecs& spec = specs->Specs[i];
+            int order = table == TABLE_TYPES ? compareTypes(spec.ColumnUserID, a, b)
+                      : table == TABLE_ITEMS ? compareItems(spec.ColumnUserID, a, b)
+                      : comparePlacements(spec.ColumnUserID, a, b);
+            if (order != 0) return spec.SortDirection == ImGuiSortDirection_Ascending ? order < 0 : order > 0;
+        }
+        return a < b;
+    });
+}
+
+void CargoTables::updateSort(Table table) {
+    ImGuiTableSortSpecs* specs = ImGui::TableGetSortSpecs();
+    if (!specs) return;
+    if (specs->SpecsDirty || sortPending[table]) {
+        sortRows(table, specs);
+        specs->SpecsDirty = false;
+        sortPending[table] = false;
+    }
+}
+
+void CargoTables::render(bool* open) {
+    if (!*open) return;
+
+    ImGui::SetNextWindowSize(ImVec2(720.0f, 420.0f), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Груз", open)) {
+        ImGui::End();
+        return;
+    }
+    if (!manifest || manifest->empty()) {
+        ImGui::Text("Манифест не загружен");
+        ImGui::End();
+        return;
+    }
+
+    // Данные сменились без setData (например, ошибка посреди загрузки проекта) - пересчет
+    if (typeQuantity.size() != manifest->types.size() || itemPlacement.size() != manifest->items.size()) {
+        rebuildSummary();
+        applyFilter();
+    }
+
+    bool changed = filter.Draw("SKU", 240.0f);
+    ImGui::SameLine();
+    changed |= ImGui::Checkbox("Только не загруженные", &onlyUnplaced);
+    if (changed) applyFilter();
+
+    if (ImGui::BeginTabBar("cargoTabs")) {
+        char label[64];
+        snprintf(label, sizeof(label), "Типы (%zu)###types", rows[TABLE_TYPES].size());
+        if (ImGui::BeginTabItem(label)) {
+            renderTypes();
+            ImGui::EndTabItem();
+        }
+        snprintf(label, sizeof(label), "Коробки (%zu)###items", rows[TABLE_ITEMS].size());
+        if (ImGui::BeginTabItem(label)) {
+            renderItems();
+            ImGui::EndTabItem();
+        }
+        snprintf(label, sizeof(label), "Размещение (%zu)###placements", rows[TABLE_PLACEMENTS].size());
+        if (ImGui::BeginTabItem(label)) {
+            renderPlacements();
+            ImGui::EndTabItem();
+        }
+        ImGui::EndTabBar();
+    }
+    ImGui::End();
+}
+
+void CargoTables::renderTypes() {
+    if (!ImGui::BeginTable("types", TYPE_COLUMN_COUNT, TABLE_FLAGS)) return;
+
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("SKU", ImGuiTableColumnFlags_WidthStretch | ImGuiTableColumnFlags_DefaultSort,
+                            0.0f, TYPE_SKU);
+    ImGui::TableSetupColumn("Размеры, см", ImGuiTableColumnFlags_None, 0.0f, TYPE_SIZE);
+    ImGui::TableSetupColumn("Масса, кг", ImGuiTableColumnFlags_None, 0.0f, TYPE_WEIGHT);
+    ImGui::TableSetupColumn("Количество", ImGuiTableColumnFlags_PreferSortDescending, 0.0f, TYPE_QUANTITY);
+    ImGui::TableSetupColumn("Загружено", ImGuiTableColumnFlags_PreferSortDescending, 0.0f, TYPE_LOADED);
+    ImGui::TableSetupColumn("Класс", ImGuiTableColumnFlags_None, 0.0f, TYPE_CLASS);
+    ImGui::TableHeadersRow();
+    updateSort(TABLE_TYPES);
+
+    const std::vector<uint32_t>& order = rows[TABLE_TYPES];
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(order.size()));
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+            uint32_t index = order[row];
+            const BoxType& type = manifest->types[index];
+            ImGui::TableNextRow();
+
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(type.sku.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%d x %d x %d%s", type.width, type.height, type.depth, type.isCylinder() ? " (цилиндр)" : "");
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", type.weight);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", static_cast<unsigned>(typeQuantity[index]));
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", static_cast<unsigned>(typeLoaded[index]));
+            ImGui::TableNextColumn();
+            if (type.compatibilityClass != 0) {
+                ImGui::Text("%u", static_cast<unsigned>(type.compatibilityClass));
+            } else {
+                ImGui::TextDisabled("-");
+            }
+        }
+    }
+    ImGui::EndTable();
+}
+
+void CargoTables::renderItems() {
+    if (!ImGui::BeginTable("items", ITEM_COLUMN_COUNT, TABLE_FLAGS)) return;
+
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("№", ImGuiTableColumnFlags_DefaultSort, 0.0f, ITEM_INDEX);
+    ImGui::TableSetupColumn("SKU", ImGuiTableColumnFlags_WidthStretch, 0.0f, ITEM_SKU);
+    ImGui::TableSetupColumn("Точка", ImGuiTableColumnFlags_None, 0.0f, ITEM_STOP);
+    ImGui::TableSetupColumn("В плане", ImGuiTableColumnFlags_None, 0.0f, ITEM_STATUS);
+    ImGui::TableHeadersRow();
+    updateSort(TABLE_ITEMS);
+
+    const std::vector<uint32_t>& order = rows[TABLE_ITEMS];
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(order.size()));
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+            uint32_t item = order[row];
+            ImGui::TableNextRow();
+
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", static_cast<unsigned>(item));
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(manifest->typeOf(item).sku.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", static_cast<unsigned>(manifest->stopOf(item)));
+            ImGui::TableNextColumn();
+            if (itemPlacement[item] >= 0) {
+                ImGui::Text("№%d", itemPlacement[item]);
+            } else {
+                ImGui::TextColored(ImVec4(0.85f, 0.4f, 0.4f, 1.0f), "не загружена");
+            }
+        }
+    }
+    ImGui::EndTable();
+}
+
+void CargoTables::renderPlacements() {
+    if (!ImGui::BeginTable("placements", PLACEMENT_COLUMN_COUNT, TABLE_FLAGS)) return;
+
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("№", ImGuiTableColumnFlags_DefaultSort, 0.0f, PLACEMENT_ORDER);
+    ImGui::TableSetupColumn("Коробка", ImGuiTableColumnFlags_None, 0.0f, PLACEMENT_ITEM);
+    ImGui::TableSetupColumn("SKU", ImGuiTableColumnFlags_WidthStretch, 0.0f, PLACEMENT_SKU);
+    ImGui::TableSetupColumn("X", ImGuiTableColumnFlags_None, 0.0f, PLACEMENT_X);
+    ImGui::TableSetupColumn("Y", ImGuiTableColumnFlags_None, 0.0f, PLACEMENT_Y);
+    ImGui::TableSetupColumn("Z", ImGuiTableColumnFlags_None, 0.0f, PLACEMENT_Z);
+    ImGui::TableSetupColumn("Габарит, см", ImGuiTableColumnFlags_None, 0.0f, PLACEMENT_SIZE);
+    ImGui::TableSetupColumn("Поворот", ImGuiTableColumnFlags_None, 0.0f, PLACEMENT_ORIENTATION);
+    ImGui::TableHeadersRow();
+    updateSort(TABLE_PLACEMENTS);
+
+    const std::vector<uint32_t>& order = rows[TABLE_PLACEMENTS];
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(order.size()));
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+            uint32_t index = order[row];
+            const Placement& placement = plan->placements[index];
+            ImGui::TableNextRow();
+
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", static_cast<unsigned>(index));
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", static_cast<unsigned>(placement.item));
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(manifest->typeOf(placement.item).sku.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", placement.x);
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", placement.y);
+            ImGui::TableNextColumn();
+            ImGui::Text("%d", placement.z);
+            ImGui::TableNextColumn();
+            ImGui::Text("%d x %d x %d", placement.width, placement.height, placement.depth);
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(placement.orientation < ORIENTATION_COUNT ? ORIENTATION_NAMES[placement.orientation]
+                                                                             : "?");
+        }
+    }
+    ImGui::EndTable();
+}
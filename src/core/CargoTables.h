@@ -0,0 +1,59 @@
+#ifndef CARGOTABLES_H
+#define CARGOTABLES_H
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <imgui.h>
+#include "../packing/Cargo.h"
+#include "../packing/LoadPlan.h"
+
+// Таблицы груза в UI: типы (SKU), коробки манифеста и размещения плана.
+// Манифест может содержать сотни тысяч строк, поэтому строки рисуются через
+// ImGuiListClipper и каждый кадр форматируются только видимые. Фильтр и
+// сортировка работают с массивами индексов строк и пересчитываются только при
+// смене данных, фильтра или столбца сортировки - цена кадра не зависит от размера.
+class CargoTables {
+private:
+    enum Table { TABLE_TYPES, TABLE_ITEMS, TABLE_PLACEMENTS, TABLE_COUNT };
+
+    const Manifest* manifest = nullptr;
+    const LoadPlan* plan = nullptr;
+
+    // Сводка по данным: пересчитывается в setData
+    std::vector<uint32_t> typeQuantity;     // Коробок типа в манифесте
+    std::vector<uint32_t> typeLoaded;       // Из них в плане
+    std::vector<uint32_t> typeSkuRank;      // Место типа при сортировке по SKU
+    std::vector<int32_t> itemPlacement;     // Индекс в plan->placements, -1 - не загружена
+
+    // Фильтр по SKU проверяется один раз на тип, строки коробок берут готовый флаг
+    ImGuiTextFilter filter;
+    bool onlyUnplaced = false;
+    std::vector<uint8_t> typeVisible;
+
+    // Видимые строки каждой таблицы в порядке сортировки
+    std::array<std::vector<uint32_t>, TABLE_COUNT> rows;
+    std::array<bool, TABLE_COUNT> sortPending = {};
+
+    void rebuildSummary();
+    void applyFilter();
+    void sortRows(Table table, const ImGuiTableSortSpecs* specs);
+    // Сортирует строки, если изменились данные, фильтр или столбец сортировки
+    void updateSort(Table table);
+
+    void renderTypes();
+    void renderItems();
+    void renderPlacements();
+
+public:
+    // Данные должны жить, пока открыты таблицы; вызывается при каждой смене
+    // манифеста или плана
+    void setData(const Manifest& manifest, const LoadPlan& plan);
+    void clear();
+
+    void render(bool* open);
+};
+
+#endif //CARGOTABLES_H
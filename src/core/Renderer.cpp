@@ -4,23 +4,43 @@
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <numeric>
+#include "../packing/Packer.h"
+
+namespace {
+
+// Столбцы таблицы сравнения прицепов (ColumnUserID)
+enum ComparisonColumn {
+    COMPARISON_NAME,
+    COMPARISON_SIZE,
+    COMPARISON_UTILISATION,
+    COMPARISON_LEFTOVER,
+    COMPARISON_AXLES,
+    COMPARISON_TIME,
+    COMPARISON_COLUMN_COUNT
+};
+
+} // namespace
 
 Renderer::Renderer() {
     // Initialize shaders
     modelShader = std::make_unique<Shader>("assets/shaders/model.vs", "assets/shaders/model.fs");
 
-    // Initialize truck presets
-    truckPresets = {
-        {"Малый грузовик", 1203, 239, 235},
-        {"Средний грузовик", 1340, 239, 235},
-        {"Большой грузовик", 1360, 260, 245},
-        {"Увеличенный грузовик", 1360, 300, 245},
-        {"Максимальный грузовик", 1650, 260, 245},
-        {"Компактный грузовик", 590, 239, 235}
-    };
+    // Те же пресеты, что у пакетного решателя и сервиса
+    truckPresets = defaultTruckPresets();
+    // Правила для классов манифеста действуют во всех режимах упаковки
+    packerOptions.segregation = defaultSegregationRules();
+
+    threadPool = std::make_unique<ThreadPool>();
+    planCache = std::make_unique<PlanCache>(64, "cache/plans", threadPool.get());
 }
 
 Renderer::~Renderer() {
+    stopSearch();
     cleanupUI();
 }
 
@@ -66,33 +86,39 @@ void Renderer::render(const Scene& scene, const Camera& camera) {
     modelShader->setBool("enhanceContrast", true);
 
     // Render scene
-    scene.render(*modelShader);
+    scene.render(*modelShader, projection * view);
 }
 
-void Renderer::renderUI(const Scene& scene, GLFWwindow* window) {
+void Renderer::renderUI(Scene& scene, GLFWwindow* window) {
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
 
-    renderMainMenuBar(window);
+    pollSearch(scene);
+    pollInterior(scene);
+    pollSave();
+    pollComparison();
+    renderMainMenuBar(window, scene);
     renderTruckInfoPanel(scene);
+    renderComparisonPanel(scene);
+    cargoTables.render(&showCargoTables);
     renderPerformancePanel();
 
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
 
-void Renderer::renderMainMenuBar(GLFWwindow* window) {
+void Renderer::renderMainMenuBar(GLFWwindow* window, Scene& scene) {
     if (ImGui::BeginMainMenuBar()) {
         if (ImGui::BeginMenu("Файл")) {
             if (ImGui::MenuItem("Новый проект", "Ctrl+N")) {
-                // Implementation
+                newProject(scene);
             }
             if (ImGui::MenuItem("Открыть", "Ctrl+O")) {
-                // Implementation
+                openManifestRequested = true;
             }
-            if (ImGui::MenuItem("Сохранить", "Ctrl+S")) {
-                // Implementation
+            if (ImGui::MenuItem("Сохранить", "Ctrl+S", false, !manifest.empty() && !saveTask.valid())) {
+                saveProject();
             }
             ImGui::Separator();
             if (ImGui::MenuItem("Выход", "Alt+F4")) {
@@ -107,17 +133,39 @@ void Renderer::renderMainMenuBar(GLFWwindow* window) {
 
             for (int i = 0; i < truckPresets.size(); i++) {
                 bool selected = (truckSettings.currentPreset == i && !truckSettings.useCustom);
-                if (ImGui::MenuItem(truckPresets[i].name.c_str(), nullptr, selected)) {
+                if (ImGui::MenuItem(truckPresets[i].label.c_str(), nullptr, selected)) {
                     truckSettings.currentPreset = i;
                     truckSettings.useCustom = false;
-                    updateTruckSize();
+                    updateTruckSize(scene);
                 }
             }
 
             ImGui::Separator();
             if (ImGui::MenuItem("Пользовательский", nullptr, truckSettings.useCustom)) {
                 truckSettings.useCustom = true;
-                updateTruckSize();
+                updateTruckSize(scene);
+            }
+
+            ImGui::Separator();
+            bool searching = search || exactSearch;
+            if (ImGui::MenuItem("Оптимизировать загрузку", nullptr, false, !manifest.empty() && !searching)) {
+                startSearch(scene);
+            }
+            bool smallManifest = !manifest.empty() && manifest.items.size() <= ExactOptions().maxItems;
+            if (ImGui::MenuItem("Точное решение", nullptr, false, smallManifest && !searching)) {
+                startExactSearch(scene);
+            }
+            if (ImGui::MenuItem("Остановить оптимизацию", nullptr, false, searching)) {
+                stopSearch();
+            }
+            if (ImGui::MenuItem("Распределить по парку", nullptr, !fleetPlan.empty(), !manifest.empty())) {
+                packFleet(scene);
+            }
+            if (ImGui::MenuItem("Собрать на поддоны", nullptr, !palletPlan.empty(), !manifest.empty())) {
+                packPallets(scene);
+            }
+            if (ImGui::MenuItem("Сравнить прицепы", nullptr, showComparison, !manifest.empty())) {
+                startComparison(scene);
             }
 
             ImGui::EndMenu();
@@ -133,9 +181,10 @@ void Renderer::renderMainMenuBar(GLFWwindow* window) {
                 changed |= ImGui::InputInt("Высота", &truckSettings.customHeight, 10, 100);
                 changed |= ImGui::InputInt("Глубина", &truckSettings.customDepth, 10, 100);
             } else {
-                int presetWidth = truckPresets[truckSettings.currentPreset].width;
-                int presetHeight = truckPresets[truckSettings.currentPreset].height;
-                int presetDepth = truckPresets[truckSettings.currentPreset].depth;
+                const TrailerSpec& preset = truckPresets[truckSettings.currentPreset].trailer;
+                int presetWidth = preset.width;
+                int presetHeight = preset.height;
+                int presetDepth = preset.depth;
 
                 ImGui::InputInt("Ширина", &presetWidth, 0, 0, ImGuiInputTextFlags_ReadOnly);
                 ImGui::InputInt("Высота", &presetHeight, 0, 0, ImGuiInputTextFlags_ReadOnly);
@@ -146,7 +195,7 @@ void Renderer::renderMainMenuBar(GLFWwindow* window) {
                 truckSettings.customWidth = std::max(300, std::min(3000, truckSettings.customWidth));
                 truckSettings.customHeight = std::max(100, std::min(500, truckSettings.customHeight));
                 truckSettings.customDepth = std::max(100, std::min(300, truckSettings.customDepth));
-                updateTruckSize();
+                updateTruckSize(scene);
             }
 
             ImGui::PopItemWidth();
@@ -157,39 +206,710 @@ void Renderer::renderMainMenuBar(GLFWwindow* window) {
             ImGui::EndMenu();
         }
 
+        if (ImGui::BeginMenu("Вид")) {
+            ImGui::MenuItem("Таблицы груза", nullptr, &showCargoTables);
+            ImGui::EndMenu();
+        }
+
         ImGui::EndMainMenuBar();
     }
+
+    renderOpenManifestDialog(scene);
+}
+
+void Renderer::renderOpenManifestDialog(Scene& scene) {
+    // Попап открывается вне стека меню, иначе его ID не совпадет с BeginPopupModal
+    if (openManifestRequested) {
+        ImGui::OpenPopup("Открыть манифест");
+        openManifestRequested = false;
+    }
+
+    if (ImGui::BeginPopupModal("Открыть манифест", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::Text("Файл CSV, JSON или проект .tlp:");
+        ImGui::PushItemWidth(400);
+        bool submitted = ImGui::InputText("##path", manifestPath, sizeof(manifestPath), ImGuiInputTextFlags_EnterReturnsTrue);
+        ImGui::PopItemWidth();
+
+        if (ImGui::Button("Открыть") || submitted) {
+            loadManifest(scene, manifestPath);
+            ImGui::CloseCurrentPopup();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Отмена")) {
+            ImGui::CloseCurrentPopup();
+        }
+        ImGui::EndPopup();
+    }
 }
 
 void Renderer::renderTruckInfoPanel(const Scene& scene) {
     ImGui::Begin("Информация о грузовике", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
 
-    glm::vec3 currentSize = truckSettings.getCurrentSize();
+    glm::vec3 currentSize = truckSettings.getCurrentSize(truckPresets);
     ImGui::Text("Текущий тип: %s", truckSettings.useCustom ? "Пользовательский" :
-                truckPresets[truckSettings.currentPreset].name.c_str());
+                truckPresets[truckSettings.currentPreset].label.c_str());
     ImGui::Text("Размеры: %.0f x %.0f x %.0f см", currentSize.x, currentSize.y, currentSize.z);
     ImGui::Text("Объем: %.2f м³", (currentSize.x * currentSize.y * currentSize.z) / 1000000.0f);
+    if (occupancy.totalVoxels() > 0) {
+        ImGui::SameLine();
+        ImGui::Text("(занято %.1f%%)", occupancy.fillRatio() * 100.0);
+    }
     ImGui::Text("Тент: %s", truckSettings.tentOpen ? "Открыт" : "Закрыт");
+    if (!importStatus.empty()) {
+        ImGui::TextWrapped("%s", importStatus.c_str());
+    }
+
+    if (!fleetPlan.empty()) {
+        renderFleetInfo();
+    } else if (!palletPlan.empty()) {
+        renderPalletInfo();
+    } else if (!loadPlan.empty()) {
+        ImGui::Separator();
+        ImGui::Text("Загружено: %zu / %zu", loadPlan.placements.size(),
+                    loadPlan.placements.size() + loadPlan.unplaced.size());
+        ImGui::Text("Заполнение: %.1f%%", loadPlan.utilisation() * 100.0);
+        ImGui::Text("Переупаковка: %.2f мс (%s)", lastPackTimeMs, lastPackSource);
+        if (search) {
+            ImGui::Text("Оптимизация... лучший результат %.1f%%", search->bestUtilisation() * 100.0);
+        }
+        if (exactSearch) {
+            ImGui::Text("Точный поиск... лучший результат %.1f%%", exactSearch->bestUtilisation() * 100.0);
+        } else if (exactGap == 0.0) {
+            ImGui::Text("Решение оптимально");
+        } else if (exactGap > 0.0) {
+            if (exactExhausted) ImGui::Text("Лучший план среди порядков и поворотов упаковщика");
+            ImGui::Text("До верхней оценки не больше %.1f%% объема", exactGap * 100.0);
+        }
+
+        renderLoadBalance();
+    }
 
     ImGui::End();
 }
 
+void Renderer::renderLoadBalance() {
+    const AxleLayout& axles = packerOptions.axles;
+    if (!axles.enabled) return;
+
+    ImGui::Separator();
+    ImGui::Text("Масса груза: %.0f кг", loadBalance.getMass());
+
+    // Полосы нагрузки на оси, красные при перегрузе
+    auto axleBar = [](const char* label, double load, float limit) {
+        float fraction = limit > 0.0f ? static_cast<float>(load / limit) : 0.0f;
+        char overlay[64];
+        snprintf(overlay, sizeof(overlay), "%.0f / %.0f кг", load, limit);
+
+        bool overloaded = fraction > 1.0f;
+        if (overloaded) ImGui::PushStyleColor(ImGuiCol_PlotHistogram, ImVec4(0.85f, 0.2f, 0.2f, 1.0f));
+        ImGui::ProgressBar(std::min(fraction, 1.0f), ImVec2(220.0f, 0.0f), overlay);
+        if (overloaded) ImGui::PopStyleColor();
+        ImGui::SameLine();
+        ImGui::Text("%s", label);
+    };
+    axleBar("Передняя опора", loadBalance.frontLoad(axles), axles.frontLimit);
+    axleBar("Задние оси", loadBalance.rearLoad(axles), axles.rearLimit);
+
+    // Вид сверху: прицеп, опоры и маркер центра тяжести
+    const TrailerSpec& trailer = loadPlan.trailer;
+    if (trailer.width <= 0 || trailer.depth <= 0) return;
+
+    float viewWidth = 300.0f;
+    float scale = viewWidth / trailer.width;
+    float viewHeight = std::max(20.0f, trailer.depth * scale);
+
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    drawList->AddRect(origin, ImVec2(origin.x + viewWidth, origin.y + viewHeight), IM_COL32(200, 200, 200, 255));
+
+    for (float axle : {axles.frontPosition, axles.rearPosition}) {
+        float x = origin.x + axle * scale;
+        drawList->AddLine(ImVec2(x, origin.y), ImVec2(x, origin.y + viewHeight), IM_COL32(120, 160, 255, 255), 2.0f);
+    }
+
+    if (loadBalance.getMass() > 0.0) {
+        ImVec2 center(origin.x + static_cast<float>(loadBalance.centerX()) * scale,
+                      origin.y + static_cast<float>(loadBalance.centerZ()) * scale);
+        drawList->AddCircleFilled(center, 5.0f, IM_COL32(255, 200, 40, 255));
+    }
+
+    ImGui::Dummy(ImVec2(viewWidth, viewHeight));
+    ImGui::Text("Центр тяжести: %.0f / %.0f / %.0f см",
+                loadBalance.centerX(), loadBalance.centerY(), loadBalance.centerZ());
+}
+
+void Renderer::renderFleetInfo() {
+    ImGui::Separator();
+    ImGui::Text("Машин: %zu, стоимость %.2f", fleetPlan.loads.size(), fleetPlan.totalCost);
+    ImGui::Text("Загружено: %zu / %zu", fleetPlan.placedCount(), fleetPlan.placedCount() + fleetPlan.unplaced.size());
+    ImGui::Text("Распределение: %.2f мс", lastPackTimeMs);
+
+    for (size_t i = 0; i < fleetPlan.loads.size(); i++) {
+        const FleetLoad& load = fleetPlan.loads[i];
+        ImGui::Text("%zu. %s: %zu коробок, %.1f%%", i + 1, fleetVehicles[load.vehicle].name.c_str(),
+                    load.plan.placements.size(), load.plan.utilisation() * 100.0);
+    }
+}
+
+void Renderer::renderPalletInfo() {
+    ImGui::Separator();
+    ImGui::Text("Поддонов: %zu / %zu", palletPlan.trailerPlan.placements.size(), palletPlan.built.size());
+    ImGui::Text("Коробок загружено: %zu / %zu", palletPlan.loadedCartonCount(), palletPlan.cartonCount());
+    if (!palletPlan.unpalletised.empty()) {
+        ImGui::Text("Не помещаются на поддон: %zu", palletPlan.unpalletised.size());
+    }
+    ImGui::Text("Заполнение: %.1f%%", palletPlan.trailerPlan.utilisation() * 100.0);
+    ImGui::Text("Сборка и упаковка: %.2f мс", lastPackTimeMs);
+}
+
 void Renderer::renderPerformancePanel() {
     ImGui::Begin("Performance");
     ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
     ImGui::End();
 }
 
-glm::vec3 Renderer::TruckSettings::getCurrentSize() const {
+glm::vec3 Renderer::TruckSettings::getCurrentSize(const std::vector<TruckPreset>& presets) const {
     if (useCustom) {
         return glm::vec3(customWidth, customHeight, customDepth);
     }
+    if (currentPreset >= 0 && currentPreset < static_cast<int>(presets.size())) {
+        const TrailerSpec& preset = presets[currentPreset].trailer;
+        return glm::vec3(preset.width, preset.height, preset.depth);
+    }
     return glm::vec3(1650, 260, 245); // Default
 }
 
-void Renderer::updateTruckSize() {
-    glm::vec3 size = truckSettings.getCurrentSize();
-    std::cout << "Truck size updated: " << size.x << "x" << size.y << "x" << size.z << std::endl;
+TrailerSpec Renderer::getCurrentTrailer() const {
+    glm::vec3 size = truckSettings.getCurrentSize(truckPresets);
+    return TrailerSpec{static_cast<int>(size.x), static_cast<int>(size.y), static_cast<int>(size.z)};
+}
+
+void Renderer::updateTruckSize(Scene& scene) {
+    TrailerSpec trailer = getCurrentTrailer();
+
+    if (manifest.empty()) return;
+
+    if (loadPlan.trailer == trailer && !loadPlan.empty()) {
+        // Выбор прицепа возвращает из режимов парка и поддонов к обычной загрузке
+        if (!fleetPlan.empty() || !palletPlan.empty()) applyLoadPlan(scene);
+        return;
+    }
+
+    // Поиск шел для старого прицепа - его результаты больше не нужны
+    stopSearch();
+    refreshPackerOptions(scene);
+    interiorPending = scene.isInteriorBuilding(trailer);
+
+    // Та же задача уже решалась - план берется из кэша. Иначе переиспользуем
+    // предыдущий план или похожий план из кэша: решается только хвост
+    auto start = std::chrono::high_resolution_clock::now();
+    LoadPlan cached;
+    PlanCache::Match match = planCache->find(manifest, trailer, packerOptions, cached);
+    if (match == PlanCache::Match::Exact) {
+        loadPlan = std::move(cached);
+        lastPackSource = "из кэша";
+    } else {
+        Packer packer(manifest, packerOptions);
+        if (!loadPlan.empty()) {
+            loadPlan = packer.repack(loadPlan, trailer);
+            lastPackSource = "переупаковка";
+        } else if (match == PlanCache::Match::Similar) {
+            loadPlan = packer.repack(cached, trailer);
+            lastPackSource = "от похожего плана";
+        } else {
+            loadPlan = packer.pack(trailer);
+            lastPackSource = "с нуля";
+        }
+        planCache->store(manifest, loadPlan, packerOptions);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    lastPackTimeMs = std::chrono::duration<float, std::milli>(end - start).count();
+
+    applyLoadPlan(scene);
+}
+
+void Renderer::loadManifest(Scene& scene, const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    if (dot != std::string::npos && path.substr(dot) == ".tlp") {
+        loadProject(scene, path);
+        return;
+    }
+
+    // Поиск держит копию старого манифеста и занимает пул
+    stopSearch();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    ManifestImporter importer(threadPool.get());
+    ImportReport report;
+    try {
+        manifest = importer.load(path, &report);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to load manifest: " << e.what() << std::endl;
+        importStatus = std::string("Ошибка загрузки: ") + e.what();
+        return;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    float loadMs = std::chrono::duration<float, std::milli>(end - start).count();
+
+    char status[256];
+    snprintf(status, sizeof(status), "Манифест: %zu строк, %zu типов, %zu коробок за %.0f мс",
+             report.rows, report.types, report.boxes, loadMs);
+    importStatus = status;
+    if (report.skipped > 0) {
+        importStatus += "\nПропущено строк: " + std::to_string(report.skipped) + " (" + report.firstError + ")";
+    }
+    std::cout << importStatus << std::endl;
+
+    // Новый манифест упаковывается с нуля, прежнее сравнение к нему не относится
+    comparison.reset();
+    showComparison = false;
+    loadPlan.clear();
+    if (manifest.empty()) {
+        cargoTables.clear();
+        occupancy.clear();
+        loadBalance.clear();
+        fleetPlan.clear();
+        palletPlan.clear();
+        scene.clearCargo();
+        return;
+    }
+    updateTruckSize(scene);
+}
+
+void Renderer::loadProject(Scene& scene, const std::string& path) {
+    stopSearch();
+    comparison.reset();
+    showComparison = false;
+
+    try {
+        LoadPlanFile file(path);
+        manifest = file.toManifest();
+        loadPlan = file.toLoadPlan();
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to load project: " << e.what() << std::endl;
+        importStatus = std::string("Ошибка загрузки: ") + e.what();
+        return;
+    }
+    projectPath = path;
+
+    // Прицеп из файла: подходящий пресет или пользовательские размеры
+    const TrailerSpec& trailer = loadPlan.trailer;
+    truckSettings.useCustom = true;
+    for (int i = 0; i < static_cast<int>(truckPresets.size()); i++) {
+        if (truckPresets[i].trailer == trailer) {
+            truckSettings.currentPreset = i;
+            truckSettings.useCustom = false;
+            break;
+        }
+    }
+    if (truckSettings.useCustom) {
+        truckSettings.customWidth = trailer.width;
+        truckSettings.customHeight = trailer.height;
+        truckSettings.customDepth = trailer.depth;
+    }
+
+    importStatus = "Проект: " + path;
+    refreshPackerOptions(scene);
+    applyLoadPlan(scene);
+}
+
+void Renderer::newProject(Scene& scene) {
+    stopSearch();
+    comparison.reset();
+    showComparison = false;
+
+    manifest.clear();
+    loadPlan.clear();
+    occupancy.clear();
+    loadBalance.clear();
+    fleetPlan.clear();
+    palletPlan.clear();
+    cargoTables.clear();
+    scene.clearCargo();
+
+    projectPath = "project.tlp";
+    importStatus.clear();
+}
+
+void Renderer::saveProject() {
+    if (saveTask.valid()) return;
+
+    // Снимок копируется в UI-потоке, дальше поток записи работает только с ним
+    auto snapshot = std::make_shared<ProjectSnapshot>();
+    snapshot->manifest = manifest;
+    snapshot->plan = loadPlan;
+    if (snapshot->plan.trailer.volume() == 0) {
+        snapshot->plan.trailer = getCurrentTrailer();
+    }
+
+    saveTarget = projectPath;
+    saveTask = LoadPlanFile::saveAsync(std::move(snapshot), saveTarget);
+}
+
+void Renderer::pollSave() {
+    if (!saveTask.valid()) return;
+    if (saveTask.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+
+    try {
+        saveTask.get();
+        importStatus = "Сохранено: " + saveTarget;
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to save project: " << e.what() << std::endl;
+        importStatus = std::string("Ошибка сохранения: ") + e.what();
+    }
+}
+
+void Renderer::applyLoadPlan(Scene& scene) {
+    // Сетка пересчитывается один раз на смену плана, панель читает готовый счетчик
+    occupancy.stampAll(loadPlan);
+    loadBalance = LoadBalance::fromPlan(loadPlan, manifest);
+    fleetPlan.clear();
+    palletPlan.clear();
+    cargoTables.setData(manifest, loadPlan);
+    scene.setLoadPlan(loadPlan, manifest);
+}
+
+void Renderer::refreshPackerOptions(const Scene& scene) {
+    packerOptions.axles = scene.getAxleLayout(getCurrentTrailer());
+    packerOptions.doorAtMaxX = scene.isDoorAtMaxX(getCurrentTrailer());
+
+    packerOptions.interior = usableInterior(scene);
+}
+
+std::shared_ptr<const TrailerInterior> Renderer::usableInterior(const Scene& scene) const {
+    // Модель, которая закрывает больше половины кузова, явно не совпадает с
+    // прицепом по габаритам - тогда упаковка идет в пустой параллелепипед
+    auto interior = scene.getInterior(getCurrentTrailer(), threadPool.get());
+    return interior && interior->usableRatio() >= 0.5 ? interior : nullptr;
+}
+
+void Renderer::pollInterior(Scene& scene) {
+    // Объем кузова строится в фоне: план, упакованный без него, перепаковывается,
+    // когда объем готов. Планы из файла, сравнения и поиска не трогаются
+    if (!interiorPending || scene.isInteriorBuilding(getCurrentTrailer())) return;
+    interiorPending = false;
+    if (manifest.empty() || !fleetPlan.empty() || !palletPlan.empty()) return;
+    if (usableInterior(scene) == packerOptions.interior) return;
+
+    loadPlan = LoadPlan();
+    updateTruckSize(scene);
+}
+
+void Renderer::startSearch(const Scene& scene) {
+    if (manifest.empty()) return;
+
+    stopSearch();
+    refreshPackerOptions(scene);
+
+    SearchOptions options;
+    options.packer = packerOptions;
+    search = std::make_unique<PackingSearch>(manifest, getCurrentTrailer(), *threadPool, options);
+    search->setWarmStart(loadPlan);
+    search->start();
+}
+
+void Renderer::startExactSearch(const Scene& scene) {
+    if (manifest.empty()) return;
+
+    stopSearch();
+    refreshPackerOptions(scene);
+
+    ExactOptions options;
+    options.packer = packerOptions;
+    exactSearch = std::make_unique<ExactSearch>(manifest, getCurrentTrailer(), *threadPool, options);
+    exactSearch->setWarmStart(loadPlan);
+    exactSearch->start();
+}
+
+void Renderer::stopSearch() {
+    // Деструктор отменяет поиск и дожидается завершения задач
+    search.reset();
+    exactSearch.reset();
+    exactGap = -1.0;
+    exactExhausted = false;
+    // План сменится вместе с поиском: готовый объем кузова его уже не перепаковывает
+    interiorPending = false;
+}
+
+void Renderer::pollSearch(Scene& scene) {
+    if (exactSearch) {
+        if (exactSearch->pollImprovement(loadPlan)) {
+            applyLoadPlan(scene);
+        }
+
+        if (!exactSearch->isRunning()) {
+            if (exactSearch->pollImprovement(loadPlan)) {
+                applyLoadPlan(scene);
+            }
+            double gap = exactSearch->gap();
+            bool exhausted = exactSearch->searchExhausted();
+            exactSearch.reset();
+            exactGap = gap;
+            exactExhausted = exhausted;
+            planCache->store(manifest, loadPlan, packerOptions);
+        }
+        return;
+    }
+
+    if (!search) return;
+
+    // Улучшенные решения приходят из потоков пула, в сцену попадают только здесь
+    if (search->pollImprovement(loadPlan)) {
+        applyLoadPlan(scene);
+    }
+
+    if (!search->isRunning()) {
+        if (search->pollImprovement(loadPlan)) {
+            applyLoadPlan(scene);
+        }
+        search.reset();
+
+        // Результат оптимизации заменяет жадный план в кэше
+        planCache->store(manifest, loadPlan, packerOptions);
+    }
+}
+
+void Renderer::packFleet(Scene& scene) {
+    if (manifest.empty()) return;
+
+    // Пул нужен целиком под упаковку машин
+    stopSearch();
+
+    // Каждый пресет - тип машины без ограничения количества. Фиксированная часть
+    // стоимости рейса перевешивает объем: сначала меньше машин, затем меньше прицепы.
+    fleetVehicles.clear();
+    for (const auto& preset : truckPresets) {
+        FleetVehicle vehicle;
+        vehicle.name = preset.label;
+        vehicle.trailer = preset.trailer;
+        vehicle.cost = 1.0 + vehicle.trailer.volume() / 1000000.0 / 100.0;
+        vehicle.packer.axles = scene.getAxleLayout(vehicle.trailer);
+        vehicle.packer.doorAtMaxX = scene.isDoorAtMaxX(vehicle.trailer);
+        vehicle.packer.segregation = packerOptions.segregation;
+        fleetVehicles.push_back(vehicle);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    FleetPacker packer(manifest, fleetVehicles, *threadPool);
+    fleetPlan = packer.pack();
+    auto end = std::chrono::high_resolution_clock::now();
+    lastPackTimeMs = std::chrono::duration<float, std::milli>(end - start).count();
+
+    // Сетка и баланс остаются от текущей одиночной машины, сцена показывает весь парк
+    palletPlan.clear();
+    scene.setFleetPlan(fleetPlan, manifest);
+}
+
+void Renderer::packPallets(Scene& scene) {
+    if (manifest.empty()) return;
+
+    stopSearch();
+    refreshPackerOptions(scene);
+    palletOptions.trailer = packerOptions;
+    palletOptions.cartons.segregation = packerOptions.segregation;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    PalletBuilder builder(manifest, palletOptions, *threadPool);
+    palletPlan = builder.build(getCurrentTrailer());
+    auto end = std::chrono::high_resolution_clock::now();
+    lastPackTimeMs = std::chrono::duration<float, std::milli>(end - start).count();
+
+    fleetPlan.clear();
+    scene.setPalletPlan(palletPlan, manifest, palletOptions.specs);
+}
+
+void Renderer::startComparison(const Scene& scene) {
+    if (manifest.empty()) return;
+
+    // Пул нужен целиком под упаковку вариантов
+    stopSearch();
+
+    // Варианты - пресеты (тот же список, что у меню и утилит), затем пользовательский
+    // размер. Геометрия кузова строится под один прицеп, поэтому, как и в парке,
+    // варианты упаковываются в пустой параллелепипед
+    std::vector<ComparisonCandidate> candidates;
+    for (const auto& preset : defaultTruckPresets()) {
+        candidates.push_back({preset.label, preset.trailer, packerOptions});
+    }
+    candidates.push_back({"Пользовательский",
+                          TrailerSpec{truckSettings.customWidth, truckSettings.customHeight, truckSettings.customDepth},
+                          packerOptions});
+    for (auto& candidate : candidates) {
+        candidate.packer.axles = scene.getAxleLayout(candidate.trailer);
+        candidate.packer.doorAtMaxX = scene.isDoorAtMaxX(candidate.trailer);
+        candidate.packer.interior = nullptr;
+    }
+
+    // Прежнее сравнение не ждет своих задач: неначатые варианты пропускаются
+    comparison = std::make_unique<PresetComparison>(manifest, std::move(candidates), *threadPool);
+    comparisonOrder.resize(comparison->size());
+    std::iota(comparisonOrder.begin(), comparisonOrder.end(), size_t(0));
+    comparisonSelected = SIZE_MAX;
+    comparisonSortDirty = true;
+    showComparison = true;
+}
+
+void Renderer::pollComparison() {
+    // Результаты приходят из потоков пула; новая строка может сдвинуть порядок
+    if (comparison && comparison->poll()) comparisonSortDirty = true;
+}
+
+void Renderer::sortComparison(const ImGuiTableSortSpecs* specs) {
+    auto key = [this](int column, size_t index) {
+        const ComparisonResult& result = comparison->getResult(index);
+        switch (column) {
+            case COMPARISON_SIZE:     return static_cast<double>(comparison->getCandidate(index).trailer.volume());
+            case COMPARISON_LEFTOVER: return static_cast<double>(result.leftover);
+            case COMPARISON_AXLES:
+                return result.axlesChecked ? result.axleMargin : std::numeric_limits<double>::infinity();
+            case COMPARISON_TIME:     return result.solveMs;
+            default:                  return result.utilisation;
+        }
+    };
+
+    // Недосчитанные и неупакованные варианты - всегда внизу, в порядке меню
+    auto packed = [this](size_t index) {
+        const ComparisonResult& result = comparison->getResult(index);
+        return result.ready && result.error.empty();
+    };
+    std::stable_sort(comparisonOrder.begin(), comparisonOrder.end(), [&](size_t a, size_t b) {
+        bool readyA = packed(a);
+        bool readyB = packed(b);
+        if (readyA != readyB) return readyA;
+        if (!readyA) return a < b;
+
+        for (int i = 0; specs && i < specs->SpecsCount; i++) {
+            const ImGuiTableColumnSortSpecs& spec = specs->Specs[i];
+            int order = 0;
+            if (spec.ColumnUserID == COMPARISON_NAME) {
+                order = comparison->getCandidate(a).name.compare(comparison->getCandidate(b).name);
+            } else {
+                double keyA = key(spec.ColumnUserID, a);
+                double keyB = key(spec.ColumnUserID, b);
+                order = keyA < keyB ? -1 : (keyA > keyB ? 1 : 0);
+            }
+            if (order != 0) return spec.SortDirection == ImGuiSortDirection_Ascending ? order < 0 : order > 0;
+        }
+        return a < b;
+    });
+}
+
+void Renderer::renderComparisonPanel(Scene& scene) {
+    if (!showComparison || !comparison) return;
+
+    ImGui::SetNextWindowSize(ImVec2(640.0f, 260.0f), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Сравнение прицепов", &showComparison)) {
+        ImGui::End();
+        return;
+    }
+
+    if (comparison->isRunning()) {
+        ImGui::Text("Упаковка... %zu / %zu", comparison->finished(), comparison->size());
+    } else {
+        ImGui::Text("Строка таблицы переключает сцену на этот прицеп");
+    }
+
+    const ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV |
+                                  ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY;
+    if (ImGui::BeginTable("comparison", COMPARISON_COLUMN_COUNT, flags)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Прицеп", ImGuiTableColumnFlags_WidthStretch, 0.0f, COMPARISON_NAME);
+        ImGui::TableSetupColumn("Размеры, см", ImGuiTableColumnFlags_WidthFixed, 0.0f, COMPARISON_SIZE);
+        ImGui::TableSetupColumn("Заполнение", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_DefaultSort |
+                                ImGuiTableColumnFlags_PreferSortDescending, 0.0f, COMPARISON_UTILISATION);
+        ImGui::TableSetupColumn("Не влезло", ImGuiTableColumnFlags_WidthFixed, 0.0f, COMPARISON_LEFTOVER);
+        ImGui::TableSetupColumn("Запас осей", ImGuiTableColumnFlags_WidthFixed |
+                                ImGuiTableColumnFlags_PreferSortDescending, 0.0f, COMPARISON_AXLES);
+        ImGui::TableSetupColumn("Время", ImGuiTableColumnFlags_WidthFixed, 0.0f, COMPARISON_TIME);
+        ImGui::TableHeadersRow();
+
+        // Сортировка - только при смене столбца или приходе нового результата, не каждый кадр
+        if (ImGuiTableSortSpecs* specs = ImGui::TableGetSortSpecs()) {
+            if (specs->SpecsDirty || comparisonSortDirty) {
+                sortComparison(specs);
+                specs->SpecsDirty = false;
+                comparisonSortDirty = false;
+            }
+        }
+
+        for (size_t index : comparisonOrder) {
+            const ComparisonCandidate& candidate = comparison->getCandidate(index);
+            const ComparisonResult& result = comparison->getResult(index);
+            ImGui::TableNextRow();
+
+            ImGui::TableSetColumnIndex(0);
+            bool current = index == comparisonSelected && loadPlan.trailer == candidate.trailer &&
+                           fleetPlan.empty() && palletPlan.empty();
+            ImGui::PushID(static_cast<int>(index));
+            if (ImGui::Selectable(candidate.name.c_str(), current, ImGuiSelectableFlags_SpanAllColumns) &&
+                result.ready && result.error.empty()) {
+                applyComparison(scene, index);
+            }
+            ImGui::PopID();
+
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%d x %d x %d", candidate.trailer.width, candidate.trailer.height, candidate.trailer.depth);
+
+            ImGui::TableSetColumnIndex(2);
+            if (!result.ready) {
+                ImGui::TextDisabled("...");
+                continue;
+            }
+            if (!result.error.empty()) {
+                ImGui::TextColored(ImVec4(0.85f, 0.2f, 0.2f, 1.0f), "ошибка: %s", result.error.c_str());
+                continue;
+            }
+            ImGui::Text("%.1f%%", result.utilisation * 100.0);
+
+            ImGui::TableSetColumnIndex(3);
+            ImGui::Text("%zu", result.leftover);
+
+            ImGui::TableSetColumnIndex(4);
+            if (!result.axlesChecked) {
+                ImGui::TextDisabled("-");
+            } else if (result.axleMargin < 0.0) {
+                ImGui::TextColored(ImVec4(0.85f, 0.2f, 0.2f, 1.0f), "перегруз %.0f%%", -result.axleMargin * 100.0);
+            } else {
+                ImGui::Text("%.0f%%", result.axleMargin * 100.0);
+            }
+
+            ImGui::TableSetColumnIndex(5);
+            ImGui::Text("%.1f мс", result.solveMs);
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+void Renderer::applyComparison(Scene& scene, size_t index) {
+    const ComparisonCandidate& candidate = comparison->getCandidate(index);
+    const ComparisonResult& result = comparison->getResult(index);
+    if (!result.ready || !result.error.empty()) return;
+
+    // Поиск шел для прежнего прицепа
+    stopSearch();
+
+    // Меню следует за строкой: пресет с тем же названием и размером, иначе пользовательский
+    auto preset = std::find_if(truckPresets.begin(), truckPresets.end(), [&](const TruckPreset& truck) {
+        return truck.label == candidate.name && truck.trailer == candidate.trailer;
+    });
+    if (preset != truckPresets.end()) {
+        truckSettings.currentPreset = static_cast<int>(preset - truckPresets.begin());
+        truckSettings.useCustom = false;
+    } else {
+        truckSettings.useCustom = true;
+        truckSettings.customWidth = candidate.trailer.width;
+        truckSettings.customHeight = candidate.trailer.height;
+        truckSettings.customDepth = candidate.trailer.depth;
+    }
+
+    // План уже посчитан - сцена переключается без упаковки
+    loadPlan = result.plan;
+    packerOptions = candidate.packer;
+    lastPackTimeMs = static_cast<float>(result.solveMs);
+    lastPackSource = "из сравнения";
+    comparisonSelected = index;
+    applyLoadPlan(scene);
 }
 
 void Renderer::cleanupUI() {
@@ -2,6 +2,8 @@
 #define RENDERER_H
 
 #include <glm/glm.hpp>
+#include <cstdint>
+#include <future>
 #include <memory>
 #include <vector>
 #include <string>
@@ -10,13 +12,32 @@
 #include "../graphics/Shader.h"
 #include "../graphics/Camera.h"
 #include "../scene/Scene.h"
+#include "../packing/Cargo.h"
+#include "../packing/LoadPlan.h"
+#include "../packing/OccupancyGrid.h"
+#include "../packing/ThreadPool.h"
+#include "../packing/ExactSearch.h"
+#include "../packing/PackingSearch.h"
+#include "../packing/LoadBalance.h"
+#include "../packing/FleetPacker.h"
+#include "../packing/PalletBuilder.h"
+#include "../packing/PresetComparison.h"
+#include "../io/ManifestImporter.h"
+#include "../io/LoadPlanFile.h"
+#include "../io/PlanCache.h"
+#include "../io/SegregationPresets.h"
+#include "../io/TruckPresets.h"
+#include "CargoTables.h"
+
+struct ImGuiTableSortSpecs;
 
 class Renderer {
 private:
     std::unique_ptr<Shader> modelShader;
 
     // UI
-    void renderMainMenuBar(GLFWwindow* window);
+    void renderMainMenuBar(GLFWwindow* window, Scene& scene);
+    void renderOpenManifestDialog(Scene& scene);
     void renderTruckInfoPanel(const Scene& scene);
     void renderPerformancePanel();
 
@@ -29,17 +50,88 @@ private:
         bool useCustom = false;
         bool tentOpen = false;
 
-        glm::vec3 getCurrentSize() const;
+        glm::vec3 getCurrentSize(const std::vector<TruckPreset>& presets) const;
     } truckSettings;
 
-    struct TruckPreset {
-        std::string name;
-        int width, height, depth;
-    };
-
     std::vector<TruckPreset> truckPresets;
 
-    void updateTruckSize();
+    // Импорт манифеста
+    char manifestPath[512] = "manifest.csv";
+    bool openManifestRequested = false;
+    std::string importStatus;
+
+    // Проект (.tlp): сохранение идет в фоне из снимка
+    std::string projectPath = "project.tlp";
+    std::future<void> saveTask;
+    std::string saveTarget;
+
+    // Packing
+    Manifest manifest;
+    LoadPlan loadPlan;
+    OccupancyGrid occupancy;
+    PackerOptions packerOptions;
+    LoadBalance loadBalance;
+    float lastPackTimeMs = 0.0f;
+    bool interiorPending = false;       // План упакован, пока объем кузова еще строился
+
+    std::unique_ptr<ThreadPool> threadPool;
+    std::unique_ptr<PackingSearch> search;
+
+    // Точный поиск для небольших манифестов; после него - доказанный разрыв до оптимума
+    std::unique_ptr<ExactSearch> exactSearch;
+    double exactGap = -1.0;             // < 0 - точный поиск для текущего плана не запускался
+    bool exactExhausted = false;        // Перебраны все порядки и повороты упаковщика
+
+    // Решенные задачи: повторно открытый манифест не упаковывается заново
+    std::unique_ptr<PlanCache> planCache;
+    const char* lastPackSource = "";
+
+    // Режим парка: пока fleetPlan не пуст, сцена показывает все машины
+    std::vector<FleetVehicle> fleetVehicles;
+    FleetPlan fleetPlan;
+
+    // Режим поддонов: коробки сначала собираются на поддоны, затем поддоны - в прицеп
+    PalletOptions palletOptions;
+    PalletizedPlan palletPlan;
+
+    // Сравнение пресетов: все прицепы упаковываются параллельно на пуле,
+    // строка таблицы переключает сцену на готовый план без пересчета.
+    // comparisonOrder - порядок строк по текущей сортировке таблицы
+    std::unique_ptr<PresetComparison> comparison;
+    std::vector<size_t> comparisonOrder;
+    size_t comparisonSelected = SIZE_MAX;
+    bool showComparison = false;
+    bool comparisonSortDirty = false;
+
+    // Таблицы типов, коробок и размещений текущего плана
+    CargoTables cargoTables;
+    bool showCargoTables = false;
+
+    TrailerSpec getCurrentTrailer() const;
+    void updateTruckSize(Scene& scene);
+    void loadManifest(Scene& scene, const std::string& path);
+    void loadProject(Scene& scene, const std::string& path);
+    void newProject(Scene& scene);
+    void saveProject();
+    void pollSave();
+    void applyLoadPlan(Scene& scene);
+    void refreshPackerOptions(const Scene& scene);
+    std::shared_ptr<const TrailerInterior> usableInterior(const Scene& scene) const;
+    void pollInterior(Scene& scene);
+    void renderLoadBalance();
+    void startSearch(const Scene& scene);
+    void startExactSearch(const Scene& scene);
+    void stopSearch();
+    void pollSearch(Scene& scene);
+    void packFleet(Scene& scene);
+    void renderFleetInfo();
+    void packPallets(Scene& scene);
+    void renderPalletInfo();
+    void startComparison(const Scene& scene);
+    void pollComparison();
+    void renderComparisonPanel(Scene& scene);
+    void sortComparison(const ImGuiTableSortSpecs* specs);
+    void applyComparison(Scene& scene, size_t index);
 
 public:
     Renderer();
@@ -48,7 +140,7 @@ public:
     void initializeUI(GLFWwindow* window);
     void clear();
     void render(const Scene& scene, const Camera& camera);
-    void renderUI(const Scene& scene, GLFWwindow* window);
+    void renderUI(Scene& scene, GLFWwindow* window);
     void cleanupUI();
 };
 
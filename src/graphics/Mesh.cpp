@@ -12,6 +12,8 @@ Mesh::~Mesh() {
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &EBO);
+    if (instanceVBO) glDeleteBuffers(1, &instanceVBO);
+    if (indirectBuffer) glDeleteBuffers(1, &indirectBuffer);
 }
 
 void Mesh::draw(const Shader& shader) const {
@@ -85,6 +87,114 @@ void Mesh::drawInstanced(const Shader& shader, unsigned int amount) const {
     glActiveTexture(GL_TEXTURE0);
 }
 
+void Mesh::setInstances(const std::vector<glm::mat4>& transforms, const std::vector<glm::vec3>& colors) {
+    std::vector<InstanceData> data(transforms.size());
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i].model = transforms[i];
+        data[i].color = i < colors.size() ? colors[i] : material.diffuse;
+    }
+
+    if (!instanceVBO) glGenBuffers(1, &instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(InstanceData), data.empty() ? nullptr : data.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    instanceCount = data.size();
+}
+
+void Mesh::bindInstanceAttributes(size_t first) const {
+    // В GL 3.3 нет baseInstance, поэтому начало диапазона задается смещением указателей
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    size_t base = first * sizeof(InstanceData);
+
+    for (unsigned int column = 0; column < 4; column++) {
+        glEnableVertexAttribArray(5 + column);
+        glVertexAttribPointer(5 + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              (void*)(base + offsetof(InstanceData, model) + column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(5 + column, 1);
+    }
+
+    glEnableVertexAttribArray(9);
+    glVertexAttribPointer(9, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(base + offsetof(InstanceData, color)));
+    glVertexAttribDivisor(9, 1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Mesh::drawInstances(const Shader& shader, size_t first, size_t count) const {
+    if (!instanceVBO || count == 0 || first + count > instanceCount) return;
+
+    shader.setVec3("material_ambient", material.ambient);
+    shader.setVec3("material_diffuse", material.diffuse);
+    shader.setVec3("material_specular", material.specular);
+    shader.setFloat("material_shininess", material.shininess);
+    shader.setBool("has_diffuse_texture", false);
+    shader.setBool("use_instancing", true);
+
+    glBindVertexArray(VAO);
+    bindInstanceAttributes(first);
+    glDrawElementsInstanced(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0,
+                            static_cast<GLsizei>(count));
+    glBindVertexArray(0);
+
+    shader.setBool("use_instancing", false);
+}
+
+bool Mesh::supportsIndirect() {
+#ifdef GL_VERSION_4_3
+    return GLAD_GL_VERSION_4_3 != 0;
+#else
+    return false;
+#endif
+}
+
+void Mesh::drawInstancesIndirect(const Shader& shader, const std::vector<std::pair<size_t, size_t>>& ranges) const {
+    if (!instanceVBO || ranges.empty()) return;
+
+    if (!supportsIndirect()) {
+        for (const auto& range : ranges) drawInstances(shader, range.first, range.second);
+        return;
+    }
+
+#ifdef GL_VERSION_4_3
+    // Раскладка команды задана спецификацией DrawElementsIndirectCommand
+    struct Command {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+    std::vector<Command> commands;
+    commands.reserve(ranges.size());
+    for (const auto& range : ranges) {
+        if (range.second == 0 || range.first + range.second > instanceCount) continue;
+        commands.push_back(Command{static_cast<GLuint>(indices.size()), static_cast<GLuint>(range.second), 0, 0,
+                                   static_cast<GLuint>(range.first)});
+    }
+    if (commands.empty()) return;
+
+    shader.setVec3("material_ambient", material.ambient);
+    shader.setVec3("material_diffuse", material.diffuse);
+    shader.setVec3("material_specular", material.specular);
+    shader.setFloat("material_shininess", material.shininess);
+    shader.setBool("has_diffuse_texture", false);
+    shader.setBool("use_instancing", true);
+
+    if (!indirectBuffer) glGenBuffers(1, &indirectBuffer);
+    glBindVertexArray(VAO);
+    // baseInstance сдвигает выборку атрибутов с делителем, поэтому указатели - с нуля
+    bindInstanceAttributes(0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(Command), commands.data(), GL_STREAM_DRAW);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(commands.size()), 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    glBindVertexArray(0);
+
+    shader.setBool("use_instancing", false);
+#endif
+}
+
 void Mesh::optimize() {
     if (optimized) return;
 
@@ -6,6 +6,7 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <string>
+#include <utility>
 #include <vector>
 #include <unordered_map>
 #include "Shader.h"
@@ -50,6 +51,17 @@ public:
     // Instanced rendering for better performance when drawing many identical objects
     void drawInstanced(const Shader& shader, unsigned int amount) const;
 
+    // Данные экземпляров: матрица модели (location 5-8) и цвет (location 9).
+    // drawInstances рисует диапазон [first, first + count) одним вызовом.
+    void setInstances(const std::vector<glm::mat4>& transforms, const std::vector<glm::vec3>& colors);
+    void drawInstances(const Shader& shader, size_t first, size_t count) const;
+    size_t getInstanceCount() const { return instanceCount; }
+
+    // Несколько диапазонов экземпляров одним glMultiDrawElementsIndirect (нужен GL 4.3).
+    // ranges - пары (first, count). Без поддержки рисует по одному drawInstances на диапазон.
+    void drawInstancesIndirect(const Shader& shader, const std::vector<std::pair<size_t, size_t>>& ranges) const;
+    static bool supportsIndirect();
+
     // Optimization methods
     void optimize();
 
@@ -61,7 +73,17 @@ public:
     size_t getTriangleCount() const { return indices.size() / 3; }
 
 private:
+    struct InstanceData {
+        glm::mat4 model;
+        glm::vec3 color;
+    };
+
+    unsigned int instanceVBO = 0;
+    size_t instanceCount = 0;
+    mutable unsigned int indirectBuffer = 0;
+
     void setupMesh();
+    void bindInstanceAttributes(size_t first) const;
     void removeDuplicateVertices();
     void optimizeVertexCache();
 };
@@ -11,6 +11,10 @@ Model::Model(const std::string& path) {
     loadModel(path);
 }
 
+Model::Model(std::unique_ptr<Mesh> mesh) {
+    meshes.push_back(std::move(mesh));
+}
+
 void Model::draw(const Shader& shader) const {
     for (const auto& mesh : meshes) {
         mesh->draw(shader);
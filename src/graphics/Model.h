@@ -26,6 +26,8 @@ private:
 
 public:
     Model(const std::string& path);
+    // Модель из одной готовой сетки (без файла и текстур)
+    explicit Model(std::unique_ptr<Mesh> mesh);
     ~Model() = default;
 
     void draw(const Shader& shader) const;
@@ -42,6 +44,9 @@ public:
     size_t getTriangleCount() const;
     size_t getVertexCount() const;
 
+    // Сетки в координатах модели (без смещения сцены)
+    const std::vector<std::unique_ptr<Mesh>>& getMeshes() const { return meshes; }
+
 private:
     void loadModel(const std::string& path);
     void processNode(aiNode* node, const aiScene* scene);
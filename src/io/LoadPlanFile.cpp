@@ -0,0 +1,267 @@
+#include "LoadPlanFile.h"
+#include "../packing/Segregation.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+uint64_t alignUp(uint64_t value) {
+    return (value + 7) & ~uint64_t(7);
+}
+
+uint16_t toFixed(int value) {
+    return static_cast<uint16_t>(value << planfile::FIXED_SHIFT);
+}
+
+int fromFixed(uint16_t value) {
+    return static_cast<int>(value >> planfile::FIXED_SHIFT);
+}
+
+} // namespace
+
+LoadPlanFile::LoadPlanFile(const std::string& path) : file(path) {
+    validate(path);
+}
+
+void LoadPlanFile::validate(const std::string& path) {
+    const char* data = file.getData();
+    uint64_t size = file.getSize();
+    auto fail = [&path](const char* reason) {
+        throw std::runtime_error("Invalid load plan file " + path + ": " + reason);
+    };
+
+    if (size < sizeof(planfile::Header)) fail("too small");
+    header = reinterpret_cast<const planfile::Header*>(data);
+    if (std::memcmp(header->magic, planfile::MAGIC, sizeof(planfile::MAGIC)) != 0) fail("bad magic");
+    if (header->version < planfile::MIN_VERSION || header->version > planfile::VERSION) fail("unsupported version");
+    if (header->headerSize != sizeof(planfile::Header) || header->fileSize != size) fail("size mismatch");
+
+    // Каждая секция должна целиком лежать в файле и быть выровнена
+    auto section = [&](uint64_t offset, uint64_t count, uint64_t elementSize) {
+        if (offset % 8 != 0 || offset > size || count > (size - offset) / elementSize) fail("section out of range");
+        return data + offset;
+    };
+
+    types = reinterpret_cast<const planfile::TypeRecord*>(
+        section(header->typesOffset, header->typeCount, sizeof(planfile::TypeRecord)));
+    strings = section(header->stringsOffset, 0, 1);
+    items = reinterpret_cast<const uint32_t*>(section(header->itemsOffset, header->itemCount, sizeof(uint32_t)));
+    stops = reinterpret_cast<const uint16_t*>(section(header->stopsOffset, header->itemCount, sizeof(uint16_t)));
+    placements = reinterpret_cast<const planfile::PlacementRecord*>(
+        section(header->placementsOffset, header->placementCount, sizeof(planfile::PlacementRecord)));
+    unplaced = reinterpret_cast<const uint32_t*>(
+        section(header->unplacedOffset, header->unplacedCount, sizeof(uint32_t)));
+
+    // Нулевые и отрицательные размеры дальше сломали бы упаковщик и индекс свободного места
+    if (header->trailerWidth <= 0 || header->trailerHeight <= 0 || header->trailerDepth <= 0 ||
+        header->trailerWidth > planfile::MAX_COORDINATE || header->trailerHeight > planfile::MAX_COORDINATE ||
+        header->trailerDepth > planfile::MAX_COORDINATE) {
+        fail("bad trailer dimensions");
+    }
+
+    uint64_t stringsSize = header->itemsOffset - header->stringsOffset;
+    if (header->itemsOffset < header->stringsOffset) fail("bad string table");
+    for (uint32_t t = 0; t < header->typeCount; t++) {
+        const planfile::TypeRecord& type = types[t];
+        if (static_cast<uint64_t>(type.skuOffset) + type.skuLength > stringsSize) fail("bad SKU string");
+        if (type.width <= 0 || type.height <= 0 || type.depth <= 0) fail("bad type dimensions");
+        if (header->version >= 2 && (type.shape > static_cast<uint8_t>(CargoShape::Cylinder) ||
+                                     type.compatibilityClass >= COMPATIBILITY_CLASS_COUNT)) {
+            fail("bad type shape or class");
+        }
+    }
+    for (uint32_t i = 0; i < header->itemCount; i++) {
+        if (items[i] >= header->typeCount) fail("bad item type");
+    }
+    for (uint32_t p = 0; p < header->placementCount; p++) {
+        if (placements[p].item >= header->itemCount || placements[p].orientation >= ORIENTATION_COUNT ||
+            placements[p].rollBlock > ROLL_BLOCK_NEXT) {
+            fail("bad placement");
+        }
+    }
+    for (uint32_t u = 0; u < header->unplacedCount; u++) {
+        if (unplaced[u] >= header->itemCount) fail("bad unplaced item");
+    }
+}
+
+TrailerSpec LoadPlanFile::getTrailer() const {
+    return TrailerSpec{header->trailerWidth, header->trailerHeight, header->trailerDepth};
+}
+
+std::string_view LoadPlanFile::getSku(uint32_t type) const {
+    return std::string_view(strings + types[type].skuOffset, types[type].skuLength);
+}
+
+Placement LoadPlanFile::getPlacement(size_t index) const {
+    const planfile::PlacementRecord& record = placements[index];
+    const planfile::TypeRecord& type = types[items[record.item]];
+
+    BoxType box;
+    box.width = type.width;
+    box.height = type.height;
+    box.depth = type.depth;
+
+    Placement placement;
+    placement.item = record.item;
+    placement.x = fromFixed(record.x);
+    placement.y = fromFixed(record.y);
+    placement.z = fromFixed(record.z);
+    placement.orientation = record.orientation;
+    placement.rollBlock = record.rollBlock;
+    box.orientedSize(record.orientation, placement.width, placement.height, placement.depth);
+    return placement;
+}
+
+Manifest LoadPlanFile::toManifest() const {
+    Manifest manifest;
+    manifest.types.reserve(header->typeCount);
+    for (uint32_t t = 0; t < header->typeCount; t++) {
+        const planfile::TypeRecord& record = types[t];
+        BoxType type;
+        type.sku = std::string(getSku(t));
+        type.width = record.width;
+        type.height = record.height;
+        type.depth = record.depth;
+        type.weight = record.weight;
+        type.maxStackLoad = record.maxStackLoad;
+        type.minSupport = record.minSupport;
+        type.orientations = record.orientations;
+        if (header->version >= 2) {
+            type.shape = static_cast<CargoShape>(record.shape);
+            type.compatibilityClass = record.compatibilityClass;
+        }
+        manifest.addType(type);
+    }
+
+    manifest.items.assign(items, items + header->itemCount);
+    manifest.itemStops.assign(stops, stops + header->itemCount);
+    return manifest;
+}
+
+LoadPlan LoadPlanFile::toLoadPlan() const {
+    LoadPlan plan;
+    plan.trailer = getTrailer();
+    plan.placements.reserve(header->placementCount);
+    for (size_t p = 0; p < header->placementCount; p++) {
+        plan.placements.push_back(getPlacement(p));
+    }
+    plan.unplaced.assign(unplaced, unplaced + header->unplacedCount);
+    return plan;
+}
+
+void LoadPlanFile::save(const ProjectSnapshot& snapshot, const std::string& path) {
+    const Manifest& manifest = snapshot.manifest;
+    const LoadPlan& plan = snapshot.plan;
+
+    const TrailerSpec& trailer = plan.trailer;
+    if (trailer.width <= 0 || trailer.height <= 0 || trailer.depth <= 0) {
+        throw std::runtime_error("Trailer has no volume");
+    }
+    if (trailer.width > planfile::MAX_COORDINATE || trailer.height > planfile::MAX_COORDINATE ||
+        trailer.depth > planfile::MAX_COORDINATE) {
+        throw std::runtime_error("Trailer is too large for the load plan format");
+    }
+    if (manifest.itemStops.size() != manifest.items.size()) {
+        throw std::runtime_error("Manifest stops are inconsistent with items");
+    }
+
+    // Раскладка секций
+    uint64_t stringsSize = 0;
+    for (const auto& type : manifest.types) stringsSize += type.sku.size();
+
+    planfile::Header header = {};
+    std::memcpy(header.magic, planfile::MAGIC, sizeof(planfile::MAGIC));
+    header.version = planfile::VERSION;
+    header.headerSize = sizeof(planfile::Header);
+    header.trailerWidth = trailer.width;
+    header.trailerHeight = trailer.height;
+    header.trailerDepth = trailer.depth;
+    header.typeCount = static_cast<uint32_t>(manifest.types.size());
+    header.itemCount = static_cast<uint32_t>(manifest.items.size());
+    header.placementCount = static_cast<uint32_t>(plan.placements.size());
+    header.unplacedCount = static_cast<uint32_t>(plan.unplaced.size());
+
+    header.typesOffset = alignUp(sizeof(planfile::Header));
+    header.stringsOffset = alignUp(header.typesOffset + header.typeCount * sizeof(planfile::TypeRecord));
+    header.itemsOffset = alignUp(header.stringsOffset + stringsSize);
+    header.stopsOffset = alignUp(header.itemsOffset + header.itemCount * sizeof(uint32_t));
+    header.placementsOffset = alignUp(header.stopsOffset + header.itemCount * sizeof(uint16_t));
+    header.unplacedOffset = alignUp(header.placementsOffset + header.placementCount * sizeof(planfile::PlacementRecord));
+    header.fileSize = alignUp(header.unplacedOffset + header.unplacedCount * sizeof(uint32_t));
+
+    // Файл собирается в памяти и пишется одним вызовом
+    std::vector<char> buffer(header.fileSize, 0);
+    std::memcpy(buffer.data(), &header, sizeof(header));
+
+    uint32_t skuOffset = 0;
+    for (size_t t = 0; t < manifest.types.size(); t++) {
+        const BoxType& type = manifest.types[t];
+        planfile::TypeRecord record = {};
+        record.skuOffset = skuOffset;
+        record.skuLength = static_cast<uint32_t>(type.sku.size());
+        record.width = type.width;
+        record.height = type.height;
+        record.depth = type.depth;
+        record.weight = type.weight;
+        record.maxStackLoad = type.maxStackLoad;
+        record.minSupport = type.minSupport;
+        record.orientations = type.orientations;
+        record.shape = static_cast<uint8_t>(type.shape);
+        record.compatibilityClass = type.compatibilityClass;
+
+        std::memcpy(buffer.data() + header.typesOffset + t * sizeof(record), &record, sizeof(record));
+        std::memcpy(buffer.data() + header.stringsOffset + skuOffset, type.sku.data(), type.sku.size());
+        skuOffset += record.skuLength;
+    }
+
+    if (!manifest.items.empty()) {
+        std::memcpy(buffer.data() + header.itemsOffset, manifest.items.data(), manifest.items.size() * sizeof(uint32_t));
+        std::memcpy(buffer.data() + header.stopsOffset, manifest.itemStops.data(), manifest.itemStops.size() * sizeof(uint16_t));
+    }
+
+    for (size_t p = 0; p < plan.placements.size(); p++) {
+        const Placement& placement = plan.placements[p];
+        planfile::PlacementRecord record = {};
+        record.item = placement.item;
+        record.x = toFixed(placement.x);
+        record.y = toFixed(placement.y);
+        record.z = toFixed(placement.z);
+        record.orientation = placement.orientation;
+        record.rollBlock = placement.rollBlock;
+        std::memcpy(buffer.data() + header.placementsOffset + p * sizeof(record), &record, sizeof(record));
+    }
+
+    if (!plan.unplaced.empty()) {
+        std::memcpy(buffer.data() + header.unplacedOffset, plan.unplaced.data(), plan.unplaced.size() * sizeof(uint32_t));
+    }
+
+    // Временный файл и замена: открытый в другом месте проект не увидит половину записи
+    std::string tempPath = path + ".tmp";
+    FILE* output = std::fopen(tempPath.c_str(), "wb");
+    if (!output) {
+        throw std::runtime_error("Cannot write file: " + tempPath);
+    }
+    bool written = std::fwrite(buffer.data(), 1, buffer.size(), output) == buffer.size();
+    written &= std::fclose(output) == 0;
+    if (!written) {
+        std::remove(tempPath.c_str());
+        throw std::runtime_error("Cannot write file: " + tempPath);
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error) {
+        std::remove(tempPath.c_str());
+        throw std::runtime_error("Cannot replace file " + path + ": " + error.message());
+    }
+}
+
+std::future<void> LoadPlanFile::saveAsync(std::shared_ptr<const ProjectSnapshot> snapshot, const std::string& path) {
+    // Отдельный поток, а не пул: запись не должна ждать задач поиска
+    return std::async(std::launch::async, [snapshot, path]() {
+        save(*snapshot, path);
+    });
+}
@@ -0,0 +1,126 @@
+#ifndef LOADPLANFILE_H
+#define LOADPLANFILE_H
+
+#pragma once
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "MappedFile.h"
+#include "../packing/Cargo.h"
+#include "../packing/LoadPlan.h"
+
+// Бинарный формат проекта (.tlp): прицеп, таблица SKU, манифест и план загрузки.
+// Порядок байт - little-endian, все секции выровнены на 8 байт, поэтому файл
+// читается прямо из отображения в память без разбора.
+//
+//   Header | TypeRecord[typeCount] | строки SKU | uint32 items[itemCount] |
+//   uint16 stops[itemCount] | PlacementRecord[placementCount] | uint32 unplaced[unplacedCount]
+namespace planfile {
+
+constexpr char MAGIC[8] = {'T', 'L', 'S', 'P', 'L', 'A', 'N', '\0'};
+// Версия 2: байты shape и compatibilityClass в TypeRecord (в версии 1 - reserved).
+// Версия 1 читается с коробками и классом 0.
+constexpr uint32_t VERSION = 2;
+constexpr uint32_t MIN_VERSION = 1;
+
+// Координаты - беззнаковая фиксированная точка 12.4 в см (до 4095 см). Упаковщик
+// работает в целых см, поэтому дробная часть сейчас всегда 0 и при чтении отбрасывается;
+// 4 бита оставлены под доли см без смены формата
+constexpr int FIXED_SHIFT = 4;
+constexpr int MAX_COORDINATE = (0xFFFF >> FIXED_SHIFT);
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    int32_t trailerWidth, trailerHeight, trailerDepth;
+    uint32_t typeCount;
+    uint32_t itemCount;
+    uint32_t placementCount;
+    uint32_t unplacedCount;
+    uint32_t reserved;
+    uint64_t typesOffset;
+    uint64_t stringsOffset;
+    uint64_t itemsOffset;
+    uint64_t stopsOffset;
+    uint64_t placementsOffset;
+    uint64_t unplacedOffset;
+    uint64_t fileSize;
+};
+
+struct TypeRecord {
+    uint32_t skuOffset;         // От начала блока строк
+    uint32_t skuLength;
+    int32_t width, height, depth;
+    float weight;
+    float maxStackLoad;
+    float minSupport;
+    uint8_t orientations;
+    uint8_t shape;              // CargoShape, с версии 2
+    uint8_t compatibilityClass; // С версии 2
+    uint8_t reserved;
+};
+
+// Размеры после поворота не хранятся: они следуют из типа и orientation
+struct PlacementRecord {
+    uint32_t item;
+    uint16_t x, y, z;
+    uint8_t orientation;
+    uint8_t rollBlock;          // RollBlockMark; в старых файлах 0
+};
+
+static_assert(sizeof(Header) == 104, "planfile::Header layout changed");
+static_assert(sizeof(TypeRecord) == 36, "planfile::TypeRecord layout changed");
+static_assert(sizeof(PlacementRecord) == 12, "planfile::PlacementRecord layout changed");
+
+} // namespace planfile
+
+// Неизменяемый снимок проекта для фонового сохранения
+struct ProjectSnapshot {
+    Manifest manifest;
+    LoadPlan plan;
+};
+
+// Проект, открытый через одно отображение файла в память. Доступ к коробкам
+// не выделяет память; toManifest/toLoadPlan собирают обычные структуры целиком.
+class LoadPlanFile {
+private:
+    MappedFile file;
+    const planfile::Header* header = nullptr;
+    const planfile::TypeRecord* types = nullptr;
+    const char* strings = nullptr;
+    const uint32_t* items = nullptr;
+    const uint16_t* stops = nullptr;
+    const planfile::PlacementRecord* placements = nullptr;
+    const uint32_t* unplaced = nullptr;
+
+    void validate(const std::string& path);
+
+public:
+    // Бросает std::runtime_error, если файл не открывается, поврежден или
+    // содержит прицеп или тип с неположительными размерами
+    explicit LoadPlanFile(const std::string& path);
+
+    TrailerSpec getTrailer() const;
+    size_t getTypeCount() const { return header->typeCount; }
+    size_t getItemCount() const { return header->itemCount; }
+    size_t getPlacementCount() const { return header->placementCount; }
+    size_t getUnplacedCount() const { return header->unplacedCount; }
+
+    std::string_view getSku(uint32_t type) const;
+    Placement getPlacement(size_t index) const;
+
+    Manifest toManifest() const;
+    LoadPlan toLoadPlan() const;
+
+    // Бросает std::runtime_error; запись идет во временный файл с последующей заменой
+    static void save(const ProjectSnapshot& snapshot, const std::string& path);
+
+    // Сохранение в отдельном потоке: снимок не меняется, пока идет запись
+    static std::future<void> saveAsync(std::shared_ptr<const ProjectSnapshot> snapshot, const std::string& path);
+};
+
+#endif //LOADPLANFILE_H
@@ -0,0 +1,641 @@
+#include "ManifestImporter.h"
+#include "MappedFile.h"
+#include "../packing/Segregation.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+enum Field {
+    FIELD_SKU,
+    FIELD_WIDTH,
+    FIELD_HEIGHT,
+    FIELD_DEPTH,
+    FIELD_WEIGHT,
+    FIELD_QUANTITY,
+    FIELD_STOP,
+    FIELD_FRAGILE,
+    FIELD_SHAPE,
+    FIELD_CLASS,
+    FIELD_COUNT
+};
+
+constexpr unsigned REQUIRED_FIELDS = (1u << FIELD_SKU) | (1u << FIELD_WIDTH) | (1u << FIELD_HEIGHT) | (1u << FIELD_DEPTH);
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        char ca = (a[i] >= 'A' && a[i] <= 'Z') ? static_cast<char>(a[i] - 'A' + 'a') : a[i];
+        if (ca != b[i]) return false;
+    }
+    return true;
+}
+
+int fieldByName(std::string_view name) {
+    static const std::pair<const char*, Field> names[] = {
+        {"sku", FIELD_SKU}, {"article", FIELD_SKU}, {"id", FIELD_SKU},
+        {"width", FIELD_WIDTH}, {"height", FIELD_HEIGHT}, {"depth", FIELD_DEPTH},
+        {"weight", FIELD_WEIGHT}, {"mass", FIELD_WEIGHT},
+        {"quantity", FIELD_QUANTITY}, {"qty", FIELD_QUANTITY}, {"count", FIELD_QUANTITY},
+        {"stop", FIELD_STOP},
+        {"fragile", FIELD_FRAGILE}, {"fragility", FIELD_FRAGILE},
+        {"shape", FIELD_SHAPE}, {"form", FIELD_SHAPE},
+        {"class", FIELD_CLASS}, {"hazard", FIELD_CLASS}, {"compatibility", FIELD_CLASS}
+    };
+    for (const auto& entry : names) {
+        if (equalsIgnoreCase(name, entry.first)) return entry.second;
+    }
+    return -1;
+}
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && isSpace(text.front())) text.remove_prefix(1);
+    while (!text.empty() && isSpace(text.back())) text.remove_suffix(1);
+    return text;
+}
+
+std::string_view unquote(std::string_view text) {
+    text = trim(text);
+    if (text.size() >= 2 && text.front() == '"' && text.back() == '"') {
+        text = text.substr(1, text.size() - 2);
+    }
+    return text;
+}
+
+bool parseNumber(std::string_view text, double& value) {
+    text = unquote(text);
+    if (!text.empty() && text.front() == '+') text.remove_prefix(1);
+    if (text.empty()) return false;
+
+    // from_chars принимает "nan" и "inf": такие значения ломают сравнение ключей типов
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size() && std::isfinite(value);
+}
+
+bool parseFlag(std::string_view text, bool& value) {
+    text = unquote(text);
+    if (text.empty() || text == "0" || equalsIgnoreCase(text, "false") || equalsIgnoreCase(text, "no") ||
+        equalsIgnoreCase(text, "n") || text == "нет") {
+        value = false;
+        return true;
+    }
+    if (text == "1" || equalsIgnoreCase(text, "true") || equalsIgnoreCase(text, "yes") ||
+        equalsIgnoreCase(text, "y") || text == "да") {
+        value = true;
+        return true;
+    }
+
+    // Числовая степень хрупкости: любое положительное значение
+    double number = 0.0;
+    if (!parseNumber(text, number)) return false;
+    value = number > 0.0;
+    return true;
+}
+
+bool parseShape(std::string_view text, CargoShape& value) {
+    static const char* const cylinders[] = {"cylinder", "roll", "drum", "tyre", "tire", "barrel",
+                                            "цилиндр", "рулон", "бочка", "шина"};
+    static const char* const boxes[] = {"box", "cuboid", "коробка"};
+
+    text = unquote(text);
+    if (text.empty()) {
+        value = CargoShape::Box;
+        return true;
+    }
+    for (const char* name : cylinders) {
+        if (equalsIgnoreCase(text, name)) {
+            value = CargoShape::Cylinder;
+            return true;
+        }
+    }
+    for (const char* name : boxes) {
+        if (equalsIgnoreCase(text, name)) {
+            value = CargoShape::Box;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Одна запись манифеста; sku указывает в исходный текст
+struct Row {
+    std::string_view sku;
+    double size[3] = {0.0, 0.0, 0.0};
+    double weight = 0.0;
+    double quantity = 1.0;
+    double stop = 0.0;
+    bool fragile = false;
+    CargoShape shape = CargoShape::Box;
+    double compatibilityClass = 0.0;
+    unsigned seen = 0;
+
+    bool set(int field, std::string_view value) {
+        bool ok = true;
+        switch (field) {
+            case FIELD_SKU:      sku = unquote(value); ok = !sku.empty(); break;
+            case FIELD_WIDTH:    ok = parseNumber(value, size[0]); break;
+            case FIELD_HEIGHT:   ok = parseNumber(value, size[1]); break;
+            case FIELD_DEPTH:    ok = parseNumber(value, size[2]); break;
+            case FIELD_WEIGHT:   ok = parseNumber(value, weight); break;
+            case FIELD_QUANTITY: ok = parseNumber(value, quantity); break;
+            case FIELD_STOP:     ok = parseNumber(value, stop); break;
+            case FIELD_FRAGILE:  ok = parseFlag(value, fragile); break;
+            case FIELD_SHAPE:    ok = parseShape(value, shape); break;
+            case FIELD_CLASS:    ok = parseNumber(value, compatibilityClass); break;
+            default: return true;
+        }
+        if (ok) seen |= 1u << field;
+        return ok;
+    }
+};
+
+// Ключ интернирования: одинаковые коробки под одним SKU становятся одним типом
+struct TypeKey {
+    std::string_view sku;
+    int width, height, depth;
+    float weight;
+    bool fragile;
+    CargoShape shape;
+    uint8_t compatibilityClass;
+
+    bool operator==(const TypeKey& other) const {
+        return sku == other.sku && width == other.width && height == other.height &&
+               depth == other.depth && weight == other.weight && fragile == other.fragile &&
+               shape == other.shape && compatibilityClass == other.compatibilityClass;
+    }
+};
+
+struct TypeKeyHash {
+    size_t operator()(const TypeKey& key) const {
+        size_t hash = std::hash<std::string_view>()(key.sku);
+        auto mix = [&hash](size_t value) { hash ^= value + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2); };
+        mix(static_cast<size_t>(key.width));
+        mix(static_cast<size_t>(key.height));
+        mix(static_cast<size_t>(key.depth));
+        mix(std::hash<float>()(key.weight));
+        mix(key.fragile ? 1u : 0u);
+        mix(static_cast<size_t>(key.shape));
+        mix(key.compatibilityClass);
+        return hash;
+    }
+};
+
+// Результат разбора одного куска: уникальные типы в порядке первого появления
+// и количества по точкам разгрузки, чтобы слияние не зависело от числа потоков
+struct ChunkResult {
+    std::vector<TypeKey> types;
+    std::vector<std::vector<long long>> quantities;     // [тип][точка]
+    std::unordered_map<TypeKey, uint32_t, TypeKeyHash> typeIndex;
+
+    size_t rows = 0;
+    size_t skipped = 0;
+    std::string firstError;
+    const char* firstErrorAt = nullptr;     // Начало записи в исходном тексте, для номера строки
+
+    void fail(const char* message, std::string_view context) {
+        skipped++;
+        if (firstError.empty()) {
+            firstError = std::string(message) + ": " + std::string(trim(context.substr(0, 80)));
+            firstErrorAt = context.data();
+        }
+    }
+
+    void add(const Row& row, std::string_view context) {
+        rows++;
+        if ((row.seen & REQUIRED_FIELDS) != REQUIRED_FIELDS) {
+            fail("missing sku or dimensions", context);
+            return;
+        }
+
+        // Проверка до lround: значение вне предела не приводится к int
+        for (double size : row.size) {
+            if (!(size > 0.0 && size <= MAX_BOX_DIMENSION)) {
+                fail("invalid dimensions or weight", context);
+                return;
+            }
+        }
+        if (!(row.weight >= 0.0 && row.weight <= MAX_BOX_WEIGHT)) {
+            fail("invalid dimensions or weight", context);
+            return;
+        }
+
+        TypeKey key;
+        key.sku = row.sku;
+        key.width = static_cast<int>(std::lround(row.size[0]));
+        key.height = static_cast<int>(std::lround(row.size[1]));
+        key.depth = static_cast<int>(std::lround(row.size[2]));
+        key.weight = static_cast<float>(row.weight);
+        key.fragile = row.fragile;
+        key.shape = row.shape;
+        key.compatibilityClass = 0;
+        if (key.shape == CargoShape::Cylinder) {
+            // Диаметр - в обоих поперечных размерах, даже если в выгрузке они разные
+            key.width = key.depth = std::max(key.width, key.depth);
+        }
+
+        // Проверка до llround: огромное или NaN количество не приводится к целому
+        if (!(row.quantity >= 0.0 && row.quantity <= static_cast<double>(MAX_MANIFEST_BOXES))) {
+            fail("quantity out of range", context);
+            return;
+        }
+        if (!(row.stop >= 0.0 && row.stop <= 65535.0)) {
+            fail("invalid quantity or stop", context);
+            return;
+        }
+        long long quantity = std::llround(row.quantity);
+        long long stop = std::llround(row.stop);
+        if (key.width <= 0 || key.height <= 0 || key.depth <= 0 || key.weight < 0.0f) {
+            fail("invalid dimensions or weight", context);
+            return;
+        }
+        long long compatibilityClass = std::llround(std::clamp(row.compatibilityClass, -1.0, 64.0));
+        if (compatibilityClass < 0 || compatibilityClass >= static_cast<long long>(COMPATIBILITY_CLASS_COUNT)) {
+            fail("invalid compatibility class", context);
+            return;
+        }
+        key.compatibilityClass = static_cast<uint8_t>(compatibilityClass);
+        if (quantity < 0 || stop < 0 || stop > 0xFFFF) {
+            fail("invalid quantity or stop", context);
+            return;
+        }
+        if (quantity == 0) return;
+
+        // Почти все строки - повтор уже известного типа: поиск без выделения узла
+        uint32_t type;
+        auto found = typeIndex.find(key);
+        if (found != typeIndex.end()) {
+            type = found->second;
+        } else {
+            type = static_cast<uint32_t>(types.size());
+            typeIndex.emplace(key, type);
+            types.push_back(key);
+            quantities.emplace_back();
+        }
+
+        std::vector<long long>& perStop = quantities[type];
+        if (perStop.size() <= static_cast<size_t>(stop)) perStop.resize(static_cast<size_t>(stop) + 1, 0);
+        perStop[static_cast<size_t>(stop)] += quantity;
+    }
+};
+
+// --- CSV ---
+
+struct CsvLayout {
+    char separator = ',';
+    std::vector<int> columns;       // Индекс колонки -> Field или -1
+    size_t dataStart = 0;
+};
+
+std::string_view nextLine(std::string_view text, size_t& pos) {
+    const char* begin = text.data() + pos;
+    const void* newline = std::memchr(begin, '\n', text.size() - pos);
+    size_t length = newline ? static_cast<size_t>(static_cast<const char*>(newline) - begin) : text.size() - pos;
+    pos += length + (newline ? 1 : 0);
+
+    std::string_view line(begin, length);
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    return line;
+}
+
+// Поля строки: разделитель внутри кавычек не делит поле, кавычки не раскрываются
+template <typename Callback>
+void forEachField(std::string_view line, char separator, Callback&& callback) {
+    size_t column = 0;
+    size_t start = 0;
+    bool quoted = false;
+    for (size_t i = 0; i <= line.size(); i++) {
+        if (i < line.size()) {
+            if (line[i] == '"') quoted = !quoted;
+            if (quoted || line[i] != separator) continue;
+        }
+        callback(column++, line.substr(start, i - start));
+        start = i + 1;
+    }
+}
+
+CsvLayout readCsvHeader(std::string_view text) {
+    CsvLayout layout;
+    size_t pos = 0;
+    std::string_view header = nextLine(text, pos);
+    layout.dataStart = pos;
+
+    size_t commas = 0, semicolons = 0;
+    for (char c : header) {
+        if (c == ',') commas++;
+        else if (c == ';') semicolons++;
+    }
+    layout.separator = semicolons > commas ? ';' : ',';
+
+    unsigned seen = 0;
+    forEachField(header, layout.separator, [&layout, &seen](size_t, std::string_view name) {
+        int field = fieldByName(unquote(name));
+        layout.columns.push_back(field);
+        if (field >= 0) seen |= 1u << field;
+    });
+
+    if ((seen & REQUIRED_FIELDS) != REQUIRED_FIELDS) {
+        throw std::runtime_error("CSV header must contain sku, width, height and depth columns");
+    }
+    return layout;
+}
+
+void parseCsvChunk(std::string_view chunk, const CsvLayout& layout, ChunkResult& result) {
+    size_t pos = 0;
+    while (pos < chunk.size()) {
+        std::string_view line = nextLine(chunk, pos);
+        if (trim(line).empty()) continue;
+
+        Row row;
+        bool ok = true;
+        forEachField(line, layout.separator, [&](size_t column, std::string_view value) {
+            if (column < layout.columns.size() && layout.columns[column] >= 0) {
+                ok &= row.set(layout.columns[column], value);
+            }
+        });
+
+        if (!ok) {
+            result.rows++;
+            result.fail("invalid value", line);
+            continue;
+        }
+        result.add(row, line);
+    }
+}
+
+// --- JSON ---
+
+size_t skipSpace(std::string_view text, size_t pos) {
+    while (pos < text.size() && isSpace(text[pos])) pos++;
+    return pos;
+}
+
+// Конец строки JSON, начинающейся с кавычки в pos (позиция после закрывающей кавычки)
+size_t skipString(std::string_view text, size_t pos) {
+    for (pos++; pos < text.size(); pos++) {
+        if (text[pos] == '\\') pos++;
+        else if (text[pos] == '"') return pos + 1;
+    }
+    return std::string_view::npos;
+}
+
+size_t findJsonItems(std::string_view text) {
+    size_t pos = skipSpace(text, 0);
+    if (pos < text.size() && text[pos] == '[') return pos + 1;
+
+    // {"items": [...]} - ищем массив по ключу верхнего уровня
+    size_t key = text.find("\"items\"");
+    if (key != std::string_view::npos) {
+        size_t array = text.find('[', key);
+        if (array != std::string_view::npos) return array + 1;
+    }
+    throw std::runtime_error("JSON manifest must be an array of items or contain an \"items\" array");
+}
+
+// Разбирает плоский объект с началом в pos; возвращает позицию после '}' или npos
+size_t parseJsonObject(std::string_view text, size_t pos, Row& row, bool& ok) {
+    pos = skipSpace(text, pos + 1);
+    while (pos < text.size() && text[pos] != '}') {
+        if (text[pos] != '"') return std::string_view::npos;
+        size_t keyEnd = skipString(text, pos);
+        if (keyEnd == std::string_view::npos) return keyEnd;
+        std::string_view key = text.substr(pos + 1, keyEnd - pos - 2);
+
+        pos = skipSpace(text, keyEnd);
+        if (pos >= text.size() || text[pos] != ':') return std::string_view::npos;
+        pos = skipSpace(text, pos + 1);
+        if (pos >= text.size()) return std::string_view::npos;
+
+        size_t valueEnd;
+        if (text[pos] == '"') {
+            valueEnd = skipString(text, pos);
+        } else if (text[pos] == '{' || text[pos] == '[') {
+            return std::string_view::npos;      // Вложенные значения не поддерживаются
+        } else {
+            valueEnd = pos;
+            while (valueEnd < text.size() && text[valueEnd] != ',' && text[valueEnd] != '}' && !isSpace(text[valueEnd])) {
+                valueEnd++;
+            }
+        }
+        if (valueEnd == std::string_view::npos) return valueEnd;
+
+        std::string_view value = text.substr(pos, valueEnd - pos);
+        int field = fieldByName(key);
+        if (field >= 0 && value != "null") ok &= row.set(field, value);
+
+        pos = skipSpace(text, valueEnd);
+        if (pos < text.size() && text[pos] == ',') pos = skipSpace(text, pos + 1);
+    }
+    return pos < text.size() ? pos + 1 : std::string_view::npos;
+}
+
+// Граница куска JSON: '{', перед которым (через пробелы) стоят ',' и '}'.
+// Такое сочетание внутри строкового значения SKU считается невозможным.
+size_t nextJsonBoundary(std::string_view text, size_t pos) {
+    while ((pos = text.find('{', pos)) != std::string_view::npos) {
+        size_t back = pos;
+        while (back > 0 && isSpace(text[back - 1])) back--;
+        if (back > 0 && text[back - 1] == ',') {
+            back--;
+            while (back > 0 && isSpace(text[back - 1])) back--;
+            if (back > 0 && text[back - 1] == '}') return pos;
+        }
+        pos++;
+    }
+    return text.size();
+}
+
+// text - весь документ, [begin, end) - кусок; объект, начавшийся в куске, дочитывается до конца
+void parseJsonChunk(std::string_view text, size_t begin, size_t end, ChunkResult& result) {
+    size_t pos = begin;
+    while (true) {
+        pos = skipSpace(text, pos);
+        while (pos < text.size() && text[pos] == ',') pos = skipSpace(text, pos + 1);
+        if (pos >= end || text[pos] == ']') break;
+
+        if (text[pos] != '{') {
+            // Мусор между объектами: пропускаем до следующего объекта
+            result.rows++;
+            result.fail("expected object", text.substr(pos));
+            size_t next = text.find('{', pos);
+            if (next == std::string_view::npos) break;
+            pos = next;
+            continue;
+        }
+
+        Row row;
+        bool ok = true;
+        size_t objectEnd = parseJsonObject(text, pos, row, ok);
+        if (objectEnd == std::string_view::npos) {
+            result.rows++;
+            result.fail("malformed object", text.substr(pos));
+            pos = nextJsonBoundary(text, pos + 1);
+            continue;
+        }
+
+        std::string_view object = text.substr(pos, objectEnd - pos);
+        if (ok) {
+            result.add(row, object);
+        } else {
+            result.rows++;
+            result.fail("invalid value", object);
+        }
+        pos = objectEnd;
+    }
+}
+
+// Куски [begin, end) примерно по chunkSize байт, выровненные по началу записи
+std::vector<std::pair<size_t, size_t>> splitChunks(std::string_view text, size_t start, size_t chunkSize, bool json) {
+    std::vector<std::pair<size_t, size_t>> chunks;
+    size_t begin = start;
+    while (begin < text.size()) {
+        size_t end = text.size();
+        if (text.size() - begin > chunkSize) {
+            size_t target = begin + chunkSize;
+            if (json) {
+                end = nextJsonBoundary(text, target);
+            } else {
+                size_t newline = text.find('\n', target);
+                end = newline == std::string_view::npos ? text.size() : newline + 1;
+            }
+        }
+        chunks.emplace_back(begin, end);
+        begin = end;
+    }
+    return chunks;
+}
+
+Manifest merge(std::string_view text, std::vector<ChunkResult>& chunks, ImportReport* report) {
+    Manifest manifest;
+    std::unordered_map<TypeKey, uint32_t, TypeKeyHash> typeIndex;
+    std::vector<std::vector<long long>> quantities;
+
+    ImportReport summary;
+    for (auto& chunk : chunks) {
+        for (size_t i = 0; i < chunk.types.size(); i++) {
+            const TypeKey& key = chunk.types[i];
+            auto inserted = typeIndex.emplace(key, static_cast<uint32_t>(manifest.types.size()));
+            if (inserted.second) {
+                BoxType type;
+                type.sku = std::string(key.sku);
+                type.width = key.width;
+                type.height = key.height;
+                type.depth = key.depth;
+                type.weight = key.weight;
+                type.shape = key.shape;
+                type.compatibilityClass = key.compatibilityClass;
+                if (key.fragile) type.maxStackLoad = 0.0f;
+                manifest.addType(type);
+                quantities.emplace_back();
+            }
+
+            std::vector<long long>& total = quantities[inserted.first->second];
+            const std::vector<long long>& local = chunk.quantities[i];
+            if (total.size() < local.size()) total.resize(local.size(), 0);
+            for (size_t stop = 0; stop < local.size(); stop++) total[stop] += local[stop];
+        }
+
+        summary.rows += chunk.rows;
+        summary.skipped += chunk.skipped;
+        if (summary.firstError.empty() && !chunk.firstError.empty()) {
+            // Номер строки считается один раз, для первой ошибки файла
+            size_t line = 1 + static_cast<size_t>(std::count(text.data(), chunk.firstErrorAt, '\n'));
+            summary.firstError = "line " + std::to_string(line) + ": " + chunk.firstError;
+        }
+    }
+
+    // Каждая строка не больше предела, поэтому 64-битная сумма не переполняется
+    long long boxes = 0;
+    for (const auto& perStop : quantities) {
+        for (long long quantity : perStop) boxes += quantity;
+    }
+    if (boxes > MAX_MANIFEST_BOXES) {
+        throw std::runtime_error("Manifest has " + std::to_string(boxes) + " boxes, limit is " +
+                                 std::to_string(MAX_MANIFEST_BOXES));
+    }
+    manifest.items.reserve(static_cast<size_t>(boxes));
+    manifest.itemStops.reserve(static_cast<size_t>(boxes));
+
+    for (size_t type = 0; type < quantities.size(); type++) {
+        for (size_t stop = 0; stop < quantities[type].size(); stop++) {
+            if (quantities[type][stop] == 0) continue;
+            manifest.addItems(static_cast<uint32_t>(type), static_cast<int>(quantities[type][stop]),
+                              static_cast<uint16_t>(stop));
+        }
+    }
+
+    summary.types = manifest.types.size();
+    summary.boxes = manifest.items.size();
+    if (report) *report = std::move(summary);
+    return manifest;
+}
+
+} // namespace
+
+ManifestImporter::ManifestImporter(ThreadPool* pool) : pool(pool) {
+}
+
+Manifest ManifestImporter::load(const std::string& path, ImportReport* report) const {
+    MappedFile file(path);
+    std::string_view text = file.view();
+
+    // Формат - по расширению, иначе по первому символу
+    bool json = false;
+    size_t dot = path.find_last_of('.');
+    if (dot != std::string::npos && equalsIgnoreCase(std::string_view(path).substr(dot), ".json")) {
+        json = true;
+    } else {
+        size_t first = skipSpace(text, 0);
+        json = first < text.size() && (text[first] == '[' || text[first] == '{');
+    }
+
+    return parse(text, json, report);
+}
+
+Manifest ManifestImporter::parse(std::string_view text, bool json, ImportReport* report) const {
+    // UTF-8 BOM из выгрузок Excel
+    if (text.size() >= 3 && text.compare(0, 3, "\xEF\xBB\xBF") == 0) text.remove_prefix(3);
+
+    CsvLayout layout;
+    size_t start = 0;
+    if (json) {
+        start = findJsonItems(text);
+    } else {
+        layout = readCsvHeader(text);
+        start = layout.dataStart;
+    }
+
+    auto ranges = splitChunks(text, start, std::max<size_t>(chunkSize, 1), json);
+    std::vector<ChunkResult> chunks(ranges.size());
+
+    auto parseChunk = [&](size_t i) {
+        if (json) {
+            parseJsonChunk(text, ranges[i].first, ranges[i].second, chunks[i]);
+        } else {
+            parseCsvChunk(text.substr(ranges[i].first, ranges[i].second - ranges[i].first), layout, chunks[i]);
+        }
+    };
+
+    if (pool && ranges.size() > 1) {
+        std::vector<std::future<void>> tasks;
+        tasks.reserve(ranges.size());
+        for (size_t i = 0; i < ranges.size(); i++) {
+            tasks.push_back(pool->async([&parseChunk, i]() { parseChunk(i); }));
+        }
+        for (auto& task : tasks) task.get();
+    } else {
+        for (size_t i = 0; i < ranges.size(); i++) parseChunk(i);
+    }
+
+    return merge(text, chunks, report);
+}
@@ -0,0 +1,60 @@
+#ifndef MANIFESTIMPORTER_H
+#define MANIFESTIMPORTER_H
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "../packing/Cargo.h"
+#include "../packing/ThreadPool.h"
+
+// Предел числа физических коробок: и в одной строке, и во всем манифесте.
+// Строка с большим количеством отбрасывается, манифест сверх предела не загружается.
+constexpr long long MAX_MANIFEST_BOXES = 10000000;
+
+// Пределы размеров (см) и массы (кг) одной коробки: строка сверх них отбрасывается
+// до округления, так что размеры всегда помещаются в int, а объемы - в 64 бита
+constexpr double MAX_BOX_DIMENSION = 100000.0;
+constexpr double MAX_BOX_WEIGHT = 1000000.0;
+
+struct ImportReport {
+    size_t rows = 0;            // Строк (объектов) с данными
+    size_t skipped = 0;         // Из них отброшено с ошибкой
+    size_t types = 0;           // Уникальных типов коробок после слияния
+    size_t boxes = 0;           // Физических коробок
+    std::string firstError;     // С номером строки: "line 12: ..."
+};
+
+// Импорт манифеста из выгрузки WMS.
+//
+// CSV: первая строка - заголовок, разделитель ',' или ';'. Колонки по имени:
+// sku, width, height, depth (см), необязательные weight (кг), quantity (qty, count),
+// stop, fragile (fragility), shape (form). Хрупкая коробка не несет нагрузку сверху.
+// shape: box (по умолчанию) или cylinder / roll / drum / tyre / barrel; у цилиндра
+// height - длина вдоль оси, а диаметр - большее из width и depth.
+// class (hazard, compatibility): класс совместимости 0..63 для SegregationRules (см. SegregationPresets.h),
+// 0 - обычный груз.
+// JSON: массив плоских объектов с теми же ключами, либо {"items": [...]}.
+//
+// Файл отображается в память и разбирается без копирования строк: текст делится
+// на куски по границам записей, куски разбираются параллельно на пуле, а одинаковые
+// коробки (SKU, размеры, масса, хрупкость, форма, класс) сворачиваются в один тип с количеством.
+class ManifestImporter {
+private:
+    ThreadPool* pool;
+    size_t chunkSize = 1u << 20;
+
+public:
+    // pool == nullptr - разбор в вызывающем потоке
+    explicit ManifestImporter(ThreadPool* pool = nullptr);
+
+    // Бросает std::runtime_error, если файл не открывается, формат не распознан
+    // или коробок больше MAX_MANIFEST_BOXES
+    Manifest load(const std::string& path, ImportReport* report = nullptr) const;
+    Manifest parse(std::string_view text, bool json, ImportReport* report = nullptr) const;
+
+    void setChunkSize(size_t bytes) { chunkSize = bytes; }
+};
+
+#endif //MANIFESTIMPORTER_H
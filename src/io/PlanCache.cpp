@@ -0,0 +1,421 @@
+#include "PlanCache.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <numeric>
+#include "LoadPlanFile.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr uint64_t FNV_OFFSET = 0xCBF29CE484222325ULL;
+constexpr uint64_t FNV_PRIME = 0x100000001B3ULL;
+
+void hashBytes(uint64_t& hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+}
+
+template <typename T>
+void hashValue(uint64_t& hash, const T& value) {
+    hashBytes(hash, &value, sizeof(value));
+}
+
+// Полный порядок на типах: одинаковые по всем полям типы взаимозаменяемы
+int compareTypes(const BoxType& a, const BoxType& b) {
+    if (int order = a.sku.compare(b.sku)) return order;
+    if (a.width != b.width) return a.width < b.width ? -1 : 1;
+    if (a.height != b.height) return a.height < b.height ? -1 : 1;
+    if (a.depth != b.depth) return a.depth < b.depth ? -1 : 1;
+    if (a.weight != b.weight) return a.weight < b.weight ? -1 : 1;
+    if (a.orientations != b.orientations) return a.orientations < b.orientations ? -1 : 1;
+    if (a.maxStackLoad != b.maxStackLoad) return a.maxStackLoad < b.maxStackLoad ? -1 : 1;
+    if (a.minSupport != b.minSupport) return a.minSupport < b.minSupport ? -1 : 1;
+    if (a.shape != b.shape) return a.shape < b.shape ? -1 : 1;
+    if (a.compatibilityClass != b.compatibilityClass) return a.compatibilityClass < b.compatibilityClass ? -1 : 1;
+    return 0;
+}
+
+// Файлы кэша: <хэш параметров>_<хэш задачи>.tlp
+bool parseEntryName(const std::string& name, uint64_t& optionsHash, uint64_t& hash) {
+    unsigned long long options = 0, problem = 0;
+    char tail[8] = {};
+    if (name.size() != 37 || std::sscanf(name.c_str(), "%16llx_%16llx%4s", &options, &problem, tail) != 3) {
+        return false;
+    }
+    if (std::strcmp(tail, ".tlp") != 0) return false;
+    optionsHash = options;
+    hash = problem;
+    return true;
+}
+
+} // namespace
+
+PlanCache::PlanCache(size_t capacity, const std::string& directory, ThreadPool* pool)
+    : capacity(std::max<size_t>(1, capacity)), directory(directory), pool(pool) {
+    if (!directory.empty()) loadDirectory();
+}
+
+uint64_t PlanCache::hashOptions(const PackerOptions& options) {
+    uint64_t hash = FNV_OFFSET;
+    hashValue(hash, options.minSupportRatio);
+    hashValue(hash, options.doorAtMaxX);
+    hashValue(hash, options.axles.enabled);
+    if (options.axles.enabled) {
+        hashValue(hash, options.axles.frontPosition);
+        hashValue(hash, options.axles.rearPosition);
+        hashValue(hash, options.axles.frontLimit);
+        hashValue(hash, options.axles.rearLimit);
+    }
+    if (options.interior) {
+        hashValue(hash, options.interior->hash());
+    }
+    if (options.segregation) {
+        hashValue(hash, options.segregation->hash());
+    }
+    return hash;
+}
+
+int PlanCache::compareGroups(const Group& a, const Group& b) {
+    if (int order = compareTypes(*a.type, *b.type)) return order;
+    if (a.stop != b.stop) return a.stop < b.stop ? -1 : 1;
+    return 0;
+}
+
+bool PlanCache::sameGroups(const std::vector<Group>& a, const std::vector<Group>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t g = 0; g < a.size(); g++) {
+        if (a[g].count != b[g].count || compareGroups(a[g], b[g]) != 0) return false;
+    }
+    return true;
+}
+
+PlanCache::Canonical PlanCache::canonicalise(const Manifest& manifest, const TrailerSpec& trailer,
+                                             uint64_t optionsHash) {
+    Canonical result;
+    const std::vector<BoxType>& types = manifest.types;
+
+    // Сначала ранги типов (строки сравниваются только здесь), затем коробки по целым ключам
+    std::vector<uint32_t> typeOrder(types.size());
+    std::iota(typeOrder.begin(), typeOrder.end(), 0u);
+    std::sort(typeOrder.begin(), typeOrder.end(), [&types](uint32_t a, uint32_t b) {
+        return compareTypes(types[a], types[b]) < 0;
+    });
+    std::vector<uint32_t> rank(types.size());
+    for (size_t r = 0; r < typeOrder.size(); r++) {
+        bool sameAsPrevious = r > 0 && compareTypes(types[typeOrder[r - 1]], types[typeOrder[r]]) == 0;
+        rank[typeOrder[r]] = sameAsPrevious ? rank[typeOrder[r - 1]] : static_cast<uint32_t>(r);
+    }
+
+    result.order.resize(manifest.items.size());
+    std::iota(result.order.begin(), result.order.end(), 0u);
+    std::sort(result.order.begin(), result.order.end(), [&manifest, &rank](uint32_t a, uint32_t b) {
+        uint32_t rankA = rank[manifest.items[a]];
+        uint32_t rankB = rank[manifest.items[b]];
+        if (rankA != rankB) return rankA < rankB;
+        if (manifest.stopOf(a) != manifest.stopOf(b)) return manifest.stopOf(a) < manifest.stopOf(b);
+        return a < b;
+    });
+
+    for (uint32_t item : result.order) {
+        uint32_t type = manifest.items[item];
+        uint16_t stop = manifest.stopOf(item);
+        if (!result.groups.empty()) {
+            Group& last = result.groups.back();
+            if (last.stop == stop && rank[static_cast<size_t>(last.type - types.data())] == rank[type]) {
+                last.count++;
+                continue;
+            }
+        }
+        result.groups.push_back(Group{&types[type], stop, 1});
+    }
+
+    uint64_t hash = FNV_OFFSET;
+    hashValue(hash, trailer.width);
+    hashValue(hash, trailer.height);
+    hashValue(hash, trailer.depth);
+    hashValue(hash, optionsHash);
+    for (const Group& group : result.groups) {
+        const BoxType& type = *group.type;
+        hashBytes(hash, type.sku.data(), type.sku.size());
+        hashValue(hash, type.width);
+        hashValue(hash, type.height);
+        hashValue(hash, type.depth);
+        hashValue(hash, type.weight);
+        hashValue(hash, type.orientations);
+        hashValue(hash, type.maxStackLoad);
+        hashValue(hash, type.minSupport);
+        // Форма входит в хэш только у цилиндров: ключи коробок не меняются
+        if (type.isCylinder()) hashValue(hash, type.shape);
+        if (type.compatibilityClass != 0) hashValue(hash, type.compatibilityClass);
+        hashValue(hash, group.stop);
+        hashValue(hash, group.count);
+    }
+    result.hash = hash;
+    return result;
+}
+
+PlanCache::Entry PlanCache::makeEntry(const Manifest& manifest, const LoadPlan& plan, uint64_t optionsHash) {
+    Canonical key = canonicalise(manifest, plan.trailer, optionsHash);
+
+    Entry entry;
+    entry.hash = key.hash;
+    entry.optionsHash = optionsHash;
+    entry.items = key.order.size();
+
+    // Группы одного типа идут подряд: тип копируется один раз на все точки разгрузки
+    std::vector<uint32_t> typeOf(key.groups.size());
+    for (size_t g = 0; g < key.groups.size(); g++) {
+        if (entry.types.empty() || compareTypes(entry.types.back(), *key.groups[g].type) != 0) {
+            entry.types.push_back(*key.groups[g].type);
+        }
+        typeOf[g] = static_cast<uint32_t>(entry.types.size() - 1);
+    }
+    // Группы должны указывать на типы внутри записи, а не в манифест вызывающего
+    entry.groups = key.groups;
+    for (size_t g = 0; g < entry.groups.size(); g++) entry.groups[g].type = &entry.types[typeOf[g]];
+
+    std::vector<uint32_t> canonicalIndex(key.order.size());
+    for (size_t i = 0; i < key.order.size(); i++) canonicalIndex[key.order[i]] = static_cast<uint32_t>(i);
+
+    entry.plan = plan;
+    for (auto& placement : entry.plan.placements) placement.item = canonicalIndex[placement.item];
+    for (auto& item : entry.plan.unplaced) item = canonicalIndex[item];
+    entry.volume = plan.loadedVolume();
+    return entry;
+}
+
+Manifest PlanCache::expand(const Entry& entry) {
+    Manifest manifest;
+    manifest.types = entry.types;
+    manifest.items.reserve(entry.items);
+    manifest.itemStops.reserve(entry.items);
+    for (const Group& group : entry.groups) {
+        manifest.addItems(static_cast<uint32_t>(group.type - entry.types.data()), static_cast<int>(group.count), group.stop);
+    }
+    return manifest;
+}
+
+void PlanCache::remap(const Entry& entry, const Canonical& key, LoadPlan& plan) {
+    // Каждой группе записи - совпадающая группа запроса (обе последовательности отсортированы)
+    std::vector<int> target(entry.groups.size(), -1);
+    std::vector<uint32_t> entryGroupOf;
+    entryGroupOf.reserve(entry.items);
+    size_t h = 0;
+    for (size_t g = 0; g < entry.groups.size(); g++) {
+        entryGroupOf.insert(entryGroupOf.end(), entry.groups[g].count, static_cast<uint32_t>(g));
+        while (h < key.groups.size() && compareGroups(key.groups[h], entry.groups[g]) < 0) h++;
+        if (h < key.groups.size() && compareGroups(key.groups[h], entry.groups[g]) == 0) target[g] = static_cast<int>(h);
+    }
+
+    std::vector<uint32_t> offset(key.groups.size() + 1, 0);
+    for (size_t g = 0; g < key.groups.size(); g++) offset[g + 1] = offset[g] + key.groups[g].count;
+    std::vector<uint32_t> used(key.groups.size(), 0);
+
+    plan.trailer = entry.plan.trailer;
+    plan.placements.clear();
+    plan.unplaced.clear();
+    plan.placements.reserve(entry.plan.placements.size());
+
+    bool skipped = false;
+    for (const auto& placement : entry.plan.placements) {
+        int group = target[entryGroupOf[placement.item]];
+        if (group < 0 || used[group] == key.groups[group].count) {
+            skipped = true;
+            continue;
+        }
+
+        Placement mapped = placement;
+        mapped.item = key.order[offset[group] + used[group]++];
+        // Блок цилиндров, у которого пропущено начало, начинается с первого оставшегося слота
+        if (skipped && mapped.rollBlock == ROLL_BLOCK_NEXT) mapped.rollBlock = ROLL_BLOCK_FIRST;
+        skipped = false;
+        plan.placements.push_back(mapped);
+    }
+
+    for (size_t g = 0; g < key.groups.size(); g++) {
+        for (uint32_t i = offset[g] + used[g]; i < offset[g + 1]; i++) {
+            plan.unplaced.push_back(key.order[i]);
+        }
+    }
+}
+
+PlanCache::Match PlanCache::find(const Manifest& manifest, const TrailerSpec& trailer, const PackerOptions& options,
+                                 LoadPlan& plan) {
+    uint64_t optionsHash = hashOptions(options);
+    Canonical key = canonicalise(manifest, trailer, optionsHash);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = index.find(key.hash);
+    if (found != index.end() && found->second->plan.trailer == trailer && sameGroups(found->second->groups, key.groups)) {
+        entries.splice(entries.begin(), entries, found->second);
+        remap(*found->second, key, plan);
+        exactHits++;
+        return Match::Exact;
+    }
+
+    // Похожая задача: тот же прицеп и параметры, наибольший общий объем
+    long long total = 0;
+    for (const Group& group : key.groups) total += group.type->volume() * group.count;
+
+    const Entry* best = nullptr;
+    long long bestShared = 0;
+    for (const Entry& entry : entries) {
+        if (entry.optionsHash != optionsHash || entry.plan.trailer != trailer) continue;
+
+        long long shared = 0;
+        size_t h = 0;
+        for (const Group& group : entry.groups) {
+            while (h < key.groups.size() && compareGroups(key.groups[h], group) < 0) h++;
+            if (h < key.groups.size() && compareGroups(key.groups[h], group) == 0) {
+                shared += group.type->volume() * std::min(group.count, key.groups[h].count);
+            }
+        }
+        if (shared > bestShared) {
+            bestShared = shared;
+            best = &entry;
+        }
+    }
+
+    if (!best || static_cast<double>(bestShared) < SIMILARITY_THRESHOLD * static_cast<double>(total)) {
+        misses++;
+        return Match::None;
+    }
+
+    remap(*best, key, plan);
+    similarHits++;
+    return Match::Similar;
+}
+
+void PlanCache::store(const Manifest& manifest, const LoadPlan& plan, const PackerOptions& options) {
+    if (manifest.empty()) return;
+    Entry entry = makeEntry(manifest, plan, hashOptions(options));
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = index.find(entry.hash);
+        if (found != index.end() && found->second->plan.trailer == plan.trailer &&
+            sameGroups(found->second->groups, entry.groups) && found->second->volume > entry.volume) {
+            entries.splice(entries.begin(), entries, found->second);
+            return;
+        }
+    }
+
+    if (!directory.empty()) {
+        // Снимок собирается здесь, задача записи работает только с ним
+        auto snapshot = std::make_shared<ProjectSnapshot>();
+        snapshot->manifest = expand(entry);
+        snapshot->plan = entry.plan;
+        std::string path = entryPath(entry.optionsHash, entry.hash);
+        uint64_t version;
+        {
+            std::lock_guard<std::mutex> lock(writes->mutex);
+            version = ++writes->next;
+            writes->latest[path] = version;
+        }
+        auto write = [snapshot, path, version, writes = writes]() {
+            std::lock_guard<std::mutex> lock(writes->mutex);
+            auto latest = writes->latest.find(path);
+            if (latest == writes->latest.end() || latest->second != version) return;
+            writes->latest.erase(latest);
+            try {
+                LoadPlanFile::save(*snapshot, path);
+            } catch (const std::exception&) {
+                // Кэш на диске - только ускорение: без него план просто останется в памяти
+            }
+        };
+        if (pool) {
+            pool->submit(std::move(write));
+        } else {
+            write();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    insert(std::move(entry));
+}
+
+void PlanCache::insert(Entry&& entry) {
+    auto found = index.find(entry.hash);
+    if (found != index.end()) {
+        entries.erase(found->second);
+        index.erase(found);
+    }
+
+    entries.push_front(std::move(entry));
+    index[entries.front().hash] = entries.begin();
+    if (entries.size() > capacity) {
+        index.erase(entries.back().hash);
+        entries.pop_back();
+    }
+}
+
+std::string PlanCache::entryPath(uint64_t optionsHash, uint64_t hash) const {
+    char name[64];
+    std::snprintf(name, sizeof(name), "%016" PRIx64 "_%016" PRIx64 ".tlp", optionsHash, hash);
+    return (fs::path(directory) / name).string();
+}
+
+void PlanCache::loadDirectory() {
+    std::error_code error;
+    fs::create_directories(directory, error);
+
+    struct CachedFile {
+        fs::path path;
+        fs::file_time_type time;
+        uint64_t optionsHash;
+        uint64_t hash;
+    };
+    std::vector<CachedFile> files;
+    for (const auto& file : fs::directory_iterator(directory, error)) {
+        CachedFile cached;
+        if (!file.is_regular_file(error)) continue;
+        if (!parseEntryName(file.path().filename().string(), cached.optionsHash, cached.hash)) continue;
+        cached.path = file.path();
+        cached.time = file.last_write_time(error);
+        files.push_back(cached);
+    }
+
+    // Свежие файлы - в память, совсем старые удаляются, чтобы каталог не рос без конца
+    std::sort(files.begin(), files.end(), [](const CachedFile& a, const CachedFile& b) { return a.time > b.time; });
+    for (size_t i = 4 * capacity; i < files.size(); i++) {
+        fs::remove(files[i].path, error);
+    }
+    files.resize(std::min(files.size(), capacity));
+
+    // С конца, чтобы самый свежий оказался в начале LRU
+    for (auto file = files.rbegin(); file != files.rend(); ++file) {
+        try {
+            LoadPlanFile planFile(file->path.string());
+            Entry entry = makeEntry(planFile.toManifest(), planFile.toLoadPlan(), file->optionsHash);
+            if (entry.hash != file->hash) continue;
+            insert(std::move(entry));
+        } catch (const std::exception&) {
+            fs::remove(file->path, error);
+        }
+    }
+}
+
+LoadPlan PlanCache::solve(const Manifest& manifest, const TrailerSpec& trailer, const PackerOptions& options,
+                          Match* match) {
+    LoadPlan plan;
+    Match result = find(manifest, trailer, options, plan);
+    if (match) *match = result;
+    if (result == Match::Exact) return plan;
+
+    Packer packer(manifest, options);
+    plan = result == Match::Similar ? packer.repack(plan, trailer) : packer.pack(trailer);
+    store(manifest, plan, options);
+    return plan;
+}
+
+size_t PlanCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
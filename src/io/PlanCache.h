@@ -0,0 +1,122 @@
+#ifndef PLANCACHE_H
+#define PLANCACHE_H
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../packing/Cargo.h"
+#include "../packing/LoadPlan.h"
+#include "../packing/Packer.h"
+#include "../packing/ThreadPool.h"
+
+// Кэш решенных планов по канонической форме задачи.
+//
+// Каноническая форма - прицеп, параметры упаковщика и отсортированный список
+// групп "тип коробки + точка разгрузки -> количество". Она не зависит от порядка
+// строк манифеста и номеров типов, поэтому тот же заказ, открытый заново, дает
+// тот же хэш. Планы хранятся в канонической нумерации коробок и при выдаче
+// переводятся в нумерацию запрошенного манифеста.
+//
+// Память - LRU на capacity задач. Запись хранит только различные типы и группы
+// задачи, а не копию манифеста. Каталог (если задан) хранит те же планы в .tlp
+// и при создании кэша подгружает последние из них; запись файлов идет на пуле.
+class PlanCache {
+private:
+    struct Group {
+        const BoxType* type;            // Указывает в Entry::types или в манифест запроса
+        uint16_t stop;
+        uint32_t count;
+    };
+
+    // Задача в канонической форме: order[i] - коробка манифеста с каноническим номером i
+    struct Canonical {
+        uint64_t hash = 0;
+        std::vector<Group> groups;
+        std::vector<uint32_t> order;
+    };
+
+    struct Entry {
+        uint64_t hash = 0;
+        uint64_t optionsHash = 0;
+        std::vector<BoxType> types;     // Различные типы задачи по возрастанию
+        std::vector<Group> groups;      // Коробки в канонической нумерации идут по группам подряд
+        LoadPlan plan;
+        size_t items = 0;
+        long long volume = 0;
+    };
+
+    // Общее с задачами записи и живет, пока они не закончатся: задачи пула могут
+    // выполниться в любом порядке, устаревший снимок файла не пишется
+    struct Writes {
+        std::mutex mutex;
+        uint64_t next = 0;
+        std::unordered_map<std::string, uint64_t> latest;   // Путь -> номер последнего снимка
+    };
+
+    size_t capacity;
+    std::string directory;
+    ThreadPool* pool;
+    std::shared_ptr<Writes> writes = std::make_shared<Writes>();
+
+    mutable std::mutex mutex;
+    std::list<Entry> entries;           // От свежих к старым
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+
+    std::atomic<size_t> exactHits{0};
+    std::atomic<size_t> similarHits{0};
+    std::atomic<size_t> misses{0};
+
+    static Canonical canonicalise(const Manifest& manifest, const TrailerSpec& trailer, uint64_t optionsHash);
+    static int compareGroups(const Group& a, const Group& b);
+    static bool sameGroups(const std::vector<Group>& a, const std::vector<Group>& b);
+    static Entry makeEntry(const Manifest& manifest, const LoadPlan& plan, uint64_t optionsHash);
+    static void remap(const Entry& entry, const Canonical& key, LoadPlan& plan);
+    static Manifest expand(const Entry& entry);
+
+    void insert(Entry&& entry);
+    std::string entryPath(uint64_t optionsHash, uint64_t hash) const;
+    void loadDirectory();
+
+public:
+    enum class Match {
+        None,
+        Exact,      // План готов
+        Similar     // План частично подходит: передать в Packer::repack как предыдущий
+    };
+
+    // Задачи, у которых общая часть меньше этой доли объема, не считаются похожими
+    static constexpr double SIMILARITY_THRESHOLD = 0.5;
+
+    // pool == nullptr - файлы пишутся в вызывающем потоке
+    explicit PlanCache(size_t capacity = 64, const std::string& directory = std::string(),
+                       ThreadPool* pool = nullptr);
+
+    static uint64_t hashOptions(const PackerOptions& options);
+
+    // plan переводится в нумерацию manifest. Для Similar в plan.placements остаются
+    // только коробки, которые есть в обоих манифестах, остальные - в plan.unplaced.
+    Match find(const Manifest& manifest, const TrailerSpec& trailer, const PackerOptions& options, LoadPlan& plan);
+
+    // Запоминает план; существующий план той же задачи заменяется, если новый не хуже.
+    // Файл пишется задачей пула из снимка записи; ошибки записи игнорируются.
+    void store(const Manifest& manifest, const LoadPlan& plan, const PackerOptions& options);
+
+    // find + упаковка: Exact - без упаковки, Similar - repack от найденного плана.
+    // Новый план сразу сохраняется в кэш.
+    LoadPlan solve(const Manifest& manifest, const TrailerSpec& trailer, const PackerOptions& options,
+                   Match* match = nullptr);
+
+    size_t size() const;
+    size_t getExactHits() const { return exactHits; }
+    size_t getSimilarHits() const { return similarHits; }
+    size_t getMisses() const { return misses; }
+};
+
+#endif //PLANCACHE_H
@@ -0,0 +1,72 @@
+#include "SegregationPresets.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include "MappedFile.h"
+
+namespace {
+
+bool parseLevel(const char* name, SegregationLevel& level) {
+    static const std::pair<const char*, SegregationLevel> LEVELS[] = {
+        {"none", SegregationLevel::None}, {"contact", SegregationLevel::NoContact},
+        {"away", SegregationLevel::Away}, {"separated", SegregationLevel::Separated}
+    };
+    for (const auto& [text, value] : LEVELS) {
+        if (std::strcmp(name, text) == 0) {
+            level = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+std::shared_ptr<const SegregationRules> defaultSegregationRules() {
+    auto rules = std::make_shared<SegregationRules>();
+    rules->require(1, 2, SegregationLevel::Separated);
+    rules->require(1, 3, SegregationLevel::Separated);
+    rules->require(2, 3, SegregationLevel::Away);
+    for (uint8_t hazard = 1; hazard <= 3; hazard++) rules->require(hazard, 4, SegregationLevel::NoContact);
+    return rules;
+}
+
+std::shared_ptr<const SegregationRules> readSegregationRules(const std::string& path) {
+    MappedFile file(path);
+    std::string_view text = file.view();
+
+    auto rules = std::make_shared<SegregationRules>();
+    size_t pos = 0;
+    bool header = true;
+    while (pos < text.size()) {
+        size_t end = text.find('\n', pos);
+        if (end == std::string_view::npos) end = text.size();
+        std::string line(text.substr(pos, end - pos));
+        pos = end + 1;
+
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        if (header) {
+            header = false;
+            if (line.compare(0, 5, "class") == 0) continue;
+        }
+
+        std::replace(line.begin(), line.end(), ';', ',');
+        char levelName[32];
+        int centimeters;
+        int a, b;
+        SegregationLevel level;
+        if (std::sscanf(line.c_str(), "distance,%31[^,],%d", levelName, &centimeters) == 2 &&
+            parseLevel(levelName, level) && level != SegregationLevel::None && centimeters > 0) {
+            rules->setDistance(level, centimeters);
+        } else if (std::sscanf(line.c_str(), "%d,%d,%31[^,]", &a, &b, levelName) == 3 && parseLevel(levelName, level) &&
+                   a > 0 && b > 0 && a < static_cast<int>(COMPATIBILITY_CLASS_COUNT) &&
+                   b < static_cast<int>(COMPATIBILITY_CLASS_COUNT)) {
+            rules->require(static_cast<uint8_t>(a), static_cast<uint8_t>(b), level);
+        } else {
+            throw std::runtime_error("Invalid segregation line: " + line);
+        }
+    }
+    return rules;
+}
@@ -0,0 +1,20 @@
+#ifndef SEGREGATIONPRESETS_H
+#define SEGREGATIONPRESETS_H
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "../packing/Segregation.h"
+
+// Правила по умолчанию для колонки class манифеста - единственный источник для UI и утилит:
+// 1 - взрывчатые, 2 - легковоспламеняющиеся, 3 - окислители, 4 - продукты питания.
+// Остальные классы без ограничений, пока их не задаст файл правил
+std::shared_ptr<const SegregationRules> defaultSegregationRules();
+
+// segregation.csv: class_a,class_b,level, где level - none, contact, away или separated;
+// строка distance,level,см меняет зазор уровня. Разделитель ',' или ';', заголовок необязателен.
+// Бросает std::runtime_error при ошибке в строке.
+std::shared_ptr<const SegregationRules> readSegregationRules(const std::string& path);
+
+#endif //SEGREGATIONPRESETS_H
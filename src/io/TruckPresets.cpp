@@ -0,0 +1,52 @@
+#include "TruckPresets.h"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include "MappedFile.h"
+
+std::vector<TruckPreset> defaultTruckPresets() {
+    return {
+        {"small", {1203, 239, 235}, "Малый грузовик"},
+        {"medium", {1340, 239, 235}, "Средний грузовик"},
+        {"large", {1360, 260, 245}, "Большой грузовик"},
+        {"large_high", {1360, 300, 245}, "Увеличенный грузовик"},
+        {"max", {1650, 260, 245}, "Максимальный грузовик"},
+        {"compact", {590, 239, 235}, "Компактный грузовик"}
+    };
+}
+
+std::vector<TruckPreset> readTruckPresets(const std::string& path) {
+    MappedFile file(path);
+    std::string_view text = file.view();
+
+    std::vector<TruckPreset> trucks;
+    size_t pos = 0;
+    bool header = true;
+    while (pos < text.size()) {
+        size_t end = text.find('\n', pos);
+        if (end == std::string_view::npos) end = text.size();
+        std::string line(text.substr(pos, end - pos));
+        pos = end + 1;
+
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        if (header) {
+            header = false;
+            if (line.compare(0, 4, "name") == 0) continue;
+        }
+
+        std::replace(line.begin(), line.end(), ';', ',');
+        char name[128];
+        TruckPreset truck;
+        if (std::sscanf(line.c_str(), "%127[^,],%d,%d,%d", name, &truck.trailer.width,
+                        &truck.trailer.height, &truck.trailer.depth) != 4 || truck.trailer.volume() <= 0) {
+            throw std::runtime_error("Invalid truck line: " + line);
+        }
+        truck.name = name;
+        truck.label = name;
+        trucks.push_back(truck);
+    }
+
+    if (trucks.empty()) throw std::runtime_error("No trucks in " + path);
+    return trucks;
+}
@@ -0,0 +1,23 @@
+#ifndef TRUCKPRESETS_H
+#define TRUCKPRESETS_H
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "../packing/Cargo.h"
+
+struct TruckPreset {
+    std::string name;
+    TrailerSpec trailer;
+    std::string label;          // Название для меню; в файлах совпадает с name
+};
+
+// Пресеты меню "Грузовик" - единственный источник размеров для UI и утилит
+std::vector<TruckPreset> defaultTruckPresets();
+
+// trucks.csv: name,width,height,depth (см), разделитель ',' или ';', заголовок необязателен.
+// Бросает std::runtime_error при ошибке в строке или пустом списке.
+std::vector<TruckPreset> readTruckPresets(const std::string& path);
+
+#endif //TRUCKPRESETS_H
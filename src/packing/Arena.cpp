@@ -0,0 +1,33 @@
+#include "Arena.h"
+#include <algorithm>
+
+Arena::Arena(size_t blockSize) : blockSize(std::max<size_t>(blockSize, 256)) {
+}
+
+void* Arena::allocateSlow(size_t bytes) {
+    // Начало блока выровнено по max_align_t, поэтому в новом блоке смещение 0 подходит
+    size_t next = blocks.empty() ? 0 : current + 1;
+    if (next < blocks.size() && blocks[next].size < bytes) {
+        // Сохраненный блок мал: новый вставляется перед ним, отметки до current не сдвигаются
+        blocks.insert(blocks.begin() + static_cast<std::ptrdiff_t>(next), Block());
+    } else if (next == blocks.size()) {
+        blocks.push_back(Block());
+    }
+
+    Block& block = blocks[next];
+    if (!block.data) {
+        // Блоки растут, чтобы число выделений из кучи было логарифмическим
+        block.size = std::max(bytes, std::max(blockSize, capacity() / 2));
+        block.data.reset(new unsigned char[block.size]);
+    }
+
+    current = next;
+    offset = bytes;
+    return block.data.get();
+}
+
+size_t Arena::capacity() const {
+    size_t total = 0;
+    for (const auto& block : blocks) total += block.size;
+    return total;
+}
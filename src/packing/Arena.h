@@ -0,0 +1,100 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Линейный (bump) распределитель для рабочих данных поиска. Память берется
+// блоками и не возвращается в кучу до разрушения арены: mark/rollback
+// откатывают указатель к сохраненной отметке, reset - к началу. Объекты не
+// разрушаются, поэтому в арене живут только тривиально копируемые типы.
+// Арена не потокобезопасна - у каждого исполнителя своя.
+class Arena {
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;
+        size_t size = 0;
+    };
+
+    std::vector<Block> blocks;
+    size_t current = 0;                 // Блок, из которого идет выделение
+    size_t offset = 0;                  // Занято в текущем блоке
+    size_t blockSize;
+
+    void* allocateSlow(size_t bytes);
+
+public:
+    struct Mark {
+        size_t block;
+        size_t offset;
+    };
+
+    explicit Arena(size_t blockSize = 64 * 1024);
+
+    Arena(Arena&&) = default;
+    Arena& operator=(Arena&&) = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment) {
+        if (current < blocks.size()) {
+            size_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+            if (aligned + bytes <= blocks[current].size) {
+                offset = aligned + bytes;
+                return blocks[current].data.get() + aligned;
+            }
+        }
+        return allocateSlow(bytes);
+    }
+
+    // Неинициализированный массив из count элементов
+    template <typename T>
+    T* allocate(size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+                      "arena holds trivially copyable types only");
+        static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned types are not supported");
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // Копия count элементов одним memcpy
+    template <typename T>
+    T* copy(const T* source, size_t count) {
+        T* result = allocate<T>(count);
+        if (count > 0) std::memcpy(result, source, sizeof(T) * count);
+        return result;
+    }
+
+    Mark mark() const { return {current, offset}; }
+    void rollback(const Mark& mark) {
+        current = mark.block;
+        offset = mark.offset;
+    }
+    // Освобождает все выделенное, оставляя блоки для повторного использования
+    void reset() {
+        current = 0;
+        offset = 0;
+    }
+
+    size_t capacity() const;
+};
+
+// Откатывает арену при выходе из области видимости
+class ArenaScope {
+private:
+    Arena& arena;
+    Arena::Mark saved;
+
+public:
+    explicit ArenaScope(Arena& arena) : arena(arena), saved(arena.mark()) {}
+    ~ArenaScope() { arena.rollback(saved); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+};
+
+#endif //ARENA_H
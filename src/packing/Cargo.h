@@ -0,0 +1,127 @@
+#ifndef CARGO_H
+#define CARGO_H
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Все размеры в сантиметрах. Оси совпадают с TruckSettings:
+// width - длина прицепа (x), height - высота (y), depth - ширина кузова (z).
+struct TrailerSpec {
+    int width = 0;
+    int height = 0;
+    int depth = 0;
+
+    long long volume() const { return static_cast<long long>(width) * height * depth; }
+
+    bool operator==(const TrailerSpec& other) const {
+        return width == other.width && height == other.height && depth == other.depth;
+    }
+    bool operator!=(const TrailerSpec& other) const { return !(*this == other); }
+};
+
+// Orientation index: which of the box's own dimensions goes along x, y, z
+enum Orientation : uint8_t {
+    ORIENT_WHD = 0,
+    ORIENT_DHW = 1,
+    ORIENT_WDH = 2,
+    ORIENT_HDW = 3,
+    ORIENT_DWH = 4,
+    ORIENT_HWD = 5,
+    ORIENTATION_COUNT = 6
+};
+
+constexpr uint8_t ORIENT_ALL = 0x3F;
+
+// Перестановки осей: какое из собственных измерений коробки
+// (0 - width, 1 - height, 2 - depth) идет вдоль x, y и z
+constexpr uint8_t ORIENTATION_AXES[ORIENTATION_COUNT][3] = {
+    {0, 1, 2},   // WHD
+    {2, 1, 0},   // DHW
+    {0, 2, 1},   // WDH
+    {1, 2, 0},   // HDW
+    {2, 0, 1},   // DWH
+    {1, 0, 2},   // HWD
+};
+
+// Форма груза. Цилиндр (бочка, шина, рулон): width == depth - диаметр,
+// height - длина вдоль собственной оси; повороты те же, что у коробки
+enum class CargoShape : uint8_t {
+    Box = 0,
+    Cylinder = 1
+};
+
+// Тип коробки (SKU)
+struct BoxType {
+    std::string sku;
+    int width = 0;
+    int height = 0;
+    int depth = 0;
+    float weight = 0.0f;
+    CargoShape shape = CargoShape::Box;
+
+    // Bit i set -> Orientation i is allowed
+    uint8_t orientations = ORIENT_ALL;
+
+    // Ограничения штабелирования (< 0 - используется значение по умолчанию / без ограничения)
+    float maxStackLoad = -1.0f;     // Сколько кг можно поставить сверху
+    float minSupport = -1.0f;       // Минимальная доля основания на опоре
+
+    // Класс совместимости (см. SegregationRules); 0 - обычный груз
+    uint8_t compatibilityClass = 0;
+
+    long long volume() const { return static_cast<long long>(width) * height * depth; }
+
+    bool allows(uint8_t orientation) const { return (orientations >> orientation) & 1u; }
+
+    bool isCylinder() const { return shape == CargoShape::Cylinder; }
+    // Ось цилиндра в повороте: 0 - x, 1 - y (стоит на торце), 2 - z
+    static int cylinderAxis(uint8_t orientation) {
+        const uint8_t* axes = ORIENTATION_AXES[orientation < ORIENTATION_COUNT ? orientation : 0];
+        return axes[0] == 1 ? 0 : (axes[1] == 1 ? 1 : 2);
+    }
+
+    void orientedSize(uint8_t orientation, int& x, int& y, int& z) const {
+        const int dims[3] = {width, height, depth};
+        const uint8_t* axes = ORIENTATION_AXES[orientation < ORIENTATION_COUNT ? orientation : 0];
+        x = dims[axes[0]];
+        y = dims[axes[1]];
+        z = dims[axes[2]];
+    }
+};
+
+// Манифест: таблица типов и список физических коробок (индексы в types).
+// itemStops[i] - точка разгрузки коробки i (0 - выгружается первой).
+struct Manifest {
+    std::vector<BoxType> types;
+    std::vector<uint32_t> items;
+    std::vector<uint16_t> itemStops;
+
+    uint32_t addType(const BoxType& type) {
+        types.push_back(type);
+        return static_cast<uint32_t>(types.size() - 1);
+    }
+
+    void addItems(uint32_t type, int quantity, uint16_t stop = 0) {
+        items.insert(items.end(), static_cast<size_t>(quantity), type);
+        itemStops.insert(itemStops.end(), static_cast<size_t>(quantity), stop);
+    }
+
+    const BoxType& typeOf(uint32_t item) const { return types[items[item]]; }
+    uint16_t stopOf(uint32_t item) const { return itemStops[item]; }
+
+    size_t stopCount() const {
+        uint16_t last = 0;
+        for (uint16_t stop : itemStops) {
+            if (stop > last) last = stop;
+        }
+        return static_cast<size_t>(last) + 1;
+    }
+
+    bool empty() const { return items.empty(); }
+    void clear() { types.clear(); items.clear(); itemStops.clear(); }
+};
+
+#endif //CARGO_H
@@ -0,0 +1,318 @@
+#include "ExactSearch.h"
+#include <algorithm>
+#include <memory>
+
+ExactSearch::ExactSearch(const Manifest& manifest, const TrailerSpec& trailer, ThreadPool& pool,
+                         const ExactOptions& options)
+    : manifest(manifest), trailer(trailer), pool(pool), options(options),
+      packer(this->manifest, options.packer) {
+    const auto& interior = options.packer.interior;
+    capacity = interior && interior->getTrailer() == trailer ? interior->usableVolume() : trailer.volume();
+    for (const auto& type : this->manifest.types) hasRolls = hasRolls || rolls::packable(type);
+    buildGroups();
+}
+
+ExactSearch::~ExactSearch() {
+    cancel();
+    wait();
+}
+
+void ExactSearch::buildGroups() {
+    // Группа - тип коробки и точка разгрузки; внутри группы коробки неразличимы
+    std::vector<std::pair<uint64_t, uint32_t>> keyed;
+    keyed.reserve(manifest.items.size());
+    for (uint32_t item = 0; item < manifest.items.size(); item++) {
+        keyed.push_back({(static_cast<uint64_t>(manifest.items[item]) << 16) | manifest.stopOf(item), item});
+    }
+    std::sort(keyed.begin(), keyed.end());
+
+    for (size_t i = 0; i < keyed.size(); i++) {
+        if (i == 0 || keyed[i].first != keyed[i - 1].first) {
+            groups.emplace_back();
+            Group& group = groups.back();
+            const BoxType& type = manifest.typeOf(keyed[i].second);
+            group.volume = type.volume();
+
+            // Повороты с одинаковыми размерами (кубы, квадратное основание) дают
+            // одинаковые поддеревья - оставляем первый из них
+            bool tall = true;
+            long long footprint = -1;
+            for (uint8_t orientation = 0; orientation < ORIENTATION_COUNT; orientation++) {
+                if (!type.allows(orientation)) continue;
+                FreeSpaceIndex::Extent size;
+                type.orientedSize(orientation, size.width, size.height, size.depth);
+
+                if (2 * size.height <= trailer.height) tall = false;
+                long long area = static_cast<long long>(size.width) * size.depth;
+                if (footprint < 0 || area < footprint) footprint = area;
+
+                bool duplicate = false;
+                for (size_t k = 0; k < group.orientationCount; k++) {
+                    const FreeSpaceIndex::Extent& other = group.sizes[k];
+                    duplicate = duplicate || (other.width == size.width && other.height == size.height &&
+                                              other.depth == size.depth);
+                }
+                if (duplicate) continue;
+                group.sizes[group.orientationCount] = size;
+                group.orientations[group.orientationCount++] = orientation;
+            }
+            group.footprint = tall && footprint > 0 ? footprint : 0;
+        }
+        groups.back().items.push_back(keyed[i].second);
+    }
+
+    // Крупные коробки - первыми: хорошие рекорды находятся раньше и режут дерево
+    std::stable_sort(groups.begin(), groups.end(), [](const Group& a, const Group& b) {
+        return a.volume > b.volume;
+    });
+
+    for (size_t g = 0; g < groups.size(); g++) {
+        if (groups[g].footprint > 0) tallOrder.push_back(g);
+    }
+    std::sort(tallOrder.begin(), tallOrder.end(), [this](size_t a, size_t b) {
+        // a.volume / a.footprint > b.volume / b.footprint без деления
+        return static_cast<double>(groups[a].volume) * static_cast<double>(groups[b].footprint) >
+               static_cast<double>(groups[b].volume) * static_cast<double>(groups[a].footprint);
+    });
+}
+
+long long ExactSearch::bound(Node& node) const {
+    long long freeVolume = capacity - node.volume;
+    long long shortVolume = 0;
+
+    for (size_t g = 0; g < groups.size(); g++) {
+        const Group& group = groups[g];
+        size_t remaining = group.items.size() - node.used[g];
+        if (remaining == 0 || node.dropped[g]) continue;
+
+        if (!node.state.getFreeSpace().fitsAnywhere(group.sizes, group.orientationCount)) {
+            node.dropped[g] = 1;
+            continue;
+        }
+        if (group.footprint == 0) shortVolume += group.volume * static_cast<long long>(remaining);
+    }
+
+    // Высокие коробки не стоят друг на друге: их объем ограничен дробным
+    // рюкзаком по свободной площади пола, группы - по убыванию объема на единицу площади
+    double area = static_cast<double>(static_cast<long long>(trailer.width) * trailer.depth - node.tallFootprint);
+    double tallVolume = 0.0;
+    for (size_t g : tallOrder) {
+        if (area <= 0.0) break;
+        const Group& group = groups[g];
+        size_t remaining = group.items.size() - node.used[g];
+        if (remaining == 0 || node.dropped[g]) continue;
+
+        double used = std::min(area, static_cast<double>(group.footprint) * static_cast<double>(remaining));
+        tallVolume += used * static_cast<double>(group.volume) / static_cast<double>(group.footprint);
+        area -= used;
+    }
+
+    long long relaxed = shortVolume + static_cast<long long>(tallVolume);
+    return node.volume + std::min(freeVolume, relaxed);
+}
+
+void ExactSearch::offer(const Node& node) {
+    if (node.volume <= bestVolume.load(std::memory_order_relaxed)) return;
+
+    std::lock_guard<std::mutex> lock(bestMutex);
+    if (node.volume <= bestVolume.load()) return;
+
+    LoadPlan plan;
+    plan.trailer = trailer;
+    plan.placements = node.state.getPlacements();
+
+    std::vector<uint8_t> placed(manifest.items.size(), 0);
+    for (const auto& placement : plan.placements) placed[placement.item] = 1;
+    for (uint32_t item = 0; item < manifest.items.size(); item++) {
+        if (!placed[item]) plan.unplaced.push_back(item);
+    }
+    packer.toSceneFrame(plan);
+
+    bestPlan = std::move(plan);
+    bestVolume = node.volume;
+    bestVersion++;
+}
+
+void ExactSearch::abandon(long long nodeBound) {
+    // Только узлы, которые еще могли улучшить рекорд, влияют на разрыв
+    if (nodeBound <= bestVolume.load()) return;
+    long long current = openBound.load();
+    while (nodeBound > current && !openBound.compare_exchange_weak(current, nodeBound)) {
+    }
+}
+
+bool ExactSearch::shouldStop() {
+    if (cancelled.load()) return true;
+    if (bestVolume.load() >= rootBound) return true;
+    if (std::chrono::steady_clock::now() >= deadline) {
+        timedOut = true;
+        return true;
+    }
+    return false;
+}
+
+void ExactSearch::start() {
+    cancelled = false;
+    timedOut = false;
+    finished = false;
+    openBound = -1;
+    deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.timeBudgetMs);
+
+    auto root = std::make_shared<Node>(Node{packer.createState(trailer), std::vector<uint16_t>(groups.size(), 0),
+                                            std::vector<uint8_t>(groups.size(), 0), 0, 0, 0});
+    rootBound = bound(*root);
+
+    // Жадное решение - первый рекорд
+    {
+        LoadPlan greedy = packer.pack(trailer);
+        std::lock_guard<std::mutex> lock(bestMutex);
+        if (greedy.loadedVolume() > bestVolume.load()) {
+            bestPlan = std::move(greedy);
+            bestVolume = bestPlan.loadedVolume();
+            bestVersion++;
+        }
+    }
+
+    if (!applicable()) {
+        // Дерево слишком велико или в грузе блоки цилиндров: сообщаем только оценку
+        abandon(rootBound);
+        finished = true;
+        return;
+    }
+
+    activeTasks = 1;
+    pool.submit([this, root]() {
+        explore(*root);
+        finishTask();
+    });
+}
+
+void ExactSearch::setWarmStart(const LoadPlan& plan) {
+    if (plan.trailer != trailer || plan.placements.empty()) return;
+
+    std::lock_guard<std::mutex> lock(bestMutex);
+    long long volume = plan.loadedVolume();
+    if (volume <= bestVolume.load()) return;
+    bestPlan = plan;
+    bestVolume = volume;
+    bestVersion++;
+}
+
+void ExactSearch::submit(Node node) {
+    activeTasks++;
+    auto task = std::make_shared<Node>(std::move(node));
+    pool.submit([this, task]() {
+        explore(*task);
+        finishTask();
+    });
+}
+
+void ExactSearch::explore(Node& node) {
+    long long upper = bound(node);
+    if (shouldStop()) {
+        abandon(upper);
+        return;
+    }
+    if (upper <= bestVolume.load()) return;
+
+    // Любой префикс - допустимое решение, поэтому рекорд обновляется в каждом узле
+    offer(node);
+
+    // После остановки по времени оставшиеся дети не обходятся, но их оценки
+    // нужны для разрыва; при отмене разрыв не интересен
+    bool stopped = false;
+    Node child{node.state, {}, {}, 0, 0, 0};
+    for (size_t g = 0; g < groups.size(); g++) {
+        const Group& group = groups[g];
+        if (node.dropped[g] || node.used[g] == group.items.size()) continue;
+        uint32_t item = group.items[node.used[g]];
+
+        for (size_t k = 0; k < group.orientationCount; k++) {
+            if (stopped && cancelled.load()) return;
+
+            Placement placement;
+            if (!packer.findOriented(node.state, item, group.orientations[k], placement)) continue;
+
+            // Копирование присваиванием переиспользует буферы предыдущего ребенка
+            child.state = node.state;
+            child.used = node.used;
+            child.dropped = node.dropped;
+            child.state.place(placement, manifest.typeOf(item), manifest.stopOf(item));
+            child.used[g]++;
+            child.volume = node.volume + placement.volume();
+            child.tallFootprint = node.tallFootprint +
+                (group.footprint > 0 ? static_cast<long long>(placement.width) * placement.depth : 0);
+            child.depth = node.depth + 1;
+
+            if (stopped) {
+                abandon(bound(child));
+            } else if (child.depth <= options.splitDepth) {
+                submit(child);
+            } else {
+                explore(child);
+            }
+
+            stopped = stopped || shouldStop();
+            // Рекорд мог вырасти в поддереве и сделать остальные ветви бесполезными
+            if (upper <= bestVolume.load()) return;
+        }
+    }
+}
+
+void ExactSearch::finishTask() {
+    // Задачи порождаются только работающими задачами, и все уменьшения счетчика идут
+    // под doneMutex: если он равен 1, эта задача последняя и новых уже не будет
+    std::lock_guard<std::mutex> lock(doneMutex);
+    if (activeTasks.load() == 1) finished = true;
+    if (activeTasks.fetch_sub(1) == 1) done.notify_all();
+}
+
+void ExactSearch::cancel() {
+    cancelled = true;
+}
+
+void ExactSearch::wait() {
+    std::unique_lock<std::mutex> lock(doneMutex);
+    done.wait(lock, [this]() { return activeTasks.load() == 0; });
+}
+
+bool ExactSearch::pollImprovement(LoadPlan& plan) {
+    std::lock_guard<std::mutex> lock(bestMutex);
+    if (bestVersion == polledVersion) return false;
+
+    polledVersion = bestVersion;
+    plan = bestPlan;
+    return true;
+}
+
+LoadPlan ExactSearch::best() const {
+    std::lock_guard<std::mutex> lock(bestMutex);
+    return bestPlan;
+}
+
+double ExactSearch::bestUtilisation() const {
+    long long capacity = trailer.volume();
+    return capacity > 0 ? static_cast<double>(std::max(0LL, bestVolume.load())) / static_cast<double>(capacity) : 0.0;
+}
+
+long long ExactSearch::upperBound() const {
+    // Оценки узлов ограничивают только продолжения их префиксов, то есть планы декодера;
+    // для любого плана годится лишь корневая оценка
+    return std::max(std::max(0LL, bestVolume.load()), rootBound);
+}
+
+double ExactSearch::gap() const {
+    return relativeGap(upperBound(), std::max(0LL, bestVolume.load()));
+}
+
+double ExactSearch::searchGap() const {
+    long long best = std::max(0LL, bestVolume.load());
+    // При отмене оценки оставшихся детей не собираются
+    if (!finished.load() || cancelled.load()) return gap();
+    return relativeGap(std::max(best, openBound.load()), best);
+}
+
+double ExactSearch::relativeGap(long long upper, long long best) {
+    if (upper <= 0) return 0.0;
+    return static_cast<double>(upper - best) / static_cast<double>(upper);
+}
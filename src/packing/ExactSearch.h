@@ -0,0 +1,144 @@
+#ifndef EXACTSEARCH_H
+#define EXACTSEARCH_H
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "Cargo.h"
+#include "LoadPlan.h"
+#include "Packer.h"
+#include "ThreadPool.h"
+
+struct ExactOptions {
+    int timeBudgetMs = 10000;
+    size_t maxItems = 40;               // Больше коробок - только жадное решение и оценка
+    int splitDepth = 3;                 // До этой глубины узлы уходят в пул отдельными задачами
+    PackerOptions packer;
+};
+
+// Ветви и границы для небольших манифестов (станки, ящики).
+// Решение строится как у жадного упаковщика - коробка ставится в первую
+// допустимую extreme point, - но ветвление перебирает, какая коробка и в
+// каком повороте идет следующей, так что при полном обходе найден лучший
+// план среди всех порядков и поворотов. Планы, которые декодер не строит
+// (коробка не в первой точке), не перебираются: оптимальность доказана,
+// только если рекорд достиг корневой оценки.
+//
+// Отсечение - верхней оценкой загружаемого объема: коробки, которые не
+// помещаются ни в одно максимальное пустое пространство, выбывают; высокие
+// коробки (любой поворот выше половины прицепа) не ставятся друг на друга,
+// поэтому их проекции на пол не пересекаются - это ограничивает их объем
+// дробным рюкзаком по свободной площади пола. Одинаковые коробки (тот же
+// тип и точка разгрузки) взаимозаменяемы: ветвление идет по группам, а
+// повороты с одинаковыми размерами рассматриваются один раз.
+//
+// Верхние уровни дерева - задачи пула с перехватом работы, глубже обход
+// последовательный; рекорд общий. Если время вышло, оценки брошенных узлов
+// дают верхнюю границу для планов декодера, и поиск сообщает оставшийся разрыв.
+class ExactSearch {
+private:
+    // Коробки одной группы неразличимы: берется первая еще не использованная
+    struct Group {
+        std::vector<uint32_t> items;
+        FreeSpaceIndex::Extent sizes[ORIENTATION_COUNT];
+        uint8_t orientations[ORIENTATION_COUNT];
+        size_t orientationCount = 0;
+        long long volume = 0;
+        long long footprint = 0;        // Минимальная площадь основания высокой коробки, 0 - невысокая
+    };
+
+    struct Node {
+        PackState state;
+        std::vector<uint16_t> used;     // Сколько коробок группы уже размещено
+        std::vector<uint8_t> dropped;   // Группа больше нигде не помещается
+        long long volume = 0;
+        long long tallFootprint = 0;    // Площадь пола под размещенными высокими коробками
+        int depth = 0;
+    };
+
+    Manifest manifest;                  // Копия: UI может менять свой манифест во время поиска
+    TrailerSpec trailer;
+    ThreadPool& pool;
+    ExactOptions options;
+    Packer packer;
+
+    std::vector<Group> groups;          // По убыванию объема коробки
+    std::vector<size_t> tallOrder;      // Высокие группы по убыванию объема на единицу площади пола
+    long long capacity = 0;             // Объем прицепа за вычетом препятствий кузова
+    bool hasRolls = false;              // Есть типы, для которых rolls::packable
+    long long rootBound = 0;
+    std::chrono::steady_clock::time_point deadline;
+
+    // Общий рекорд
+    mutable std::mutex bestMutex;
+    LoadPlan bestPlan;
+    std::atomic<long long> bestVolume{-1};
+    uint64_t bestVersion = 0;
+    uint64_t polledVersion = 0;
+
+    std::atomic<long long> openBound{-1};   // Максимум оценок узлов, брошенных по времени
+    // Обход завершен: полностью, по времени или отменой. Взводится до того, как
+    // activeTasks станет 0, поэтому после !isRunning() флаг уже виден
+    std::atomic<bool> finished{false};
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> timedOut{false};
+    std::atomic<int> activeTasks{0};
+    std::mutex doneMutex;
+    std::condition_variable done;
+
+    void buildGroups();
+    long long bound(Node& node) const;
+    void offer(const Node& node);
+    void abandon(long long nodeBound);
+    bool shouldStop();
+
+    void submit(Node node);
+    void explore(Node& node);
+    void finishTask();
+    static double relativeGap(long long upper, long long best);
+
+public:
+    ExactSearch(const Manifest& manifest, const TrailerSpec& trailer, ThreadPool& pool,
+                const ExactOptions& options = ExactOptions());
+    ~ExactSearch();
+
+    ExactSearch(const ExactSearch&) = delete;
+    ExactSearch& operator=(const ExactSearch&) = delete;
+
+    // Известное решение (например, из PackingSearch) - начальный рекорд. Вызывать до start().
+    void setWarmStart(const LoadPlan& plan);
+
+    // false, если манифест больше maxItems или в нем есть цилиндры, которые упаковщик
+    // ставит блоками (перебор кладет коробки по одной и блоков не строит): тогда
+    // доступны только жадный план и оценка
+    bool applicable() const { return !hasRolls && manifest.items.size() <= options.maxItems; }
+
+    void start();
+    void cancel();
+    void wait();
+    bool isRunning() const { return activeTasks.load() > 0; }
+
+    // Для UI-потока: true, если с прошлого вызова нашлось лучшее решение
+    bool pollImprovement(LoadPlan& plan);
+
+    LoadPlan best() const;
+    double bestUtilisation() const;
+
+    // Верхняя граница объема для любого плана - корневая оценка - и относительный
+    // разрыв (upper - best) / upper. Разрыв 0 - рекорд доказанно оптимален.
+    long long upperBound() const;
+    double gap() const;
+
+    // Разрыв среди планов декодера: пока поиск идет или после отмены - до корневой
+    // оценки, после остановки по времени - до максимума оценок брошенных узлов,
+    // после полного обхода - 0
+    double searchGap() const;
+    bool searchExhausted() const { return !isRunning() && searchGap() <= 0.0; }
+};
+
+#endif //EXACTSEARCH_H
@@ -0,0 +1,87 @@
+#include "FleetPacker.h"
+#include <algorithm>
+#include <future>
+
+size_t FleetPlan::placedCount() const {
+    size_t count = 0;
+    for (const auto& load : loads) {
+        count += load.plan.placements.size();
+    }
+    return count;
+}
+
+void FleetPlan::clear() {
+    loads.clear();
+    unplaced.clear();
+    totalCost = 0.0;
+}
+
+FleetPacker::FleetPacker(const Manifest& manifest, const std::vector<FleetVehicle>& vehicles, ThreadPool& pool)
+    : manifest(manifest), vehicles(vehicles), pool(pool) {
+}
+
+FleetPlan FleetPacker::pack() const {
+    FleetPlan fleet;
+    if (manifest.empty()) return fleet;
+
+    std::vector<uint32_t> remaining = Packer(manifest).defaultOrder();
+    std::vector<int> used(vehicles.size(), 0);
+
+    while (!remaining.empty()) {
+        // Все доступные типы упаковываются независимо, по задаче на тип
+        std::vector<size_t> candidates;
+        std::vector<std::future<LoadPlan>> plans;
+        for (size_t v = 0; v < vehicles.size(); v++) {
+            const FleetVehicle& vehicle = vehicles[v];
+            if (vehicle.available >= 0 && used[v] >= vehicle.available) continue;
+
+            candidates.push_back(v);
+            plans.push_back(pool.async([this, &vehicle, &remaining]() {
+                Packer packer(manifest, vehicle.packer);
+                return packer.pack(vehicle.trailer, remaining);
+            }));
+        }
+        if (candidates.empty()) break;
+
+        // Порядок сравнения фиксирован, поэтому результат не зависит от числа потоков
+        size_t bestIndex = candidates.size();
+        LoadPlan bestPlan;
+        bool bestTakesAll = false;
+        double bestScore = 0.0;
+
+        for (size_t i = 0; i < candidates.size(); i++) {
+            LoadPlan plan = plans[i].get();
+            // Машина, в которую не встала ни одна коробка, рейс не заменяет
+            if (plan.placements.empty()) continue;
+
+            const FleetVehicle& vehicle = vehicles[candidates[i]];
+            bool takesAll = plan.unplaced.empty();
+            double score = takesAll ? -vehicle.cost
+                                    : static_cast<double>(plan.loadedVolume()) / std::max(vehicle.cost, 1e-9);
+
+            bool better = bestIndex == candidates.size() ||
+                          (takesAll != bestTakesAll ? takesAll : score > bestScore);
+            if (better) {
+                bestIndex = i;
+                bestPlan = std::move(plan);
+                bestTakesAll = takesAll;
+                bestScore = score;
+            }
+        }
+
+        // Остаток не помещается ни в одну машину
+        if (bestIndex == candidates.size() || bestPlan.unplaced.size() == remaining.size()) break;
+
+        size_t vehicle = candidates[bestIndex];
+        used[vehicle]++;
+        fleet.totalCost += vehicles[vehicle].cost;
+
+        // unplaced сохраняет порядок remaining, пересортировка не нужна
+        remaining = std::move(bestPlan.unplaced);
+        bestPlan.unplaced.clear();
+        fleet.loads.push_back({vehicle, std::move(bestPlan)});
+    }
+
+    fleet.unplaced = std::move(remaining);
+    return fleet;
+}
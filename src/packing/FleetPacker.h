@@ -0,0 +1,57 @@
+#ifndef FLEETPACKER_H
+#define FLEETPACKER_H
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Cargo.h"
+#include "LoadPlan.h"
+#include "Packer.h"
+#include "ThreadPool.h"
+
+// Тип машины в парке
+struct FleetVehicle {
+    std::string name;
+    TrailerSpec trailer;
+    int available = -1;         // Сколько машин есть (< 0 - без ограничения)
+    double cost = 1.0;          // Стоимость рейса
+    PackerOptions packer;       // Опоры и дверь зависят от длины прицепа
+};
+
+// Загрузка одной машины
+struct FleetLoad {
+    size_t vehicle = 0;         // Индекс в списке FleetVehicle
+    LoadPlan plan;
+};
+
+struct FleetPlan {
+    std::vector<FleetLoad> loads;
+    std::vector<uint32_t> unplaced;     // Не поместились ни в одну доступную машину
+    double totalCost = 0.0;
+
+    size_t placedCount() const;
+    bool empty() const { return loads.empty(); }
+    void clear();
+};
+
+// Распределение манифеста по нескольким машинам.
+// Машины выбираются жадно по одной: оставшийся груз параллельно упаковывается
+// на пуле в каждый доступный тип, и берется машина, которая увозит весь остаток
+// дешевле всех, а если такой нет - с наибольшим загруженным объемом на единицу стоимости.
+class FleetPacker {
+private:
+    const Manifest& manifest;
+    std::vector<FleetVehicle> vehicles;
+    ThreadPool& pool;
+
+public:
+    FleetPacker(const Manifest& manifest, const std::vector<FleetVehicle>& vehicles, ThreadPool& pool);
+
+    // Блокирует вызывающий поток; нельзя вызывать из потока пула
+    FleetPlan pack() const;
+
+    const std::vector<FleetVehicle>& getVehicles() const { return vehicles; }
+};
+
+#endif //FLEETPACKER_H
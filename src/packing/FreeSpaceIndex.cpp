@@ -0,0 +1,802 @@
+#include "FreeSpaceIndex.h"
+#include "Simd.h"
+#include <algorithm>
+
+#if PACKING_SIMD_X86 && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace {
+
+// Слоев по x достаточно немного: пространства вдоль прицепа длинные,
+// и слишком тонкие слои только размножают ссылки на них
+constexpr int MAX_SLABS = 64;
+
+FreeSpaceIndex::Space toSpace(const Placement& placement) {
+    return {placement.x, placement.y, placement.z, placement.maxX(), placement.maxY(), placement.maxZ()};
+}
+
+long long volumeOf(const FreeSpaceIndex::Space& space) {
+    return static_cast<long long>(space.maxX - space.minX) * (space.maxY - space.minY) * (space.maxZ - space.minZ);
+}
+
+using Extent = FreeSpaceIndex::Extent;
+
+// Пакетные проверки над столбцами слоя. Возвращают первый подходящий индекс
+// в [from, count) или count: точки слоя идут в порядке заполнения, поэтому
+// лучший кандидат - самая младшая сработавшая дорожка (movemask + ctz)
+struct CandidateKernels {
+    // Хотя бы один из N размеров помещается в запас (x[i], y[i], z[i]). Ядра
+    // инстанцируются для каждого N, индекс в таблице - число поворотов
+    using FirstAdmitting = size_t (*)(const int* x, const int* y, const int* z, size_t from, size_t count,
+                                      const Extent* sizes);
+    FirstAdmitting firstAdmitting[ORIENTATION_COUNT + 1];
+    // Пространство i содержит параллелепипед box = {minX, minY, minZ, maxX, maxY, maxZ}
+    size_t (*firstContaining)(const int* const* columns, size_t from, size_t count, const int* box);
+    // Все такие пространства за один проход: индексы пишутся в out, возвращается их число
+    size_t (*allContaining)(const int* const* columns, size_t count, const int* box, uint32_t* out);
+};
+
+// ---------------- Scalar ----------------
+// Поиск первого совпадения нужен и SIMD-версиям - для хвостов короче вектора
+
+template <size_t N>
+size_t firstAdmittingScalar(const int* x, const int* y, const int* z, size_t from, size_t count, const Extent* sizes) {
+    for (size_t i = from; i < count; i++) {
+        for (size_t s = 0; s < N; s++) {
+            if (x[i] >= sizes[s].width && y[i] >= sizes[s].height && z[i] >= sizes[s].depth) return i;
+        }
+    }
+    return count;
+}
+
+size_t firstContainingScalar(const int* const* columns, size_t from, size_t count, const int* box) {
+    for (size_t i = from; i < count; i++) {
+        if (columns[0][i] <= box[0] && columns[1][i] <= box[1] && columns[2][i] <= box[2] &&
+            columns[3][i] >= box[3] && columns[4][i] >= box[4] && columns[5][i] >= box[5]) {
+            return i;
+        }
+    }
+    return count;
+}
+
+#if !PACKING_SIMD_X86
+
+size_t allContainingScalar(const int* const* columns, size_t count, const int* box, uint32_t* out) {
+    size_t found = 0;
+    for (size_t i = 0; i < count; i++) {
+        bool inside = columns[0][i] <= box[0] && columns[1][i] <= box[1] && columns[2][i] <= box[2] &&
+                      columns[3][i] >= box[3] && columns[4][i] >= box[4] && columns[5][i] >= box[5];
+        out[found] = static_cast<uint32_t>(i);
+        found += inside;
+    }
+    return found;
+}
+
+#else
+
+inline unsigned lowestBit(unsigned mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+// ---------------- SSE2 ----------------
+// Нестрогих сравнений целых нет, поэтому a >= b проверяется как a > b - 1
+
+template <size_t N>
+inline __m128i admitsSSE2(__m128i x, __m128i y, __m128i z, const __m128i* needs) {
+    __m128i any = _mm_setzero_si128();
+    for (size_t s = 0; s < N; s++) {
+        __m128i fits = _mm_and_si128(_mm_and_si128(_mm_cmpgt_epi32(x, needs[s * 3]), _mm_cmpgt_epi32(y, needs[s * 3 + 1])),
+                                     _mm_cmpgt_epi32(z, needs[s * 3 + 2]));
+        any = _mm_or_si128(any, fits);
+    }
+    return any;
+}
+
+template <size_t N>
+size_t firstAdmittingSSE2(const int* x, const int* y, const int* z, size_t from, size_t count, const Extent* sizes) {
+    __m128i needs[N * 3];
+    for (size_t s = 0; s < N; s++) {
+        needs[s * 3] = _mm_set1_epi32(sizes[s].width - 1);
+        needs[s * 3 + 1] = _mm_set1_epi32(sizes[s].height - 1);
+        needs[s * 3 + 2] = _mm_set1_epi32(sizes[s].depth - 1);
+    }
+
+    size_t i = from;
+    for (; i + 4 <= count; i += 4) {
+        __m128i any = admitsSSE2<N>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i)),
+                                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i)),
+                                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(z + i)), needs);
+        unsigned bits = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(any)));
+        if (bits) return i + lowestBit(bits);
+    }
+    return firstAdmittingScalar<N>(x, y, z, i, count, sizes);
+}
+
+inline void containmentBoundsSSE2(const int* box, __m128i* bounds) {
+    for (int k = 0; k < 3; k++) {
+        bounds[k] = _mm_set1_epi32(box[k] + 1);          // min[i] < box + 1
+        bounds[k + 3] = _mm_set1_epi32(box[k + 3] - 1);  // max[i] > box - 1
+    }
+}
+
+inline unsigned containsSSE2(const int* const* columns, size_t i, const __m128i* bounds) {
+    __m128i inside = _mm_set1_epi32(-1);
+    for (int k = 0; k < 3; k++) {
+        __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(columns[k] + i));
+        __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(columns[k + 3] + i));
+        inside = _mm_and_si128(inside, _mm_and_si128(_mm_cmpgt_epi32(bounds[k], low), _mm_cmpgt_epi32(high, bounds[k + 3])));
+    }
+    return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(inside)));
+}
+
+size_t firstContainingSSE2(const int* const* columns, size_t from, size_t count, const int* box) {
+    __m128i bounds[6];
+    containmentBoundsSSE2(box, bounds);
+
+    size_t i = from;
+    for (; i + 4 <= count; i += 4) {
+        unsigned bits = containsSSE2(columns, i, bounds);
+        if (bits) return i + lowestBit(bits);
+    }
+    return firstContainingScalar(columns, i, count, box);
+}
+
+size_t allContainingSSE2(const int* const* columns, size_t count, const int* box, uint32_t* out) {
+    __m128i bounds[6];
+    containmentBoundsSSE2(box, bounds);
+
+    size_t found = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        for (unsigned bits = containsSSE2(columns, i, bounds); bits; bits &= bits - 1) {
+            out[found++] = static_cast<uint32_t>(i + lowestBit(bits));
+        }
+    }
+    for (; i < count; i++) {
+        if (firstContainingScalar(columns, i, i + 1, box) == i) out[found++] = static_cast<uint32_t>(i);
+    }
+    return found;
+}
+
+// ---------------- AVX2 ----------------
+
+template <size_t N>
+PACKING_TARGET_AVX2 inline __m256i admitsAVX2(__m256i x, __m256i y, __m256i z, const __m256i* needs) {
+    __m256i any = _mm256_setzero_si256();
+    for (size_t s = 0; s < N; s++) {
+        __m256i fits = _mm256_and_si256(_mm256_and_si256(_mm256_cmpgt_epi32(x, needs[s * 3]), _mm256_cmpgt_epi32(y, needs[s * 3 + 1])),
+                                        _mm256_cmpgt_epi32(z, needs[s * 3 + 2]));
+        any = _mm256_or_si256(any, fits);
+    }
+    return any;
+}
+
+PACKING_TARGET_AVX2 inline unsigned laneMaskAVX2(__m256i v) {
+    return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(v)));
+}
+
+template <size_t N>
+PACKING_TARGET_AVX2 size_t firstAdmittingAVX2(const int* x, const int* y, const int* z, size_t from, size_t count,
+                                              const Extent* sizes) {
+    __m256i needs[N * 3];
+    for (size_t s = 0; s < N; s++) {
+        needs[s * 3] = _mm256_set1_epi32(sizes[s].width - 1);
+        needs[s * 3 + 1] = _mm256_set1_epi32(sizes[s].height - 1);
+        needs[s * 3 + 2] = _mm256_set1_epi32(sizes[s].depth - 1);
+    }
+
+    // Два независимых блока по 8 точек: 16 кандидатов на каждый поворот за итерацию
+    size_t i = from;
+    for (; i + 16 <= count; i += 16) {
+        __m256i low = admitsAVX2<N>(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i)),
+                                 _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i)),
+                                 _mm256_loadu_si256(reinterpret_cast<const __m256i*>(z + i)), needs);
+        __m256i high = admitsAVX2<N>(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i + 8)),
+                                  _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i + 8)),
+                                  _mm256_loadu_si256(reinterpret_cast<const __m256i*>(z + i + 8)), needs);
+        unsigned bits = laneMaskAVX2(low) | (laneMaskAVX2(high) << 8);
+        if (bits) return i + lowestBit(bits);
+    }
+    for (; i + 8 <= count; i += 8) {
+        __m256i any = admitsAVX2<N>(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i)),
+                                 _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i)),
+                                 _mm256_loadu_si256(reinterpret_cast<const __m256i*>(z + i)), needs);
+        unsigned bits = laneMaskAVX2(any);
+        if (bits) return i + lowestBit(bits);
+    }
+    return firstAdmittingScalar<N>(x, y, z, i, count, sizes);
+}
+
+PACKING_TARGET_AVX2 inline void containmentBoundsAVX2(const int* box, __m256i* bounds) {
+    for (int k = 0; k < 3; k++) {
+        bounds[k] = _mm256_set1_epi32(box[k] + 1);
+        bounds[k + 3] = _mm256_set1_epi32(box[k + 3] - 1);
+    }
+}
+
+PACKING_TARGET_AVX2 inline unsigned containsAVX2(const int* const* columns, size_t i, const __m256i* bounds) {
+    __m256i inside = _mm256_set1_epi32(-1);
+    for (int k = 0; k < 3; k++) {
+        __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columns[k] + i));
+        __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columns[k + 3] + i));
+        inside = _mm256_and_si256(inside, _mm256_and_si256(_mm256_cmpgt_epi32(bounds[k], low),
+                                                           _mm256_cmpgt_epi32(high, bounds[k + 3])));
+    }
+    return laneMaskAVX2(inside);
+}
+
+PACKING_TARGET_AVX2 size_t firstContainingAVX2(const int* const* columns, size_t from, size_t count, const int* box) {
+    __m256i bounds[6];
+    containmentBoundsAVX2(box, bounds);
+
+    size_t i = from;
+    for (; i + 16 <= count; i += 16) {
+        unsigned bits = containsAVX2(columns, i, bounds) | (containsAVX2(columns, i + 8, bounds) << 8);
+        if (bits) return i + lowestBit(bits);
+    }
+    for (; i + 8 <= count; i += 8) {
+        unsigned bits = containsAVX2(columns, i, bounds);
+        if (bits) return i + lowestBit(bits);
+    }
+    return firstContainingScalar(columns, i, count, box);
+}
+
+PACKING_TARGET_AVX2 size_t allContainingAVX2(const int* const* columns, size_t count, const int* box, uint32_t* out) {
+    __m256i bounds[6];
+    containmentBoundsAVX2(box, bounds);
+
+    size_t found = 0;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        unsigned bits = containsAVX2(columns, i, bounds) | (containsAVX2(columns, i + 8, bounds) << 8);
+        for (; bits; bits &= bits - 1) {
+            out[found++] = static_cast<uint32_t>(i + lowestBit(bits));
+        }
+    }
+    for (; i < count; i++) {
+        if (firstContainingScalar(columns, i, i + 1, box) == i) out[found++] = static_cast<uint32_t>(i);
+    }
+    return found;
+}
+
+#endif // PACKING_SIMD_X86
+
+const CandidateKernels& kernels() {
+    static const CandidateKernels selected = [] {
+#if PACKING_SIMD_X86
+        if (simd::hasAVX2()) {
+            return CandidateKernels{
+                {nullptr, firstAdmittingAVX2<1>, firstAdmittingAVX2<2>, firstAdmittingAVX2<3>,
+                 firstAdmittingAVX2<4>, firstAdmittingAVX2<5>, firstAdmittingAVX2<6>},
+                firstContainingAVX2, allContainingAVX2};
+        }
+        return CandidateKernels{
+            {nullptr, firstAdmittingSSE2<1>, firstAdmittingSSE2<2>, firstAdmittingSSE2<3>,
+             firstAdmittingSSE2<4>, firstAdmittingSSE2<5>, firstAdmittingSSE2<6>},
+            firstContainingSSE2, allContainingSSE2};
+#else
+        return CandidateKernels{
+            {nullptr, firstAdmittingScalar<1>, firstAdmittingScalar<2>, firstAdmittingScalar<3>,
+             firstAdmittingScalar<4>, firstAdmittingScalar<5>, firstAdmittingScalar<6>},
+            firstContainingScalar, allContainingScalar};
+#endif
+    }();
+    return selected;
+}
+
+} // namespace
+
+void FreeSpaceIndex::SpaceColumns::push(const Space& space) {
+    minX.push_back(space.minX);
+    minY.push_back(space.minY);
+    minZ.push_back(space.minZ);
+    maxX.push_back(space.maxX);
+    maxY.push_back(space.maxY);
+    maxZ.push_back(space.maxZ);
+}
+
+void FreeSpaceIndex::SpaceColumns::swapRemove(size_t index) {
+    for (std::vector<int>* column : {&minX, &minY, &minZ, &maxX, &maxY, &maxZ}) {
+        (*column)[index] = column->back();
+        column->pop_back();
+    }
+}
+
+FreeSpaceIndex::FreeSpaceIndex(const TrailerSpec& trailer) {
+    reset(trailer);
+}
+
+void FreeSpaceIndex::reset(const TrailerSpec& trailer) {
+    this->trailer = trailer;
+    int width = std::max(trailer.width, 1);
+    int slabCount = std::min(width, MAX_SLABS);
+    slabWidth = (width + slabCount - 1) / slabCount;
+    // Слои очищаются, а не пересоздаются: при повторной упаковке буферы переиспользуются
+    slabs.resize(static_cast<size_t>((width + slabWidth - 1) / slabWidth));
+    for (Slab& slab : slabs) {
+        slab.spaces.clear();
+        for (std::vector<int>* column : {&slab.columns.minX, &slab.columns.minY, &slab.columns.minZ,
+                                         &slab.columns.maxX, &slab.columns.maxY, &slab.columns.maxZ,
+                                         &slab.boundX, &slab.boundY, &slab.boundZ}) {
+            column->clear();
+        }
+        slab.points.clear();
+        slab.reaches.clear();
+        slab.liveReaches = 0;
+    }
+
+    treeLeaves = 1;
+    while (treeLeaves < slabs.size()) treeLeaves *= 2;
+    tree.assign(treeLeaves * 2, Reach());
+
+    spaces.clear();
+    spaceAlive.clear();
+    freeSlots.clear();
+    liveSpaces = 0;
+    boxes.clear();
+    boxAlive.clear();
+
+    if (trailer.width > 0 && trailer.height > 0 && trailer.depth > 0) {
+        insertSpace({0, 0, 0, trailer.width, trailer.height, trailer.depth});
+    }
+}
+
+int FreeSpaceIndex::slabOf(int x) const {
+    int slab = x / slabWidth;
+    return std::clamp(slab, 0, static_cast<int>(slabs.size()) - 1);
+}
+
+int FreeSpaceIndex::lastSlabOf(int maxX) const {
+    return slabOf(maxX - 1);
+}
+
+uint32_t FreeSpaceIndex::insertSpace(const Space& space) {
+    uint32_t index;
+    if (!freeSlots.empty()) {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+        spaces[index] = space;
+        spaceAlive[index] = 1;
+    } else {
+        index = static_cast<uint32_t>(spaces.size());
+        spaces.push_back(space);
+        spaceAlive.push_back(1);
+    }
+    liveSpaces++;
+
+    for (int s = slabOf(space.minX); s <= lastSlabOf(space.maxX); s++) {
+        slabs[s].spaces.push_back(index);
+        slabs[s].columns.push(space);
+    }
+    return index;
+}
+
+void FreeSpaceIndex::eraseSpace(uint32_t index) {
+    const Space& space = spaces[index];
+    for (int s = slabOf(space.minX); s <= lastSlabOf(space.maxX); s++) {
+        Slab& slab = slabs[s];
+        auto it = std::find(slab.spaces.begin(), slab.spaces.end(), index);
+        if (it != slab.spaces.end()) {
+            slab.columns.swapRemove(it - slab.spaces.begin());
+            *it = slab.spaces.back();
+            slab.spaces.pop_back();
+        }
+    }
+    spaceAlive[index] = 0;
+    freeSlots.push_back(index);
+    liveSpaces--;
+}
+
+void FreeSpaceIndex::collectIntersecting(const Space& box, std::vector<uint32_t>& out) const {
+    out.clear();
+    int first = slabOf(box.minX);
+    for (int s = first; s <= lastSlabOf(box.maxX); s++) {
+        for (uint32_t index : slabs[s].spaces) {
+            const Space& space = spaces[index];
+            // Пространство лежит в нескольких слоях; учитываем его в первом общем
+            if (std::max(slabOf(space.minX), first) != s) continue;
+            if (space.intersects(box)) out.push_back(index);
+        }
+    }
+}
+
+void FreeSpaceIndex::subtract(const Space& space, const Space& box, std::vector<Space>& out) {
+    if (!space.intersects(box)) {
+        out.push_back(space);
+        return;
+    }
+    // Остаток по каждой из шести сторон коробки, во всю ширину исходного пространства
+    if (box.minX > space.minX) out.push_back({space.minX, space.minY, space.minZ, box.minX, space.maxY, space.maxZ});
+    if (box.maxX < space.maxX) out.push_back({box.maxX, space.minY, space.minZ, space.maxX, space.maxY, space.maxZ});
+    if (box.minY > space.minY) out.push_back({space.minX, space.minY, space.minZ, space.maxX, box.minY, space.maxZ});
+    if (box.maxY < space.maxY) out.push_back({space.minX, box.maxY, space.minZ, space.maxX, space.maxY, space.maxZ});
+    if (box.minZ > space.minZ) out.push_back({space.minX, space.minY, space.minZ, space.maxX, space.maxY, box.minZ});
+    if (box.maxZ < space.maxZ) out.push_back({space.minX, space.minY, box.maxZ, space.maxX, space.maxY, space.maxZ});
+}
+
+bool FreeSpaceIndex::isDominated(const Space& space) const {
+    // Объемлющее пространство обязано содержать ячейку minX, то есть лежать в ее слое
+    const Slab& slab = slabs[slabOf(space.minX)];
+    return nextContaining(slab, 0, space) < slab.spaces.size();
+}
+
+size_t FreeSpaceIndex::nextContaining(const Slab& slab, size_t from, const Space& box) const {
+    const SpaceColumns& c = slab.columns;
+    const int* columns[6] = {c.minX.data(), c.minY.data(), c.minZ.data(), c.maxX.data(), c.maxY.data(), c.maxZ.data()};
+    const int bounds[6] = {box.minX, box.minY, box.minZ, box.maxX, box.maxY, box.maxZ};
+    return kernels().firstContaining(columns, from, slab.spaces.size(), bounds);
+}
+
+void FreeSpaceIndex::addMaximal(std::vector<Space>& candidates) {
+    // Большие первыми: поглотить остаток может только не меньший по объему
+    std::sort(candidates.begin(), candidates.end(), [](const Space& a, const Space& b) {
+        return volumeOf(a) > volumeOf(b);
+    });
+
+    size_t kept = 0;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        const Space& candidate = candidates[i];
+        bool dominated = false;
+        for (size_t k = 0; k < kept && !dominated; k++) {
+            dominated = candidates[k].contains(candidate);
+        }
+        if (dominated || isDominated(candidate)) continue;
+        candidates[kept++] = candidate;
+    }
+    candidates.resize(kept);
+
+    for (const Space& space : candidates) {
+        insertSpace(space);
+    }
+}
+
+void FreeSpaceIndex::place(const Placement& placement) {
+    Space box = toSpace(placement);
+    boxes.push_back(box);
+    boxAlive.push_back(1);
+
+    collectIntersecting(box, scratchHit);
+    scratchSpaces.clear();
+    scratchChanged.clear();
+    for (uint32_t index : scratchHit) {
+        scratchChanged.push_back(spaces[index]);
+        subtract(spaces[index], box, scratchSpaces);
+    }
+    for (uint32_t index : scratchHit) {
+        eraseSpace(index);
+    }
+    addMaximal(scratchSpaces);
+
+    // Точки, оказавшиеся внутри новой коробки, больше не нужны
+    for (int s = slabOf(box.minX); s <= lastSlabOf(box.maxX); s++) {
+        Slab& slab = slabs[s];
+        size_t kept = 0;
+        for (size_t i = 0; i < slab.points.size(); i++) {
+            const ExtremePoint& p = slab.points[i].point;
+            if (box.containsCell(p.x, p.y, p.z)) {
+                slab.liveReaches -= slab.points[i].reachCount;
+                continue;
+            }
+            slab.points[kept] = slab.points[i];
+            slab.boundX[kept] = slab.boundX[i];
+            slab.boundY[kept] = slab.boundY[i];
+            slab.boundZ[kept] = slab.boundZ[i];
+            kept++;
+        }
+        slab.points.resize(kept);
+        slab.boundX.resize(kept);
+        slab.boundY.resize(kept);
+        slab.boundZ.resize(kept);
+    }
+
+    // Остатки лежат внутри разрезанных пространств, поэтому запас меняется
+    // только у точек, которые были в них
+    refreshPoints(scratchChanged, box);
+}
+
+void FreeSpaceIndex::remove(const Placement& placement) {
+    Space box = toSpace(placement);
+    bool found = false;
+    for (size_t b = 0; b < boxes.size(); b++) {
+        const Space& other = boxes[b];
+        if (boxAlive[b] && other.minX == box.minX && other.minY == box.minY && other.minZ == box.minZ &&
+            other.maxX == box.maxX && other.maxY == box.maxY && other.maxZ == box.maxZ) {
+            boxAlive[b] = 0;
+            found = true;
+            break;
+        }
+    }
+    if (!found) return;
+
+    // Повтор разностного построения от пустого прицепа, но только для пространств,
+    // пересекающих освобожденный объем: остальные максимальные пространства не меняются
+    std::vector<Space> work = {{0, 0, 0, trailer.width, trailer.height, trailer.depth}};
+    std::vector<Space> next;
+    for (size_t b = 0; b < boxes.size(); b++) {
+        if (!boxAlive[b]) continue;
+        const Space& other = boxes[b];
+        bool touches = false;
+        for (const Space& space : work) {
+            if (space.intersects(other)) {
+                touches = true;
+                break;
+            }
+        }
+        if (!touches) continue;
+
+        next.clear();
+        for (const Space& space : work) {
+            size_t first = next.size();
+            subtract(space, other, next);
+            next.erase(std::remove_if(next.begin() + first, next.end(), [&](const Space& rest) {
+                return !rest.intersects(box);
+            }), next.end());
+        }
+
+        std::sort(next.begin(), next.end(), [](const Space& a, const Space& b) {
+            return volumeOf(a) > volumeOf(b);
+        });
+        work.clear();
+        for (const Space& space : next) {
+            bool dominated = false;
+            for (size_t k = 0; k < work.size() && !dominated; k++) {
+                dominated = work[k].contains(space);
+            }
+            if (!dominated) work.push_back(space);
+        }
+    }
+
+    // Старые пространства у границы коробки теперь поглощены новыми
+    for (const Space& space : work) {
+        collectIntersecting(space, scratchHit);
+        for (uint32_t index : scratchHit) {
+            if (spaceAlive[index] && space.contains(spaces[index])) eraseSpace(index);
+        }
+    }
+    for (const Space& space : work) {
+        if (!isDominated(space)) insertSpace(space);
+    }
+
+    // Поглощенные пространства лежат внутри новых, так что запас меняется только там
+    refreshPoints(work, box);
+    addPoint(box.minX, box.minY, box.minZ);
+}
+
+void FreeSpaceIndex::addPoint(int x, int y, int z) {
+    if (x < 0 || y < 0 || z < 0) return;
+    if (x >= trailer.width || y >= trailer.height || z >= trailer.depth) return;
+
+    ExtremePoint point{x, y, z};
+    int slab = slabOf(x);
+    Slab& target = slabs[slab];
+    auto it = std::lower_bound(target.points.begin(), target.points.end(), point,
+                               [](const PointEntry& entry, const ExtremePoint& p) { return entry.point < p; });
+    if (it != target.points.end() && it->point == point) return;
+
+    size_t position = it - target.points.begin();
+    PointEntry entry;
+    entry.point = point;
+    target.points.insert(it, entry);
+    target.boundX.insert(target.boundX.begin() + position, 0);
+    target.boundY.insert(target.boundY.begin() + position, 0);
+    target.boundZ.insert(target.boundZ.begin() + position, 0);
+    computeReach(target, position);
+
+    // Запас слоя только растет - достаточно поднять максимум до корня
+    Reach bound = target.boundOf(position);
+    for (size_t node = treeLeaves + slab; node >= 1; node /= 2) {
+        tree[node].merge(bound);
+    }
+}
+
+void FreeSpaceIndex::computeReach(Slab& slab, size_t point) {
+    PointEntry& entry = slab.points[point];
+    const ExtremePoint& p = entry.point;
+    slab.liveReaches -= entry.reachCount;
+    entry.reachBegin = static_cast<uint32_t>(slab.reaches.size());
+    entry.reachCount = 0;
+    Reach bound;
+
+    const SpaceColumns& c = slab.columns;
+    size_t found = collectContaining(slab, {p.x, p.y, p.z, p.x + 1, p.y + 1, p.z + 1});
+    for (size_t f = 0; f < found; f++) {
+        uint32_t i = scratchContaining[f];
+        Reach reach{c.maxX[i] - p.x, c.maxY[i] - p.y, c.maxZ[i] - p.z};
+
+        // Оставляем только недоминируемые размеры
+        Reach* begin = slab.reaches.data() + entry.reachBegin;
+        bool dominated = false;
+        uint32_t kept = 0;
+        for (uint32_t r = 0; r < entry.reachCount; r++) {
+            const Reach& other = begin[r];
+            if (other.x >= reach.x && other.y >= reach.y && other.z >= reach.z) {
+                dominated = true;
+                break;
+            }
+        }
+        if (dominated) continue;
+        for (uint32_t r = 0; r < entry.reachCount; r++) {
+            const Reach& other = begin[r];
+            if (!(reach.x >= other.x && reach.y >= other.y && reach.z >= other.z)) begin[kept++] = other;
+        }
+        slab.reaches.resize(entry.reachBegin + kept);
+        slab.reaches.push_back(reach);
+        entry.reachCount = kept + 1;
+        bound.merge(reach);
+    }
+
+    slab.liveReaches += entry.reachCount;
+    slab.boundX[point] = bound.x;
+    slab.boundY[point] = bound.y;
+    slab.boundZ[point] = bound.z;
+}
+
+void FreeSpaceIndex::compactReaches(Slab& slab) const {
+    if (slab.reaches.size() <= slab.liveReaches * 2 + 64) return;
+
+    std::vector<Reach> packed;
+    packed.reserve(slab.liveReaches);
+    for (auto& entry : slab.points) {
+        uint32_t begin = static_cast<uint32_t>(packed.size());
+        packed.insert(packed.end(), slab.reaches.begin() + entry.reachBegin,
+                      slab.reaches.begin() + entry.reachBegin + entry.reachCount);
+        entry.reachBegin = begin;
+    }
+    slab.reaches.swap(packed);
+}
+
+size_t FreeSpaceIndex::collectContaining(const Slab& slab, const Space& box) {
+    const SpaceColumns& c = slab.columns;
+    const int* columns[6] = {c.minX.data(), c.minY.data(), c.minZ.data(), c.maxX.data(), c.maxY.data(), c.maxZ.data()};
+    const int bounds[6] = {box.minX, box.minY, box.minZ, box.maxX, box.maxY, box.maxZ};
+    scratchContaining.resize(std::max(scratchContaining.size(), slab.spaces.size()));
+    return kernels().allContaining(columns, slab.spaces.size(), bounds, scratchContaining.data());
+}
+
+size_t FreeSpaceIndex::nextCandidate(const Slab& slab, size_t from, const Extent* sizes, size_t count) const {
+    if (count == 0 || count > ORIENTATION_COUNT) return slab.points.size();
+    return kernels().firstAdmitting[count](slab.boundX.data(), slab.boundY.data(), slab.boundZ.data(),
+                                           from, slab.points.size(), sizes);
+}
+
+uint32_t FreeSpaceIndex::fitMask(const Slab& slab, const PointEntry& entry, const Extent* sizes, size_t count) const {
+    const Reach* reaches = slab.reaches.data() + entry.reachBegin;
+    uint32_t mask = 0;
+    for (size_t i = 0; i < count; i++) {
+        for (uint32_t r = 0; r < entry.reachCount; r++) {
+            if (reaches[r].admits(sizes[i])) {
+                mask |= 1u << i;
+                break;
+            }
+        }
+    }
+    return mask;
+}
+
+void FreeSpaceIndex::refreshPoints(const std::vector<Space>& changed, const Space& box) {
+    int lo = box.minX, hi = box.maxX;
+    for (const Space& space : changed) {
+        lo = std::min(lo, space.minX);
+        hi = std::max(hi, space.maxX);
+    }
+
+    for (int s = slabOf(lo); s <= lastSlabOf(hi); s++) {
+        Slab& slab = slabs[s];
+        for (size_t i = 0; i < slab.points.size(); i++) {
+            const ExtremePoint& p = slab.points[i].point;
+            for (const Space& space : changed) {
+                if (space.containsCell(p.x, p.y, p.z)) {
+                    computeReach(slab, i);
+                    break;
+                }
+            }
+        }
+        compactReaches(slab);
+        updateTree(s);
+    }
+}
+
+void FreeSpaceIndex::updateTree(int slab) {
+    size_t node = treeLeaves + slab;
+    Reach leaf;
+    const Slab& current = slabs[slab];
+    for (size_t i = 0; i < current.points.size(); i++) {
+        leaf.merge(current.boundOf(i));
+    }
+    tree[node] = leaf;
+
+    for (node /= 2; node >= 1; node /= 2) {
+        Reach merged = tree[node * 2];
+        merged.merge(tree[node * 2 + 1]);
+        tree[node] = merged;
+    }
+}
+
+int FreeSpaceIndex::findSlab(size_t node, size_t lo, size_t hi, int from, const Extent* sizes, size_t count) const {
+    if (hi <= static_cast<size_t>(from) || lo >= slabs.size()) return -1;
+    if (!tree[node].admitsAny(sizes, count)) return -1;
+    if (hi - lo == 1) return static_cast<int>(lo);
+
+    size_t mid = (lo + hi) / 2;
+    int slab = findSlab(node * 2, lo, mid, from, sizes, count);
+    if (slab >= 0) return slab;
+    return findSlab(node * 2 + 1, mid, hi, from, sizes, count);
+}
+
+bool FreeSpaceIndex::isFree(const Placement& candidate) const {
+    if (!candidate.fitsInside(trailer) || slabs.empty()) return false;
+
+    Space box = toSpace(candidate);
+    const Slab& slab = slabs[slabOf(box.minX)];
+    return nextContaining(slab, 0, box) < slab.spaces.size();
+}
+
+bool FreeSpaceIndex::fitsAnywhere(const Extent* sizes, size_t count) const {
+    for (size_t i = 0; i < spaces.size(); i++) {
+        if (!spaceAlive[i]) continue;
+        const Space& space = spaces[i];
+        Reach room{space.maxX - space.minX, space.maxY - space.minY, space.maxZ - space.minZ};
+        if (room.admitsAny(sizes, count)) return true;
+    }
+    return false;
+}
+
+int FreeSpaceIndex::floorBelow(int x, int y, int z) const {
+    // Столбец под свободной ячейкой пуст до ближайшего препятствия, и его целиком
+    // содержит одно из максимальных пространств - его низ и есть искомая высота
+    if (x >= 0 && x < trailer.width && y >= 0 && y < trailer.height && z >= 0 && z < trailer.depth) {
+        int floor = -1;
+        const Slab& slab = slabs[slabOf(x)];
+        const Space cell{x, y, z, x + 1, y + 1, z + 1};
+        size_t end = slab.spaces.size();
+        for (size_t i = nextContaining(slab, 0, cell); i < end; i = nextContaining(slab, i + 1, cell)) {
+            int bottom = slab.columns.minY[i];
+            if (floor < 0 || bottom < floor) floor = bottom;
+        }
+        if (floor >= 0) return floor;
+    }
+
+    // Ячейка занята или вне прицепа: прямой перебор коробок под точкой
+    int floor = 0;
+    for (size_t b = 0; b < boxes.size(); b++) {
+        const Space& other = boxes[b];
+        if (boxAlive[b] && x >= other.minX && x < other.maxX && z >= other.minZ && z < other.maxZ &&
+            other.maxY <= y) {
+            floor = std::max(floor, other.maxY);
+        }
+    }
+    return floor;
+}
+
+std::vector<ExtremePoint> FreeSpaceIndex::getPoints() const {
+    std::vector<ExtremePoint> points;
+    points.reserve(pointCount());
+    for (const auto& slab : slabs) {
+        for (const auto& entry : slab.points) {
+            points.push_back(entry.point);
+        }
+    }
+    return points;
+}
+
+std::vector<FreeSpaceIndex::Space> FreeSpaceIndex::getSpaces() const {
+    std::vector<Space> live;
+    live.reserve(liveSpaces);
+    for (size_t i = 0; i < spaces.size(); i++) {
+        if (spaceAlive[i]) live.push_back(spaces[i]);
+    }
+    return live;
+}
+
+size_t FreeSpaceIndex::pointCount() const {
+    size_t count = 0;
+    for (const auto& slab : slabs) count += slab.points.size();
+    return count;
+}
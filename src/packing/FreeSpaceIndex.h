@@ -0,0 +1,235 @@
+#ifndef FREESPACEINDEX_H
+#define FREESPACEINDEX_H
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Cargo.h"
+#include "LoadPlan.h"
+
+struct ExtremePoint {
+    int x, y, z;
+
+    bool operator==(const ExtremePoint& other) const {
+        return x == other.x && y == other.y && z == other.z;
+    }
+    bool operator<(const ExtremePoint& other) const {
+        if (x != other.x) return x < other.x;
+        if (y != other.y) return y < other.y;
+        return z < other.z;
+    }
+};
+
+// Свободный объем прицепа: максимальные пустые параллелепипеды (maximal empty
+// spaces) и точки-кандидаты (extreme points) в порядке заполнения (x, y, z).
+//
+// Пространство режется на слои по x. Слой хранит пространства, которые его
+// пересекают, и свои точки, отсортированные по (x, y, z), так что обход слоев
+// по порядку дает глобальный порядок заполнения. Для каждой точки хранится
+// "запас" - размеры пространств, содержащих ее ячейку, а покомпонентные
+// максимумы запаса по слоям собраны в дерево отрезков: поиск первого слоя,
+// где коробка вообще может поместиться, логарифмический.
+//
+// Коробка свободна тогда и только тогда, когда целиком лежит в одном из
+// максимальных пространств, - это заменяет перебор всех размещенных коробок.
+// Границы пространств и запасы точек слоя хранятся столбцами, и проверки
+// идут пачками по 8-16 кандидатов (AVX2, иначе SSE2; выбор - во время выполнения).
+// Константные методы не трогают рабочие буферы, так что один индекс можно
+// опрашивать из нескольких потоков, пока его никто не меняет.
+class FreeSpaceIndex {
+public:
+    struct Space {
+        int minX, minY, minZ;
+        int maxX, maxY, maxZ;
+
+        bool contains(const Space& other) const {
+            return minX <= other.minX && minY <= other.minY && minZ <= other.minZ &&
+                   maxX >= other.maxX && maxY >= other.maxY && maxZ >= other.maxZ;
+        }
+        bool intersects(const Space& other) const {
+            return minX < other.maxX && other.minX < maxX &&
+                   minY < other.maxY && other.minY < maxY &&
+                   minZ < other.maxZ && other.minZ < maxZ;
+        }
+        bool containsCell(int x, int y, int z) const {
+            return x >= minX && x < maxX && y >= minY && y < maxY && z >= minZ && z < maxZ;
+        }
+    };
+
+    // Размеры коробки в одном из поворотов
+    struct Extent {
+        int width, height, depth;
+    };
+
+private:
+    struct Reach {
+        int x = 0, y = 0, z = 0;
+
+        bool admits(const Extent& size) const {
+            return x >= size.width && y >= size.height && z >= size.depth;
+        }
+        bool admitsAny(const Extent* sizes, size_t count) const {
+            for (size_t i = 0; i < count; i++) {
+                if (admits(sizes[i])) return true;
+            }
+            return false;
+        }
+        void merge(const Reach& other) {
+            if (other.x > x) x = other.x;
+            if (other.y > y) y = other.y;
+            if (other.z > z) z = other.z;
+        }
+    };
+
+    // Запас точки - недоминируемые размеры пространств, содержащих ее ячейку:
+    // коробка с углом в точке свободна ровно тогда, когда помещается в один из них
+    struct PointEntry {
+        ExtremePoint point;
+        uint32_t reachBegin = 0;           // Диапазон в Slab::reaches
+        uint32_t reachCount = 0;
+    };
+
+    // Границы пространств в виде структуры массивов для пакетных проверок
+    struct SpaceColumns {
+        std::vector<int> minX, minY, minZ, maxX, maxY, maxZ;
+
+        void push(const Space& space);
+        void swapRemove(size_t index);
+    };
+
+    struct Slab {
+        std::vector<uint32_t> spaces;      // Индексы в spaces, пересекающие слой
+        SpaceColumns columns;              // Копии их границ, параллельно spaces
+        std::vector<PointEntry> points;    // По возрастанию (x, y, z)
+        std::vector<int> boundX, boundY, boundZ;   // Покомпонентный максимум запаса, параллельно points
+        std::vector<Reach> reaches;        // Пул запасов точек, старые записи - мусор
+        size_t liveReaches = 0;
+
+        Reach boundOf(size_t point) const { return {boundX[point], boundY[point], boundZ[point]}; }
+    };
+
+    TrailerSpec trailer;
+    int slabWidth = 1;
+    std::vector<Slab> slabs;
+    std::vector<Reach> tree;               // Максимумы запаса по слоям, корень - 1
+    size_t treeLeaves = 1;
+
+    std::vector<Space> spaces;
+    std::vector<uint8_t> spaceAlive;
+    std::vector<uint32_t> freeSlots;
+    size_t liveSpaces = 0;
+
+    std::vector<Space> boxes;              // Занятые объемы для удаления и запасного пути
+    std::vector<uint8_t> boxAlive;
+
+    // Рабочие буферы, чтобы не выделять память на каждую коробку
+    std::vector<uint32_t> scratchHit;
+    std::vector<Space> scratchSpaces;
+    std::vector<Space> scratchChanged;
+    std::vector<uint32_t> scratchContaining;
+
+    int slabOf(int x) const;
+    int lastSlabOf(int maxX) const;
+
+    uint32_t insertSpace(const Space& space);
+    void eraseSpace(uint32_t index);
+    void collectIntersecting(const Space& box, std::vector<uint32_t>& out) const;
+    bool isDominated(const Space& space) const;
+    size_t nextContaining(const Slab& slab, size_t from, const Space& box) const;
+    // Индексы всех пространств слоя, содержащих box, - в scratchContaining
+    size_t collectContaining(const Slab& slab, const Space& box);
+    void addMaximal(std::vector<Space>& candidates);
+
+    void computeReach(Slab& slab, size_t point);
+    void compactReaches(Slab& slab) const;
+    size_t nextCandidate(const Slab& slab, size_t from, const Extent* sizes, size_t count) const;
+    uint32_t fitMask(const Slab& slab, const PointEntry& entry, const Extent* sizes, size_t count) const;
+    void refreshPoints(const std::vector<Space>& changed, const Space& box);
+    void updateTree(int slab);
+    int findSlab(size_t node, size_t lo, size_t hi, int from, const Extent* sizes, size_t count) const;
+
+    static void subtract(const Space& space, const Space& box, std::vector<Space>& out);
+
+public:
+    FreeSpaceIndex() = default;
+    explicit FreeSpaceIndex(const TrailerSpec& trailer);
+
+    void reset(const TrailerSpec& trailer);
+
+    // Отмечает коробку как занятую: пересеченные пространства режутся на остатки,
+    // поглощенные остатки отбрасываются, точки внутри коробки удаляются
+    void place(const Placement& placement);
+
+    // Освобождает объем ранее размещенной коробки. Новые максимальные пространства
+    // обязаны пересекать освобожденный объем, поэтому при их построении отбрасывается
+    // все, что его не касается; в угол коробки возвращается точка-кандидат
+    void remove(const Placement& placement);
+
+    // Точка вне прицепа или повтор игнорируется
+    void addPoint(int x, int y, int z);
+
+    // true, если коробка целиком лежит в свободном объеме прицепа
+    bool isFree(const Placement& candidate) const;
+
+    // true, если хотя бы один из размеров помещается в какое-нибудь максимальное
+    // пространство. При размещении пространства только сужаются, поэтому false
+    // означает, что коробку уже не поставить никуда
+    bool fitsAnywhere(const Extent* sizes, size_t count) const;
+
+    // Высота, на которую опустится точка по вертикали (пол или верх коробки)
+    int floorBelow(int x, int y, int z) const;
+
+    // Обходит точки в порядке заполнения; sizes - не больше ORIENTATION_COUNT
+    // поворотов. visit(point, mask) получает маску размеров, которые в этой точке
+    // лежат в свободном объеме (точки без таких размеров пропускаются), и
+    // возвращает true, чтобы остановить обход
+    template <typename Visitor>
+    void forEachCandidate(const Extent* sizes, size_t count, Visitor&& visit) const {
+        if (count == 0 || slabs.empty()) return;
+        int slab = findSlab(1, 0, treeLeaves, 0, sizes, count);
+        while (slab >= 0) {
+            const Slab& current = slabs[slab];
+            size_t end = current.points.size();
+            for (size_t i = nextCandidate(current, 0, sizes, count); i < end; i = nextCandidate(current, i + 1, sizes, count)) {
+                const PointEntry& entry = current.points[i];
+                uint32_t mask = fitMask(current, entry, sizes, count);
+                if (mask != 0 && visit(entry.point, mask)) return;
+            }
+            slab = findSlab(1, 0, treeLeaves, slab + 1, sizes, count);
+        }
+    }
+
+    // То же для груза, который подстраивает размер под место (блоки цилиндров):
+    // visit(point, reaches, count) получает недоминируемые размеры свободного
+    // объема с углом в точке; обходятся точки, где помещается smallest.
+    // Размеры копируются в буфер вызывающего, поэтому обход не меняет индекс
+    template <typename Visitor>
+    void forEachReach(const Extent& smallest, std::vector<Extent>& reaches, Visitor&& visit) const {
+        if (slabs.empty()) return;
+        int slab = findSlab(1, 0, treeLeaves, 0, &smallest, 1);
+        while (slab >= 0) {
+            const Slab& current = slabs[slab];
+            size_t end = current.points.size();
+            for (size_t i = nextCandidate(current, 0, &smallest, 1); i < end; i = nextCandidate(current, i + 1, &smallest, 1)) {
+                const PointEntry& entry = current.points[i];
+                if (fitMask(current, entry, &smallest, 1) == 0) continue;
+
+                reaches.clear();
+                for (uint32_t r = 0; r < entry.reachCount; r++) {
+                    const Reach& reach = current.reaches[entry.reachBegin + r];
+                    reaches.push_back({reach.x, reach.y, reach.z});
+                }
+                if (visit(entry.point, reaches.data(), reaches.size())) return;
+            }
+            slab = findSlab(1, 0, treeLeaves, slab + 1, &smallest, 1);
+        }
+    }
+
+    std::vector<ExtremePoint> getPoints() const;
+    std::vector<Space> getSpaces() const;
+    size_t pointCount() const;
+    size_t spaceCount() const { return liveSpaces; }
+};
+
+#endif //FREESPACEINDEX_H
@@ -0,0 +1,64 @@
+#include "LoadBalance.h"
+
+namespace {
+
+// Доля массы, приходящаяся на заднюю опору, для груза с центром в x
+inline double rearShare(const AxleLayout& axles, double x) {
+    double span = axles.rearPosition - axles.frontPosition;
+    if (span <= 0.0) return 0.5;
+    return (x - axles.frontPosition) / span;
+}
+
+} // namespace
+
+void LoadBalance::add(const Placement& placement, float boxMass) {
+    mass += boxMass;
+    momentX += boxMass * (placement.x + placement.width * 0.5);
+    momentY += boxMass * (placement.y + placement.height * 0.5);
+    momentZ += boxMass * (placement.z + placement.depth * 0.5);
+}
+
+void LoadBalance::remove(const Placement& placement, float boxMass) {
+    mass -= boxMass;
+    momentX -= boxMass * (placement.x + placement.width * 0.5);
+    momentY -= boxMass * (placement.y + placement.height * 0.5);
+    momentZ -= boxMass * (placement.z + placement.depth * 0.5);
+}
+
+void LoadBalance::clear() {
+    mass = momentX = momentY = momentZ = 0.0;
+}
+
+double LoadBalance::rearLoad(const AxleLayout& axles) const {
+    // sum(m_i * share(x_i)) = share(momentX / mass) * mass, т.к. share линейна
+    double span = axles.rearPosition - axles.frontPosition;
+    if (span <= 0.0) return mass * 0.5;
+    return (momentX - mass * axles.frontPosition) / span;
+}
+
+double LoadBalance::frontLoad(const AxleLayout& axles) const {
+    return mass - rearLoad(axles);
+}
+
+double LoadBalance::axleMargin(const AxleLayout& axles) const {
+    double front = axles.frontLimit > 0.0f ? 1.0 - frontLoad(axles) / axles.frontLimit : 1.0;
+    double rear = axles.rearLimit > 0.0f ? 1.0 - rearLoad(axles) / axles.rearLimit : 1.0;
+    return front < rear ? front : rear;
+}
+
+bool LoadBalance::fitsWith(const AxleLayout& axles, const Placement& placement, float boxMass) const {
+    if (!axles.enabled) return true;
+
+    double share = rearShare(axles, placement.x + placement.width * 0.5);
+    double rear = rearLoad(axles) + boxMass * share;
+    double front = frontLoad(axles) + boxMass * (1.0 - share);
+    return rear <= axles.rearLimit && front <= axles.frontLimit;
+}
+
+LoadBalance LoadBalance::fromPlan(const LoadPlan& plan, const Manifest& manifest) {
+    LoadBalance balance;
+    for (const auto& placement : plan.placements) {
+        balance.add(placement, manifest.typeOf(placement.item).weight);
+    }
+    return balance;
+}
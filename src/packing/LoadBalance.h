@@ -0,0 +1,51 @@
+#ifndef LOADBALANCE_H
+#define LOADBALANCE_H
+
+#pragma once
+
+#include "Cargo.h"
+#include "LoadPlan.h"
+
+// Положение опор прицепа вдоль оси x (см от передней стенки) и допустимые
+// нагрузки от груза в кг. Передняя опора - седельное устройство/передняя ось,
+// задняя - группа осей прицепа.
+struct AxleLayout {
+    bool enabled = false;
+    float frontPosition = 0.0f;
+    float rearPosition = 0.0f;
+    float frontLimit = 10000.0f;
+    float rearLimit = 24000.0f;
+};
+
+// Центр тяжести и нагрузки на оси, накапливаемые по одной коробке за O(1).
+// Прицеп рассматривается как балка на двух опорах: реакции линейны по
+// положению груза, поэтому достаточно хранить массу и моменты.
+class LoadBalance {
+private:
+    double mass = 0.0;
+    double momentX = 0.0, momentY = 0.0, momentZ = 0.0;
+
+public:
+    void add(const Placement& placement, float boxMass);
+    void remove(const Placement& placement, float boxMass);
+    void clear();
+
+    double getMass() const { return mass; }
+    // Центр тяжести в см; для пустого груза - (0, 0, 0)
+    double centerX() const { return mass > 0.0 ? momentX / mass : 0.0; }
+    double centerY() const { return mass > 0.0 ? momentY / mass : 0.0; }
+    double centerZ() const { return mass > 0.0 ? momentZ / mass : 0.0; }
+
+    double frontLoad(const AxleLayout& axles) const;
+    double rearLoad(const AxleLayout& axles) const;
+
+    // Минимальный относительный запас по осям: 1 - пустой, 0 - на пределе, < 0 - перегруз
+    double axleMargin(const AxleLayout& axles) const;
+
+    // Проверка до размещения: не превысит ли коробка лимиты осей
+    bool fitsWith(const AxleLayout& axles, const Placement& placement, float boxMass) const;
+
+    static LoadBalance fromPlan(const LoadPlan& plan, const Manifest& manifest);
+};
+
+#endif //LOADBALANCE_H
@@ -0,0 +1,38 @@
+#include "LoadPlan.h"
+#include <algorithm>
+
+long long LoadPlan::loadedVolume() const {
+    long long total = 0;
+    for (size_t i = 0; i < placements.size();) {
+        const Placement& first = placements[i++];
+        if (first.rollBlock == ROLL_NONE) {
+            total += first.volume();
+            continue;
+        }
+
+        int minX = first.x, minY = first.y, minZ = first.z;
+        int maxX = first.maxX(), maxY = first.maxY(), maxZ = first.maxZ();
+        for (; i < placements.size() && placements[i].rollBlock == ROLL_BLOCK_NEXT; i++) {
+            const Placement& slot = placements[i];
+            minX = std::min(minX, slot.x);
+            minY = std::min(minY, slot.y);
+            minZ = std::min(minZ, slot.z);
+            maxX = std::max(maxX, slot.maxX());
+            maxY = std::max(maxY, slot.maxY());
+            maxZ = std::max(maxZ, slot.maxZ());
+        }
+        total += static_cast<long long>(maxX - minX) * (maxY - minY) * (maxZ - minZ);
+    }
+    return total;
+}
+
+double LoadPlan::utilisation() const {
+    long long capacity = trailer.volume();
+    if (capacity <= 0) return 0.0;
+    return static_cast<double>(loadedVolume()) / static_cast<double>(capacity);
+}
+
+void LoadPlan::clear() {
+    placements.clear();
+    unplaced.clear();
+}
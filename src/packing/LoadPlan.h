@@ -0,0 +1,54 @@
+#ifndef LOADPLAN_H
+#define LOADPLAN_H
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Cargo.h"
+
+// Одна размещенная коробка. Координаты - минимальный угол в см.
+// Цилиндры блока раскладки (см. RollLayout) идут в плане подряд: первый помечен
+// ROLL_BLOCK_FIRST, остальные - ROLL_BLOCK_NEXT. Габариты цилиндров в сотах
+// перекрываются, поэтому объем блока считается по его габариту
+enum RollBlockMark : uint8_t {
+    ROLL_NONE = 0,
+    ROLL_BLOCK_FIRST = 1,
+    ROLL_BLOCK_NEXT = 2
+};
+
+struct Placement {
+    uint32_t item;
+    int x, y, z;
+    int width, height, depth;   // Размеры после поворота
+    uint8_t orientation;
+    uint8_t rollBlock = ROLL_NONE;
+
+    int maxX() const { return x + width; }
+    int maxY() const { return y + height; }
+    int maxZ() const { return z + depth; }
+
+    long long volume() const { return static_cast<long long>(width) * height * depth; }
+
+    bool fitsInside(const TrailerSpec& trailer) const {
+        return x >= 0 && y >= 0 && z >= 0 &&
+               maxX() <= trailer.width && maxY() <= trailer.height && maxZ() <= trailer.depth;
+    }
+};
+
+// Результат упаковки. placements хранится в порядке размещения:
+// каждая коробка опирается только на коробки, стоящие раньше в списке.
+struct LoadPlan {
+    TrailerSpec trailer;
+    std::vector<Placement> placements;
+    std::vector<uint32_t> unplaced;
+
+    // Коробки - по габариту, блоки цилиндров - по габариту блока
+    long long loadedVolume() const;
+    double utilisation() const;
+
+    bool empty() const { return placements.empty() && unplaced.empty(); }
+    void clear();
+};
+
+#endif //LOADPLAN_H
@@ -0,0 +1,308 @@
+#include "OccupancyGrid.h"
+#include "Simd.h"
+#include <algorithm>
+
+namespace {
+
+// Без инструкции POPCNT: скалярные и SSE2-ядра должны работать на процессорах без
+// нее. GCC и Clang без -mpopcnt сами подставляют программный подсчет, POPCNT
+// используют только AVX2-ядра (_mm_popcnt_u64 под PACKING_TARGET_AVX2)
+inline int popcount64(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(value);
+#else
+    value = value - ((value >> 1) & 0x5555555555555555ULL);
+    value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+    value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<int>((value * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Ядра над непрерывными массивами слов. Маски краев строк обрабатываются снаружи.
+struct GridKernels {
+    long long (*fill)(uint64_t* words, size_t count);              // Возвращает число вновь установленных бит
+    bool (*any)(const uint64_t* words, size_t count);
+    long long (*popcount)(const uint64_t* words, size_t count);
+};
+
+#if !PACKING_SIMD_X86
+
+// ---------------- Scalar ----------------
+
+long long fillScalar(uint64_t* words, size_t count) {
+    long long alreadySet = 0;
+    for (size_t i = 0; i < count; i++) {
+        alreadySet += popcount64(words[i]);
+        words[i] = ~0ULL;
+    }
+    return static_cast<long long>(count) * 64 - alreadySet;
+}
+
+bool anyScalar(const uint64_t* words, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (words[i]) return true;
+    }
+    return false;
+}
+
+long long popcountScalar(const uint64_t* words, size_t count) {
+    long long total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += popcount64(words[i]);
+    }
+    return total;
+}
+
+#else
+
+// ---------------- SSE2 ----------------
+
+inline __m128i popcountBytesSSE2(__m128i v) {
+    const __m128i m1 = _mm_set1_epi8(0x55);
+    const __m128i m2 = _mm_set1_epi8(0x33);
+    const __m128i m4 = _mm_set1_epi8(0x0F);
+    v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi64(v, 1), m1));
+    v = _mm_add_epi8(_mm_and_si128(v, m2), _mm_and_si128(_mm_srli_epi64(v, 2), m2));
+    v = _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi64(v, 4)), m4);
+    return _mm_sad_epu8(v, _mm_setzero_si128());
+}
+
+inline long long horizontalSumSSE2(__m128i v) {
+    return _mm_cvtsi128_si64(v) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(v, v));
+}
+
+long long fillSSE2(uint64_t* words, size_t count) {
+    const __m128i ones = _mm_set1_epi32(-1);
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + i));
+        acc = _mm_add_epi64(acc, popcountBytesSSE2(v));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(words + i), ones);
+    }
+    long long alreadySet = horizontalSumSSE2(acc);
+    for (; i < count; i++) {
+        alreadySet += popcount64(words[i]);
+        words[i] = ~0ULL;
+    }
+    return static_cast<long long>(count) * 64 - alreadySet;
+}
+
+bool anySSE2(const uint64_t* words, size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)) != 0xFFFF) return true;
+    }
+    return i < count && words[i] != 0;
+}
+
+long long popcountSSE2(const uint64_t* words, size_t count) {
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + i));
+        acc = _mm_add_epi64(acc, popcountBytesSSE2(v));
+    }
+    long long total = horizontalSumSSE2(acc);
+    for (; i < count; i++) {
+        total += popcount64(words[i]);
+    }
+    return total;
+}
+
+// ---------------- AVX2 ----------------
+
+// Подсчет бит через таблицу по полубайтам (pshufb), суммы по 64-битным дорожкам
+PACKING_TARGET_AVX2 inline __m256i popcountLanesAVX2(__m256i v) {
+    const __m256i lookup = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0F);
+    __m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low));
+    __m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+    return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+}
+
+PACKING_TARGET_AVX2 inline long long horizontalSumAVX2(__m256i v) {
+    __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    return _mm_cvtsi128_si64(sum) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(sum, sum));
+}
+
+PACKING_TARGET_AVX2 long long fillAVX2(uint64_t* words, size_t count) {
+    const __m256i ones = _mm256_set1_epi32(-1);
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+        acc = _mm256_add_epi64(acc, popcountLanesAVX2(v));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(words + i), ones);
+    }
+    long long alreadySet = horizontalSumAVX2(acc);
+    for (; i < count; i++) {
+        alreadySet += _mm_popcnt_u64(words[i]);
+        words[i] = ~0ULL;
+    }
+    return static_cast<long long>(count) * 64 - alreadySet;
+}
+
+PACKING_TARGET_AVX2 bool anyAVX2(const uint64_t* words, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+        if (!_mm256_testz_si256(v, v)) return true;
+    }
+    for (; i < count; i++) {
+        if (words[i]) return true;
+    }
+    return false;
+}
+
+PACKING_TARGET_AVX2 long long popcountAVX2(const uint64_t* words, size_t count) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+        acc = _mm256_add_epi64(acc, popcountLanesAVX2(v));
+    }
+    long long total = horizontalSumAVX2(acc);
+    for (; i < count; i++) {
+        total += _mm_popcnt_u64(words[i]);
+    }
+    return total;
+}
+
+#endif // PACKING_SIMD_X86
+
+const GridKernels& kernels() {
+    static const GridKernels selected = [] {
+#if PACKING_SIMD_X86
+        if (simd::hasAVX2()) return GridKernels{fillAVX2, anyAVX2, popcountAVX2};
+        return GridKernels{fillSSE2, anySSE2, popcountSSE2};
+#else
+        return GridKernels{fillScalar, anyScalar, popcountScalar};
+#endif
+    }();
+    return selected;
+}
+
+inline uint64_t rangeMask(int from, int to) {
+    // Биты [from, to] внутри одного слова
+    uint64_t high = (to == 63) ? ~0ULL : ((1ULL << (to + 1)) - 1);
+    return high & (~0ULL << from);
+}
+
+} // namespace
+
+OccupancyGrid::OccupancyGrid(int resolution)
+    : resolution(std::max(1, resolution)) {
+}
+
+void OccupancyGrid::reset(const TrailerSpec& trailer) {
+    sizeX = (trailer.width + resolution - 1) / resolution;
+    sizeY = (trailer.height + resolution - 1) / resolution;
+    sizeZ = (trailer.depth + resolution - 1) / resolution;
+    wordsPerRow = (sizeX + 63) / 64;
+    bits.assign(static_cast<size_t>(wordsPerRow) * sizeY * sizeZ, 0);
+    occupied = 0;
+}
+
+void OccupancyGrid::clear() {
+    std::fill(bits.begin(), bits.end(), 0);
+    occupied = 0;
+}
+
+bool OccupancyGrid::toVoxels(int x, int y, int z, int width, int height, int depth,
+                             int& x0, int& y0, int& z0, int& x1, int& y1, int& z1) const {
+    x0 = std::max(0, x / resolution);
+    y0 = std::max(0, y / resolution);
+    z0 = std::max(0, z / resolution);
+    x1 = std::min(sizeX, (x + width + resolution - 1) / resolution);
+    y1 = std::min(sizeY, (y + height + resolution - 1) / resolution);
+    z1 = std::min(sizeZ, (z + depth + resolution - 1) / resolution);
+    return x0 < x1 && y0 < y1 && z0 < z1;
+}
+
+long long OccupancyGrid::stamp(int x, int y, int z, int width, int height, int depth) {
+    int x0, y0, z0, x1, y1, z1;
+    if (!toVoxels(x, y, z, width, height, depth, x0, y0, z0, x1, y1, z1)) return 0;
+
+    const GridKernels& k = kernels();
+    int firstWord = x0 >> 6;
+    int lastWord = (x1 - 1) >> 6;
+    uint64_t firstMask = rangeMask(x0 & 63, firstWord == lastWord ? ((x1 - 1) & 63) : 63);
+    uint64_t lastMask = rangeMask(0, (x1 - 1) & 63);
+
+    long long added = 0;
+    for (int vy = y0; vy < y1; vy++) {
+        for (int vz = z0; vz < z1; vz++) {
+            uint64_t* words = row(vy, vz);
+
+            added += popcount64(firstMask & ~words[firstWord]);
+            words[firstWord] |= firstMask;
+            if (firstWord == lastWord) continue;
+
+            added += k.fill(words + firstWord + 1, static_cast<size_t>(lastWord - firstWord - 1));
+            added += popcount64(lastMask & ~words[lastWord]);
+            words[lastWord] |= lastMask;
+        }
+    }
+
+    occupied += added;
+    return added;
+}
+
+long long OccupancyGrid::stamp(const Placement& placement) {
+    return stamp(placement.x, placement.y, placement.z, placement.width, placement.height, placement.depth);
+}
+
+void OccupancyGrid::stampAll(const LoadPlan& plan) {
+    reset(plan.trailer);
+    for (const auto& placement : plan.placements) {
+        stamp(placement);
+    }
+}
+
+bool OccupancyGrid::isFree(int x, int y, int z, int width, int height, int depth) const {
+    if (x < 0 || y < 0 || z < 0 ||
+        x + width > sizeX * resolution || y + height > sizeY * resolution || z + depth > sizeZ * resolution) {
+        return false;
+    }
+
+    int x0, y0, z0, x1, y1, z1;
+    if (!toVoxels(x, y, z, width, height, depth, x0, y0, z0, x1, y1, z1)) return true;
+
+    const GridKernels& k = kernels();
+    int firstWord = x0 >> 6;
+    int lastWord = (x1 - 1) >> 6;
+    uint64_t firstMask = rangeMask(x0 & 63, firstWord == lastWord ? ((x1 - 1) & 63) : 63);
+    uint64_t lastMask = rangeMask(0, (x1 - 1) & 63);
+
+    for (int vy = y0; vy < y1; vy++) {
+        for (int vz = z0; vz < z1; vz++) {
+            const uint64_t* words = row(vy, vz);
+
+            if (words[firstWord] & firstMask) return false;
+            if (firstWord == lastWord) continue;
+
+            if (k.any(words + firstWord + 1, static_cast<size_t>(lastWord - firstWord - 1))) return false;
+            if (words[lastWord] & lastMask) return false;
+        }
+    }
+    return true;
+}
+
+bool OccupancyGrid::isFree(const Placement& placement) const {
+    return isFree(placement.x, placement.y, placement.z, placement.width, placement.height, placement.depth);
+}
+
+long long OccupancyGrid::countOccupied() const {
+    return kernels().popcount(bits.data(), bits.size());
+}
+
+double OccupancyGrid::fillRatio() const {
+    long long total = totalVoxels();
+    if (total <= 0) return 0.0;
+    return static_cast<double>(occupied) / static_cast<double>(total);
+}
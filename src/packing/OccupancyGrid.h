@@ -0,0 +1,54 @@
+#ifndef OCCUPANCYGRID_H
+#define OCCUPANCYGRID_H
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Cargo.h"
+#include "LoadPlan.h"
+
+// Воксельная сетка занятости объема прицепа.
+// Каждая строка (y, z) хранится как битсет по оси x из 64-битных слов.
+// Коробки округляются наружу до границ вокселей, поэтому при resolution > 1
+// сетка дает консервативную (завышенную) оценку занятого объема.
+class OccupancyGrid {
+private:
+    int resolution;
+    int sizeX = 0, sizeY = 0, sizeZ = 0;   // В вокселях
+    int wordsPerRow = 0;
+    std::vector<uint64_t> bits;
+    long long occupied = 0;
+
+    uint64_t* row(int y, int z) { return bits.data() + (static_cast<size_t>(y) * sizeZ + z) * wordsPerRow; }
+    const uint64_t* row(int y, int z) const { return bits.data() + (static_cast<size_t>(y) * sizeZ + z) * wordsPerRow; }
+
+    // Перевод box в диапазоны вокселей [begin, end); false, если пусто
+    bool toVoxels(int x, int y, int z, int width, int height, int depth,
+                  int& x0, int& y0, int& z0, int& x1, int& y1, int& z1) const;
+
+public:
+    explicit OccupancyGrid(int resolution = 1);
+
+    void reset(const TrailerSpec& trailer);
+    void clear();
+
+    // Отмечает box как занятый; возвращает число вновь занятых вокселей
+    long long stamp(int x, int y, int z, int width, int height, int depth);
+    long long stamp(const Placement& placement);
+    void stampAll(const LoadPlan& plan);
+
+    // true, если ни один воксель области не занят (область вне прицепа - не свободна)
+    bool isFree(int x, int y, int z, int width, int height, int depth) const;
+    bool isFree(const Placement& placement) const;
+
+    // Полный пересчет через popcount; occupiedVoxels() ведется инкрементально
+    long long countOccupied() const;
+    long long occupiedVoxels() const { return occupied; }
+    long long totalVoxels() const { return static_cast<long long>(sizeX) * sizeY * sizeZ; }
+    double fillRatio() const;
+
+    int getResolution() const { return resolution; }
+};
+
+#endif //OCCUPANCYGRID_H
@@ -0,0 +1,90 @@
+#ifndef ORIENTATION_H
+#define ORIENTATION_H
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "Cargo.h"
+
+// Наборы разрешенных поворотов, посчитанные на этапе компиляции.
+// Список для каждой из 64 масок лежит в constexpr-таблице, а частые классы
+// (свободный поворот, "этой стороной вверх", единственный поворот) доступны
+// как типы с размером-константой: ядра размещения инстанцируются под класс
+// один раз, и внутренние циклы по поворотам разворачиваются без проверок маски.
+namespace orientations {
+
+// "Этой стороной вверх": высота остается вертикальной, коробку можно только развернуть
+constexpr uint8_t UPRIGHT = (1u << ORIENT_WHD) | (1u << ORIENT_DHW);
+
+struct List {
+    uint8_t count = 0;
+    uint8_t items[ORIENTATION_COUNT] = {};
+
+    constexpr size_t size() const { return count; }
+    constexpr uint8_t operator[](size_t i) const { return items[i]; }
+};
+
+constexpr std::array<List, ORIENT_ALL + 1> makeLists() {
+    std::array<List, ORIENT_ALL + 1> lists = {};
+    for (unsigned mask = 0; mask <= ORIENT_ALL; mask++) {
+        List& list = lists[mask];
+        for (uint8_t orientation = 0; orientation < ORIENTATION_COUNT; orientation++) {
+            if ((mask >> orientation) & 1u) list.items[list.count++] = orientation;
+        }
+    }
+    return lists;
+}
+
+constexpr std::array<List, ORIENT_ALL + 1> LISTS = makeLists();
+
+// Повороты маски по возрастанию номера
+constexpr const List& listOf(uint8_t mask) {
+    return LISTS[mask & ORIENT_ALL];
+}
+
+// Набор с маской, известной при компиляции
+template <uint8_t Mask>
+struct Fixed {
+    static_assert(Mask != 0 && (Mask & ~ORIENT_ALL) == 0, "invalid orientation mask");
+
+    static constexpr uint8_t mask = Mask;
+    static constexpr size_t size() { return LISTS[Mask].count; }
+    constexpr uint8_t operator[](size_t i) const { return LISTS[Mask].items[i]; }
+};
+
+// Набор с произвольной маской: тот же интерфейс поверх строки таблицы
+struct Dynamic {
+    const List& list;
+
+    explicit constexpr Dynamic(uint8_t mask) : list(listOf(mask)) {}
+
+    constexpr size_t size() const { return list.count; }
+    constexpr uint8_t operator[](size_t i) const { return list.items[i]; }
+};
+
+static_assert(Fixed<ORIENT_ALL>::size() == ORIENTATION_COUNT, "free boxes have all orientations");
+static_assert(Fixed<UPRIGHT>::size() == 2 && Fixed<UPRIGHT>()[1] == ORIENT_DHW, "upright set");
+static_assert(ORIENTATION_AXES[ORIENT_HDW][0] == 1 && ORIENTATION_AXES[ORIENT_HDW][2] == 0, "axis table");
+
+// Вызывает visit с набором, соответствующим маске: частые классы - с типом
+// фиксированного размера, остальные - через строку таблицы
+template <typename Visitor>
+decltype(auto) dispatch(uint8_t mask, Visitor&& visit) {
+    switch (mask & ORIENT_ALL) {
+        case ORIENT_ALL: return visit(Fixed<ORIENT_ALL>());
+        case UPRIGHT: return visit(Fixed<UPRIGHT>());
+        case 1u << ORIENT_WHD: return visit(Fixed<1u << ORIENT_WHD>());
+        case 1u << ORIENT_DHW: return visit(Fixed<1u << ORIENT_DHW>());
+        case 1u << ORIENT_WDH: return visit(Fixed<1u << ORIENT_WDH>());
+        case 1u << ORIENT_HDW: return visit(Fixed<1u << ORIENT_HDW>());
+        case 1u << ORIENT_DWH: return visit(Fixed<1u << ORIENT_DWH>());
+        case 1u << ORIENT_HWD: return visit(Fixed<1u << ORIENT_HWD>());
+        default: return visit(Dynamic(mask));
+    }
+}
+
+} // namespace orientations
+
+#endif //ORIENTATION_H
@@ -0,0 +1,130 @@
+#include "PackState.h"
+#include <algorithm>
+
+PackState::PackState(const TrailerSpec& trailer, const AxleLayout& axles, size_t stopCount)
+    : trailer(trailer), axles(axles), freeSpace(trailer) {
+    freeSpace.addPoint(0, 0, 0);
+    unloading.reset(stopCount);
+    segregation.reset(trailer, nullptr);
+}
+
+void PackState::reset(const TrailerSpec& trailer, const AxleLayout& axles, size_t stopCount) {
+    this->trailer = trailer;
+    this->axles = axles;
+    placed.clear();
+    freeSpace.reset(trailer);
+    freeSpace.addPoint(0, 0, 0);
+    balance.clear();
+    supports.clear();
+    unloading.reset(stopCount);
+    segregation.reset(trailer);
+}
+
+void PackState::setSegregation(std::shared_ptr<const SegregationRules> rules) {
+    segregation.reset(trailer, std::move(rules));
+}
+
+bool PackState::overlaps(const Placement& candidate) const {
+    return !freeSpace.isFree(candidate);
+}
+
+long long PackState::supportArea(const Placement& candidate) const {
+    return supports.contactArea(candidate);
+}
+
+bool PackState::canPlace(const Placement& candidate, const BoxType& type, uint16_t stop, float defaultMinSupport) const {
+    return canPlaceFree(candidate, type, stop, defaultMinSupport) && !overlaps(candidate);
+}
+
+bool PackState::canPlaceFree(const Placement& candidate, const BoxType& type, uint16_t stop, float defaultMinSupport) const {
+    if (!candidate.fitsInside(trailer)) return false;
+    // Лимит осей проверяется для плана с этой коробкой - дешевле остальных проверок.
+    // Это не монотонное отсечение: коробка с центром за пределами базы разгружает
+    // дальнюю ось, так что отвергнутая сейчас коробка могла бы пройти позже
+    if (!balance.fitsWith(axles, candidate, type.weight)) return false;
+    if (!unloading.allows(candidate, stop)) return false;
+    if (!segregation.allows(candidate, type.compatibilityClass)) return false;
+
+    float minSupport = type.minSupport >= 0.0f ? type.minSupport : defaultMinSupport;
+    return supports.canSupport(candidate, type.weight, minSupport);
+}
+
+void PackState::place(const Placement& placement, const BoxType& type, uint16_t stop) {
+    placed.push_back(placement);
+    unloading.add(placement, stop);
+    segregation.add(placement, type.compatibilityClass);
+    balance.add(placement, type.weight);
+    supports.add(placement, type.weight, type.maxStackLoad);
+
+    // Индекс сам убирает точки, оказавшиеся внутри новой коробки
+    freeSpace.place(placement);
+    addPointsAround(placement);
+}
+
+bool PackState::removeLast(const BoxType& type, uint16_t stop) {
+    if (placed.empty() || placed.back().rollBlock != ROLL_NONE) return false;
+
+    Placement placement = placed.back();
+    placed.pop_back();
+    unloading.removeLast(stop);
+    segregation.removeLast(placement, type.compatibilityClass);
+    balance.remove(placement, type.weight);
+    supports.removeLast(placement, type.weight);
+    freeSpace.remove(placement);
+    return true;
+}
+
+void PackState::placeRolls(const Placement& extent, const RollBlock& block, const uint32_t* items,
+                           const BoxType& type, uint16_t stop) {
+    for (size_t i = 0; i < block.slots.size(); i++) {
+        Placement slot = block.slots[i];
+        slot.item = items[i];
+        slot.rollBlock = i == 0 ? ROLL_BLOCK_FIRST : ROLL_BLOCK_NEXT;
+        slot.x += extent.x;
+        slot.y += extent.y;
+        slot.z += extent.z;
+        placed.push_back(slot);
+        balance.add(slot, type.weight);
+    }
+    unloading.add(extent, stop);
+    segregation.add(extent, type.compatibilityClass);
+
+    // Нагрузка сверху делится между цилиндрами верхнего слоя, а нижний
+    // цилиндр уже несет все слои над собой
+    float mass = type.weight * static_cast<float>(block.slots.size());
+    float maxStackLoad = -1.0f;
+    if (type.maxStackLoad >= 0.0f) {
+        size_t top = 0;
+        for (const auto& slot : block.slots) top += slot.maxY() == block.size.height ? 1 : 0;
+        float carried = static_cast<float>(block.layers - 1) * type.weight;
+        maxStackLoad = std::max(0.0f, type.maxStackLoad - carried) * static_cast<float>(top);
+    }
+    if (block.flatTop) {
+        supports.add(extent, mass, maxStackLoad);
+    } else {
+        supports.addRolls(extent, mass, maxStackLoad, block.topX.data(), block.topZ.data(), block.topX.size(),
+                          block.radius);
+    }
+
+    freeSpace.place(extent);
+    addPointsAround(extent);
+}
+
+void PackState::block(const Placement& obstacle) {
+    supports.add(obstacle, 0.0f, -1.0f);
+    freeSpace.place(obstacle);
+    addPointsAround(obstacle);
+}
+
+void PackState::addPointsAround(const Placement& placement) {
+    // Три новые точки у граней коробки; боковые дополнительно "роняем" вниз,
+    // чтобы следующая коробка могла встать на пол или на верх соседей
+    freeSpace.addPoint(placement.maxX(), placement.y, placement.z);
+    freeSpace.addPoint(placement.x, placement.maxY(), placement.z);
+    freeSpace.addPoint(placement.x, placement.y, placement.maxZ());
+
+    if (placement.y > 0) {
+        freeSpace.addPoint(placement.maxX(), freeSpace.floorBelow(placement.maxX(), placement.y, placement.z), placement.z);
+        freeSpace.addPoint(placement.x, freeSpace.floorBelow(placement.x, placement.y, placement.maxZ()), placement.maxZ());
+    }
+}
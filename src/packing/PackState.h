@@ -0,0 +1,76 @@
+#ifndef PACKSTATE_H
+#define PACKSTATE_H
+
+#pragma once
+
+#include <vector>
+#include "Cargo.h"
+#include "FreeSpaceIndex.h"
+#include "LoadPlan.h"
+#include "LoadBalance.h"
+#include "RollLayout.h"
+#include "Segregation.h"
+#include "SupportGraph.h"
+#include "UnloadingOrder.h"
+
+// Частичное решение: размещенные коробки и точки-кандидаты (extreme points).
+// Используется упаковщиком как рабочее состояние, которое растет по одной коробке.
+// Координаты - в системе упаковщика: заполнение от x = 0, дверь на стороне max x.
+class PackState {
+private:
+    TrailerSpec trailer;
+    AxleLayout axles;
+    std::vector<Placement> placed;
+    FreeSpaceIndex freeSpace;
+    LoadBalance balance;
+    SupportGraph supports;
+    UnloadingOrder unloading;
+    SegregationIndex segregation;
+
+    void addPointsAround(const Placement& placement);
+
+public:
+    explicit PackState(const TrailerSpec& trailer, const AxleLayout& axles = AxleLayout(), size_t stopCount = 1);
+
+    // Возвращает состояние к пустому прицепу, сохраняя выделенную память
+    void reset(const TrailerSpec& trailer, const AxleLayout& axles, size_t stopCount);
+
+    // Правила совместимости классов груза; задаются до первой коробки и
+    // сохраняются при reset. nullptr - без ограничений
+    void setSegregation(std::shared_ptr<const SegregationRules> rules);
+
+    // Проверки для кандидата; коробка вне прицепа считается пересекающей
+    bool overlaps(const Placement& candidate) const;
+    long long supportArea(const Placement& candidate) const;
+    // defaultMinSupport используется, если у типа не задана своя доля опоры
+    bool canPlace(const Placement& candidate, const BoxType& type, uint16_t stop, float defaultMinSupport) const;
+    // То же без проверки пересечений - для кандидата, свободу которого уже подтвердил индекс
+    bool canPlaceFree(const Placement& candidate, const BoxType& type, uint16_t stop, float defaultMinSupport) const;
+
+    void place(const Placement& placement, const BoxType& type, uint16_t stop);
+
+    // Снимает последнюю коробку, поставленную через place, - с теми же type и stop.
+    // Свободный объем, нагрузки опор и центр тяжести становятся такими же, как без
+    // нее; точки-кандидаты у ее граней остаются, а в ее угол точка возвращается.
+    // Блок цилиндров так не снять - тогда возвращается false и ничего не меняется
+    bool removeLast(const BoxType& type, uint16_t stop);
+
+    // Блок цилиндров типа type в габарите extent: в индексе свободного места и
+    // в графе опор - один параллелепипед, в getPlacements() - по габариту на
+    // цилиндр из block.slots, items[i] - номер коробки i-го слота
+    void placeRolls(const Placement& extent, const RollBlock& block, const uint32_t* items, const BoxType& type,
+                    uint16_t stop);
+
+    // Препятствие кузова (колесная арка, стойка): занимает объем и служит опорой
+    // без ограничения нагрузки, но в getPlacements() не попадает и на оси не давит
+    void block(const Placement& obstacle);
+
+    const TrailerSpec& getTrailer() const { return trailer; }
+    const std::vector<Placement>& getPlacements() const { return placed; }
+    const FreeSpaceIndex& getFreeSpace() const { return freeSpace; }
+    std::vector<ExtremePoint> getPoints() const { return freeSpace.getPoints(); }
+    const LoadBalance& getBalance() const { return balance; }
+    const SupportGraph& getSupports() const { return supports; }
+};
+
+#endif //PACKSTATE_H
@@ -0,0 +1,379 @@
+#include "Packer.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include "Orientation.h"
+
+Packer::Packer(const Manifest& manifest, const PackerOptions& options)
+    : manifest(manifest), options(options) {
+}
+
+LoadPlan Packer::pack(const TrailerSpec& trailer) const {
+    return pack(trailer, defaultOrder());
+}
+
+LoadPlan Packer::pack(const TrailerSpec& trailer, const std::vector<uint32_t>& order) const {
+    return pack(trailer, order, std::vector<uint8_t>());
+}
+
+LoadPlan Packer::pack(const TrailerSpec& trailer, const std::vector<uint32_t>& order,
+                      const std::vector<uint8_t>& orientationHints) const {
+    LoadPlan plan, sparePlan;
+    PackState state(trailer), spareState(trailer);
+    pack(trailer, order.data(), orientationHints.empty() ? nullptr : orientationHints.data(), order.size(),
+         state, plan, spareState, sparePlan);
+    return plan;
+}
+
+void Packer::pack(const TrailerSpec& trailer, const uint32_t* order, const uint8_t* orientationHints, size_t count,
+                  PackState& state, LoadPlan& plan, PackState& spareState, LoadPlan& sparePlan) const {
+    resetPlan(trailer, count, state, plan);
+    placeSequence(state, order, orientationHints, count, plan, true);
+
+    bool hasRolls = false;
+    for (size_t i = 0; i < count && !hasRolls; i++) hasRolls = rolls::packable(manifest.typeOf(order[i]));
+    if (hasRolls) {
+        // Блоки выигрывают на грузах из одних цилиндров, а в смеси с коробками
+        // иногда проигрывают укладке по габариту: остается лучший из двух планов.
+        // Второй проход идет в запасные буферы вызывающего, без выделения памяти
+        resetPlan(trailer, count, spareState, sparePlan);
+        placeSequence(spareState, order, orientationHints, count, sparePlan, false);
+        if (cargoVolume(sparePlan) > cargoVolume(plan)) {
+            std::swap(plan, sparePlan);
+            std::swap(state, spareState);
+        }
+    }
+    toSceneFrame(plan);
+}
+
+long long Packer::cargoVolume(const LoadPlan& plan) {
+    // По габаритам самих грузов: loadedVolume считает блок целиком вместе с
+    // промежутками между цилиндрами и завысил бы проход блоками
+    long long total = 0;
+    for (const auto& placement : plan.placements) total += placement.volume();
+    return total;
+}
+
+void Packer::resetPlan(const TrailerSpec& trailer, size_t count, PackState& state, LoadPlan& plan) const {
+    plan.trailer = trailer;
+    plan.clear();
+    plan.placements.reserve(count);
+
+    state.reset(trailer, packerAxles(trailer), manifest.stopCount());
+    state.setSegregation(options.segregation);
+    blockInterior(state, trailer);
+}
+
+LoadPlan Packer::repack(const LoadPlan& previous, const TrailerSpec& trailer) const {
+    // Префикс с блоками цилиндров нельзя проверить поштучно: пакуем заново
+    for (const auto& type : manifest.types) {
+        if (rolls::packable(type)) return pack(trailer);
+    }
+
+    LoadPlan plan;
+    plan.trailer = trailer;
+    plan.placements.reserve(previous.placements.size() + previous.unplaced.size());
+
+    PackState state = createState(trailer);
+    std::vector<uint32_t> tail;
+
+    // Расстояние от передней стенки сохраняется при смене длины прицепа
+    LoadPlan canonical = previous;
+    toSceneFrame(canonical);
+
+    // Сохраняем префикс решения: порядок размещения гарантирует, что опоры
+    // каждой коробки проверяются раньше нее самой
+    for (const auto& placement : canonical.placements) {
+        const BoxType& type = manifest.typeOf(placement.item);
+        uint16_t stop = manifest.stopOf(placement.item);
+        if (state.canPlace(placement, type, stop, options.minSupportRatio)) {
+            state.place(placement, type, stop);
+            plan.placements.push_back(placement);
+        } else {
+            tail.push_back(placement.item);
+        }
+    }
+
+    tail.insert(tail.end(), previous.unplaced.begin(), previous.unplaced.end());
+    sortByDefaultOrder(tail);
+
+    placeSequence(state, tail.data(), nullptr, tail.size(), plan, false);
+    toSceneFrame(plan);
+    return plan;
+}
+
+PackState Packer::createState(const TrailerSpec& trailer) const {
+    return createState(trailer, manifest.stopCount());
+}
+
+PackState Packer::createState(const TrailerSpec& trailer, size_t stopCount) const {
+    PackState state(trailer, packerAxles(trailer), stopCount);
+    state.setSegregation(options.segregation);
+    blockInterior(state, trailer);
+    return state;
+}
+
+void Packer::blockInterior(PackState& state, const TrailerSpec& trailer) const {
+    if (!options.interior || options.interior->getTrailer() != trailer) return;
+    for (Placement obstacle : options.interior->getObstacles()) {
+        // Препятствия заданы в системе сцены
+        if (!options.doorAtMaxX) obstacle.x = trailer.width - obstacle.maxX();
+        state.block(obstacle);
+    }
+}
+
+AxleLayout Packer::packerAxles(const TrailerSpec& trailer) const {
+    AxleLayout axles = options.axles;
+    if (!options.doorAtMaxX) {
+        // Опоры в системе упаковщика, где передняя стенка всегда в x = 0
+        float front = trailer.width - axles.rearPosition;
+        float rear = trailer.width - axles.frontPosition;
+        axles.frontPosition = front;
+        axles.rearPosition = rear;
+        std::swap(axles.frontLimit, axles.rearLimit);
+    }
+    return axles;
+}
+
+void Packer::toSceneFrame(LoadPlan& plan) const {
+    // Отражение по x - само себе обратное, поэтому годится в обе стороны
+    if (options.doorAtMaxX) return;
+    for (auto& placement : plan.placements) {
+        placement.x = plan.trailer.width - placement.maxX();
+    }
+}
+
+std::vector<uint32_t> Packer::defaultOrder() const {
+    std::vector<uint32_t> order(manifest.items.size());
+    std::iota(order.begin(), order.end(), 0u);
+    sortByDefaultOrder(order);
+    return order;
+}
+
+void Packer::sortByDefaultOrder(std::vector<uint32_t>& items) const {
+    // Поздние точки разгрузки грузятся первыми (глубже от двери), внутри точки - по объему
+    std::stable_sort(items.begin(), items.end(), [this](uint32_t a, uint32_t b) {
+        uint16_t stopA = manifest.stopOf(a);
+        uint16_t stopB = manifest.stopOf(b);
+        if (stopA != stopB) return stopA > stopB;
+        return manifest.typeOf(a).volume() > manifest.typeOf(b).volume();
+    });
+}
+
+void Packer::placeSequence(PackState& state, const uint32_t* order, const uint8_t* orientationHints, size_t count,
+                           LoadPlan& plan, bool rollBlocks) const {
+    // Порядок по умолчанию и ключи поиска ставят коробки одного типа подряд,
+    // поэтому набор поворотов выбирается один раз на серию
+    for (size_t begin = 0; begin < count;) {
+        uint32_t type = manifest.items[order[begin]];
+        size_t end = begin + 1;
+        while (end < count && manifest.items[order[end]] == type) end++;
+
+        if (rollBlocks && rolls::packable(manifest.types[type])) {
+            placeRolls(state, order + begin, end - begin, plan);
+            begin = end;
+            continue;
+        }
+
+        orientations::dispatch(manifest.types[type].orientations, [&](const auto& set) {
+            for (size_t i = begin; i < end; i++) {
+                uint8_t preferred = orientationHints ? orientationHints[i] : NO_PREFERENCE;
+                placeWith(state, order[i], set, preferred, plan);
+            }
+        });
+        begin = end;
+    }
+}
+
+void Packer::placeRolls(PackState& state, const uint32_t* items, size_t count, LoadPlan& plan) const {
+    const BoxType& type = manifest.typeOf(items[0]);
+    RollBlock block, best;
+
+    for (size_t begin = 0; begin < count;) {
+        uint16_t stop = manifest.stopOf(items[begin]);
+        size_t end = begin + 1;
+        while (end < count && manifest.stopOf(items[end]) == stop) end++;
+
+        for (size_t next = begin; next < end;) {
+            Placement at;
+            double bestEfficiency = 0.0;
+            bool found = false;
+            for (size_t pattern = 0; pattern < ROLL_PATTERN_COUNT; pattern++) {
+                Placement candidate;
+                if (!findBlock(state, type, static_cast<RollPattern>(pattern), end - next, stop, block, candidate)) {
+                    continue;
+                }
+
+                // Как и для коробок, выигрывает первая точка в порядке заполнения.
+                // В одной точке блоки, упершиеся в стенки, сравниваются по числу
+                // цилиндров; иначе - по доле занятого объема (над лежачими цилиндрами
+                // без ровного верха ничего не ставится, поэтому им засчитывается весь
+                // столб до потолка), затем по числу цилиндров
+                double efficiency = blockEfficiency(state, block, candidate);
+                ExtremePoint point{candidate.x, candidate.y, candidate.z};
+                bool full = block.slots.size() < end - next && best.slots.size() < end - next;
+                bool better = !found;
+                if (found && !(point == ExtremePoint{at.x, at.y, at.z})) {
+                    better = point < ExtremePoint{at.x, at.y, at.z};
+                } else if (found && full && block.slots.size() != best.slots.size()) {
+                    better = block.slots.size() > best.slots.size();
+                } else if (found && std::abs(efficiency - bestEfficiency) > 0.01) {
+                    better = efficiency > bestEfficiency;
+                } else if (found) {
+                    better = block.slots.size() > best.slots.size();
+                }
+                if (better) {
+                    std::swap(best, block);
+                    at = candidate;
+                    bestEfficiency = efficiency;
+                    found = true;
+                }
+            }
+
+            if (!found) {
+                // Ни одна раскладка не встает даже из одного цилиндра - остаток
+                // серии ставится по габариту, как коробки
+                orientations::dispatch(type.orientations, [&](const auto& set) {
+                    for (size_t i = next; i < end; i++) placeWith(state, items[i], set, NO_PREFERENCE, plan);
+                });
+                break;
+            }
+
+            state.placeRolls(at, best, items + next, type, stop);
+            const auto& placed = state.getPlacements();
+            plan.placements.insert(plan.placements.end(), placed.end() - best.slots.size(), placed.end());
+            next += best.slots.size();
+        }
+        begin = end;
+    }
+}
+
+double Packer::blockEfficiency(const PackState& state, const RollBlock& block, const Placement& at) {
+    long long used = 0;
+    for (const auto& slot : block.slots) used += slot.volume();
+    int height = block.carriesLoad() ? at.height : state.getTrailer().height - at.y;
+    long long consumed = static_cast<long long>(at.width) * height * at.depth;
+    return consumed > 0 ? static_cast<double>(used) / static_cast<double>(consumed) : 0.0;
+}
+
+bool Packer::findBlock(const PackState& state, const BoxType& type, RollPattern pattern, size_t count,
+                       uint16_t stop, RollBlock& block, Placement& result) const {
+    const TrailerSpec& trailer = state.getTrailer();
+    const FreeSpaceIndex::Extent whole = {trailer.width, trailer.height, trailer.depth};
+    if (!rolls::build(type, pattern, 1, whole, block)) return false;
+    const FreeSpaceIndex::Extent single = block.size;
+
+    // Блок строится под каждое свободное пространство с углом в точке и поэтому
+    // свободен по построению; в точке выбирается блок с наибольшим числом цилиндров
+    RollBlock trial;
+    BoxType blockType = type;
+    std::vector<FreeSpaceIndex::Extent> reachBuffer;
+    bool found = false;
+
+    state.getFreeSpace().forEachReach(single, reachBuffer, [&](const ExtremePoint& point, const FreeSpaceIndex::Extent* reaches,
+                                                  size_t reachCount) {
+        for (size_t r = 0; r < reachCount; r++) {
+            if (!rolls::build(type, pattern, count, reaches[r], trial)) continue;
+            if (found && trial.slots.size() <= block.slots.size()) continue;
+
+            Placement candidate;
+            candidate.item = 0;
+            candidate.x = point.x;
+            candidate.y = point.y;
+            candidate.z = point.z;
+            candidate.width = trial.size.width;
+            candidate.height = trial.size.height;
+            candidate.depth = trial.size.depth;
+            candidate.orientation = trial.orientation;
+
+            // Блок проверяется как одна коробка с массой всех цилиндров
+            blockType.weight = type.weight * static_cast<float>(trial.slots.size());
+            if (!state.canPlaceFree(candidate, blockType, stop, options.minSupportRatio)) continue;
+
+            std::swap(block, trial);
+            result = candidate;
+            found = true;
+        }
+        return found;
+    });
+    return found;
+}
+
+bool Packer::placeItem(PackState& state, uint32_t item, LoadPlan& plan) const {
+    return placeItem(state, item, NO_PREFERENCE, plan);
+}
+
+bool Packer::placeItem(PackState& state, uint32_t item, uint8_t preferred, LoadPlan& plan) const {
+    return orientations::dispatch(manifest.typeOf(item).orientations, [&](const auto& set) {
+        return placeWith(state, item, set, preferred, plan);
+    });
+}
+
+bool Packer::findOriented(const PackState& state, uint32_t item, uint8_t orientation, Placement& result) const {
+    if (orientation >= ORIENTATION_COUNT || !manifest.typeOf(item).allows(orientation)) return false;
+    return orientations::dispatch(static_cast<uint8_t>(1u << orientation), [&](const auto& set) {
+        return findPlacement(state, item, set, NO_PREFERENCE, result);
+    });
+}
+
+template <typename Set>
+bool Packer::placeWith(PackState& state, uint32_t item, const Set& set, uint8_t preferred, LoadPlan& plan) const {
+    Placement placement;
+    if (!findPlacement(state, item, set, preferred, placement)) {
+        plan.unplaced.push_back(item);
+        return false;
+    }
+
+    state.place(placement, manifest.typeOf(item), manifest.stopOf(item));
+    plan.placements.push_back(placement);
+    return true;
+}
+
+template <typename Set>
+bool Packer::findPlacement(const PackState& state, uint32_t item, const Set& set, uint8_t preferred,
+                           Placement& result) const {
+    const BoxType& type = manifest.typeOf(item);
+    uint16_t stop = manifest.stopOf(item);
+    bool found = false;
+
+    FreeSpaceIndex::Extent sizes[ORIENTATION_COUNT];
+    for (size_t i = 0; i < set.size(); i++) {
+        type.orientedSize(set[i], sizes[i].width, sizes[i].height, sizes[i].depth);
+    }
+
+    // Точки идут в порядке заполнения, поэтому первая точка с допустимым
+    // поворотом и есть ответ - остальные можно не рассматривать
+    state.getFreeSpace().forEachCandidate(sizes, set.size(), [&](const ExtremePoint& point, uint32_t fits) {
+        for (size_t i = 0; i < set.size(); i++) {
+            if (!(fits & (1u << i))) continue;
+
+            Placement candidate;
+            candidate.item = item;
+            candidate.x = point.x;
+            candidate.y = point.y;
+            candidate.z = point.z;
+            candidate.orientation = set[i];
+            candidate.width = sizes[i].width;
+            candidate.height = sizes[i].height;
+            candidate.depth = sizes[i].depth;
+            if (!state.canPlaceFree(candidate, type, stop, options.minSupportRatio)) continue;
+
+            // В одной точке: сначала предпочтительный поворот, затем самый компактный по x и y
+            bool better = !found;
+            if (found) {
+                bool candidatePreferred = candidate.orientation == preferred;
+                bool resultPreferred = result.orientation == preferred;
+                better = candidatePreferred != resultPreferred ? candidatePreferred :
+                    std::make_pair(candidate.maxX(), candidate.maxY()) < std::make_pair(result.maxX(), result.maxY());
+            }
+
+            if (better) {
+                result = candidate;
+                found = true;
+            }
+        }
+        return found;
+    });
+
+    return found;
+}
@@ -0,0 +1,116 @@
+#ifndef PACKER_H
+#define PACKER_H
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "Cargo.h"
+#include "LoadPlan.h"
+#include "PackState.h"
+#include "Segregation.h"
+#include "TrailerInterior.h"
+
+struct PackerOptions {
+    // Минимальная доля основания коробки, которая должна опираться на пол или другие коробки
+    // (для типов без собственного BoxType::minSupport)
+    float minSupportRatio = 0.75f;
+
+    // Ограничения нагрузки на оси (выключены, если axles.enabled == false)
+    AxleLayout axles;
+
+    // Сторона двери прицепа в координатах сцены. Упаковщик всегда заполняет
+    // от передней стенки к двери и при необходимости отражает результат по x.
+    bool doorAtMaxX = true;
+
+    // Геометрия кузова: препятствия ставятся в состояние до первой коробки.
+    // Учитывается только для прицепа, под который построена; nullptr - пустой параллелепипед
+    std::shared_ptr<const TrailerInterior> interior;
+
+    // Совместимость классов груза (опасные грузы, продукты); nullptr - без ограничений
+    std::shared_ptr<const SegregationRules> segregation;
+};
+
+// Жадный упаковщик по extreme points: коробки ставятся по очереди
+// в первую подходящую точку в порядке заполнения (x, затем y, затем z).
+// Цилиндры при полной упаковке ставятся блоками (см. RollLayout), если это
+// дает больший объем, чем по габариту. Потоковая упаковка и findOriented ставят
+// их по габариту, как коробки; repack для груза с цилиндрами пакует заново.
+class Packer {
+private:
+    const Manifest& manifest;
+    PackerOptions options;
+
+    // Set - набор поворотов из orientations (Fixed или Dynamic): ядро
+    // инстанцируется под класс поворотов и выбирается один раз на серию коробок
+    template <typename Set>
+    bool findPlacement(const PackState& state, uint32_t item, const Set& set, uint8_t preferred,
+                       Placement& result) const;
+    template <typename Set>
+    bool placeWith(PackState& state, uint32_t item, const Set& set, uint8_t preferred, LoadPlan& plan) const;
+    bool placeItem(PackState& state, uint32_t item, uint8_t preferred, LoadPlan& plan) const;
+    AxleLayout packerAxles(const TrailerSpec& trailer) const;
+    void blockInterior(PackState& state, const TrailerSpec& trailer) const;
+    // rollBlocks == false - цилиндры по габариту, как коробки
+    void placeSequence(PackState& state, const uint32_t* order, const uint8_t* orientationHints, size_t count,
+                       LoadPlan& plan, bool rollBlocks) const;
+    static long long cargoVolume(const LoadPlan& plan);
+    // Пустой план и состояние под trailer с препятствиями кузова и правилами совместимости
+    void resetPlan(const TrailerSpec& trailer, size_t count, PackState& state, LoadPlan& plan) const;
+    // Серия цилиндров одного типа - блоками RollLayout вместо поштучной укладки
+    void placeRolls(PackState& state, const uint32_t* items, size_t count, LoadPlan& plan) const;
+    static double blockEfficiency(const PackState& state, const RollBlock& block, const Placement& at);
+    // Первая точка, куда встает блок раскладки pattern из не более чем count цилиндров
+    bool findBlock(const PackState& state, const BoxType& type, RollPattern pattern, size_t count, uint16_t stop,
+                   RollBlock& block, Placement& result) const;
+
+public:
+    static constexpr uint8_t NO_PREFERENCE = 0xFF;
+
+    explicit Packer(const Manifest& manifest, const PackerOptions& options = PackerOptions());
+
+    // Полная упаковка всего манифеста
+    LoadPlan pack(const TrailerSpec& trailer) const;
+    LoadPlan pack(const TrailerSpec& trailer, const std::vector<uint32_t>& order) const;
+
+    // orientationHints[i] - предпочтительный поворот для order[i]: точка выбирается
+    // как обычно, а среди поворотов, помещающихся в нее, выигрывает предпочтительный.
+    // NO_PREFERENCE - обычный выбор самого компактного поворота.
+    LoadPlan pack(const TrailerSpec& trailer, const std::vector<uint32_t>& order,
+                  const std::vector<uint8_t>& orientationHints) const;
+
+    // То же для поиска: state и plan переиспользуются между вызовами без
+    // выделения памяти, order и orientationHints (может быть nullptr) - плоские
+    // массивы из count элементов, например из арены исполнителя. spareState и
+    // sparePlan - буферы второго прохода для грузов с цилиндрами, их содержимое
+    // после вызова не определено
+    void pack(const TrailerSpec& trailer, const uint32_t* order, const uint8_t* orientationHints, size_t count,
+              PackState& state, LoadPlan& plan, PackState& spareState, LoadPlan& sparePlan) const;
+
+    // Инкрементальная переупаковка под новый прицеп: коробки из previous, которые
+    // по-прежнему помещаются и опираются на сохраненные коробки, остаются на месте,
+    // заново решается только "хвост" (выпавшие и ранее не размещенные коробки).
+    // Если в манифесте есть цилиндры для блоков, равносильна pack(trailer).
+    LoadPlan repack(const LoadPlan& previous, const TrailerSpec& trailer) const;
+
+    // Потоковая упаковка, когда коробки поступают по одной: createState, затем
+    // placeItem для каждой коробки и toSceneFrame для готового плана. Манифест может
+    // расти между вызовами, stopCount задается заранее.
+    PackState createState(const TrailerSpec& trailer) const;
+    PackState createState(const TrailerSpec& trailer, size_t stopCount) const;
+    bool placeItem(PackState& state, uint32_t item, LoadPlan& plan) const;
+    void toSceneFrame(LoadPlan& plan) const;
+
+    // Первая допустимая точка для коробки в заданном повороте, без размещения;
+    // false, если поворот запрещен типом или коробка никуда не помещается
+    bool findOriented(const PackState& state, uint32_t item, uint8_t orientation, Placement& result) const;
+
+    // Порядок по умолчанию: сначала поздние точки разгрузки, внутри - по убыванию объема
+    std::vector<uint32_t> defaultOrder() const;
+    void sortByDefaultOrder(std::vector<uint32_t>& items) const;
+
+    const Manifest& getManifest() const { return manifest; }
+    const PackerOptions& getOptions() const { return options; }
+};
+
+#endif //PACKER_H
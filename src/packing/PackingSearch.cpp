@@ -0,0 +1,340 @@
+#include "PackingSearch.h"
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+inline uint64_t nextRandom(uint64_t& state) {
+    // splitmix64
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+inline float randomUnit(uint64_t& state) {
+    return static_cast<float>(nextRandom(state) >> 40) / static_cast<float>(1ULL << 24);
+}
+
+} // namespace
+
+PackingSearch::PackingSearch(const Manifest& manifest, const TrailerSpec& trailer, ThreadPool& pool,
+                             const SearchOptions& options)
+    : manifest(manifest), trailer(trailer), pool(pool), options(options),
+      packer(this->manifest, options.packer) {
+}
+
+PackingSearch::~PackingSearch() {
+    cancel();
+    wait();
+}
+
+void PackingSearch::start() {
+    cancelled = false;
+    deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.timeBudgetMs);
+
+    // Жадное решение - нижняя граница качества и первое, что увидит пользователь
+    {
+        LoadPlan greedy = packer.pack(trailer);
+        if (warmPlan.loadedVolume() > greedy.loadedVolume()) greedy = warmPlan;
+        std::lock_guard<std::mutex> lock(bestMutex);
+        bestPlan = std::move(greedy);
+        bestVolume = bestPlan.loadedVolume();
+        bestMargin = options.packer.axles.enabled ?
+            LoadBalance::fromPlan(bestPlan, manifest).axleMargin(options.packer.axles) : 0.0;
+        bestVersion++;
+    }
+
+    size_t islandCount = options.islands > 0 ? static_cast<size_t>(options.islands) : pool.size();
+    // Острова сохраняются между запусками вместе с памятью своих арен
+    islands.resize(islandCount);
+
+    activeTasks = static_cast<int>(islandCount);
+    for (size_t i = 0; i < islandCount; i++) {
+        pool.submit([this, i]() {
+            seedIsland(islands[i], i);
+            runEpoch(i);
+        });
+    }
+}
+
+void PackingSearch::setWarmStart(const LoadPlan& plan) {
+    if (plan.trailer != trailer || plan.placements.empty()) return;
+    warmPlan = plan;
+    encode(warmPlan, warmKeys);
+}
+
+void PackingSearch::cancel() {
+    cancelled = true;
+}
+
+void PackingSearch::wait() {
+    std::unique_lock<std::mutex> lock(doneMutex);
+    done.wait(lock, [this]() { return activeTasks.load() == 0; });
+}
+
+bool PackingSearch::pollImprovement(LoadPlan& plan) {
+    std::lock_guard<std::mutex> lock(bestMutex);
+    if (bestVersion == polledVersion) return false;
+
+    polledVersion = bestVersion;
+    plan = bestPlan;
+    return true;
+}
+
+LoadPlan PackingSearch::best() const {
+    std::lock_guard<std::mutex> lock(bestMutex);
+    return bestPlan;
+}
+
+double PackingSearch::bestUtilisation() const {
+    long long capacity = trailer.volume();
+    return capacity > 0 ? static_cast<double>(bestVolume.load()) / static_cast<double>(capacity) : 0.0;
+}
+
+void PackingSearch::decode(const float* keys, Island& island) const {
+    size_t n = manifest.items.size();
+    ArenaScope scope(island.scratch);
+
+    uint32_t* order = island.scratch.allocate<uint32_t>(n);
+    std::iota(order, order + n, 0u);
+    // Ключи упорядочивают коробки только внутри точки разгрузки: поздние точки
+    // всегда идут первыми, иначе почти все перестановки нарушали бы LIFO
+    std::sort(order, order + n, [this, keys](uint32_t a, uint32_t b) {
+        uint16_t stopA = manifest.stopOf(a);
+        uint16_t stopB = manifest.stopOf(b);
+        if (stopA != stopB) return stopA > stopB;
+        return keys[a] < keys[b];
+    });
+
+    uint8_t* hints = island.scratch.allocate<uint8_t>(n);
+    for (size_t i = 0; i < n; i++) {
+        uint32_t item = order[i];
+        uint8_t allowed = manifest.typeOf(item).orientations;
+
+        uint8_t candidates[ORIENTATION_COUNT + 1];
+        int count = 0;
+        for (uint8_t orientation = 0; orientation < ORIENTATION_COUNT; orientation++) {
+            if ((allowed >> orientation) & 1u) candidates[count++] = orientation;
+        }
+        // Последний вариант - без предпочтения (жадный выбор поворота)
+        candidates[count++] = Packer::NO_PREFERENCE;
+
+        int pick = std::min(count - 1, static_cast<int>(keys[n + item] * count));
+        hints[i] = candidates[pick];
+    }
+
+    packer.pack(trailer, order, hints, n, island.state, island.plan, island.spareState, island.sparePlan);
+}
+
+void PackingSearch::encode(const LoadPlan& plan, std::vector<float>& keys) const {
+    // Обратное к decode: ключ порядка - место коробки в плане, ключ поворота - середина
+    // интервала ее поворота среди разрешенных. Неразмещенные коробки идут в конец.
+    size_t n = manifest.items.size();
+    keys.assign(2 * n, 1.0f);
+    float scale = 1.0f / static_cast<float>(std::max<size_t>(1, n));
+
+    size_t rank = 0;
+    for (const auto& placement : plan.placements) {
+        keys[placement.item] = static_cast<float>(rank++) * scale;
+
+        uint8_t allowed = manifest.typeOf(placement.item).orientations;
+        int index = 0, count = 1;
+        for (uint8_t orientation = 0; orientation < ORIENTATION_COUNT; orientation++) {
+            if (!((allowed >> orientation) & 1u)) continue;
+            if (orientation < placement.orientation) index++;
+            count++;
+        }
+        keys[n + placement.item] = (static_cast<float>(index) + 0.5f) / static_cast<float>(count);
+    }
+    for (uint32_t item : plan.unplaced) {
+        keys[item] = static_cast<float>(rank++) * scale;
+    }
+}
+
+bool PackingSearch::isBetter(long long fitness, double margin, long long otherFitness, double otherMargin) {
+    if (fitness != otherFitness) return fitness > otherFitness;
+    return margin > otherMargin;
+}
+
+void PackingSearch::evaluate(Individual& individual, Island& island) {
+    decode(individual.keys, island);
+    const LoadPlan& plan = island.plan;
+    individual.fitness = plan.loadedVolume();
+    individual.axleMargin = options.packer.axles.enabled ?
+        LoadBalance::fromPlan(plan, manifest).axleMargin(options.packer.axles) : 0.0;
+    offer(individual, plan);
+}
+
+void PackingSearch::offer(const Individual& individual, const LoadPlan& plan) {
+    // Быстрая проверка без блокировки - большинство решений хуже лучшего
+    if (individual.fitness < bestVolume.load(std::memory_order_relaxed)) return;
+
+    std::lock_guard<std::mutex> lock(bestMutex);
+    if (!isBetter(individual.fitness, individual.axleMargin, bestVolume.load(), bestMargin)) return;
+
+    bestPlan = plan;
+    bestKeys.assign(individual.keys, individual.keys + keyCount());
+    bestVolume = individual.fitness;
+    bestMargin = individual.axleMargin;
+    bestVersion++;
+}
+
+bool PackingSearch::shouldStop() const {
+    if (cancelled.load()) return true;
+    if (std::chrono::steady_clock::now() >= deadline) return true;
+
+    long long target = static_cast<long long>(options.targetUtilisation * static_cast<double>(trailer.volume()));
+    return bestVolume.load() >= target;
+}
+
+void PackingSearch::seedIsland(Island& island, size_t index) {
+    size_t n = manifest.items.size();
+    size_t keys = keyCount();
+    island.rngState = options.seed + index * 0x632BE59BD9B4E019ULL;
+    island.population.resize(static_cast<size_t>(std::max(4, options.populationSize)));
+    island.current = 0;
+    island.generations[0].reset();
+    island.scratch.reset();
+
+    // Смещенный старт: первая особь кодирует порядок по умолчанию, остальные -
+    // его возмущения с растущей амплитудой (как рандомизированный жадный GRASP)
+    // При теплом старте четные острова начинают с его порядка
+    ArenaScope scope(island.scratch);
+    float* baseKeys;
+    if (!warmKeys.empty() && index % 2 == 0) {
+        baseKeys = island.scratch.copy(warmKeys.data(), keys);
+    } else {
+        std::vector<uint32_t> greedyOrder = packer.defaultOrder();
+        baseKeys = island.scratch.allocate<float>(keys);
+        std::fill(baseKeys, baseKeys + keys, 1.0f);
+        for (size_t rank = 0; rank < n; rank++) {
+            baseKeys[greedyOrder[rank]] = static_cast<float>(rank) / static_cast<float>(std::max<size_t>(1, n));
+        }
+    }
+
+    // Ключи выделяются сразу для всей популяции, чтобы при досрочной остановке
+    // у каждой особи был валидный массив
+    for (Individual& individual : island.population) {
+        individual = Individual();
+        individual.keys = island.generations[0].allocate<float>(keys);
+        std::fill(individual.keys, individual.keys + keys, 1.0f);
+    }
+
+    for (size_t p = 0; p < island.population.size(); p++) {
+        Individual& individual = island.population[p];
+        float noise = static_cast<float>(p) / static_cast<float>(island.population.size());
+        perturb(baseKeys, noise, island.rngState, individual.keys);
+
+        if (shouldStop()) return;
+        evaluate(individual, island);
+    }
+}
+
+void PackingSearch::perturb(const float* source, float amplitude, uint64_t& rng, float* result) const {
+    size_t n = manifest.items.size();
+
+    for (size_t i = 0; i < n; i++) {
+        result[i] = source[i] + amplitude * (randomUnit(rng) - 0.5f);
+    }
+    // Поворот меняется с вероятностью, равной амплитуде
+    for (size_t i = n; i < 2 * n; i++) {
+        result[i] = randomUnit(rng) < amplitude ? randomUnit(rng) : source[i];
+    }
+}
+
+void PackingSearch::evolve(Island& island) {
+    auto& population = island.population;
+    size_t size = population.size();
+    size_t eliteCount = std::max<size_t>(1, static_cast<size_t>(size * options.eliteFraction));
+    size_t mutantCount = static_cast<size_t>(size * options.mutantFraction);
+
+    std::sort(population.begin(), population.end(), [](const Individual& a, const Individual& b) {
+        return isBetter(a.fitness, a.axleMargin, b.fitness, b.axleMargin);
+    });
+
+    // Следующее поколение собирается во второй арене; старая арена освобождается
+    // целиком при следующей смене поколений
+    Arena& arena = island.generations[1 - island.current];
+    arena.reset();
+    size_t keyCount = this->keyCount();
+
+    auto& next = island.next;
+    next.clear();
+    for (size_t i = 0; i < eliteCount; i++) {
+        Individual elite = population[i];
+        elite.keys = arena.copy(population[i].keys, keyCount);
+        next.push_back(elite);
+    }
+
+    while (next.size() < size) {
+        Individual child;
+        child.keys = arena.allocate<float>(keyCount);
+
+        if (next.size() < eliteCount + mutantCount) {
+            // Мутанты - возмущения лучшей особи острова
+            perturb(population[0].keys, randomUnit(island.rngState), island.rngState, child.keys);
+        } else {
+            const Individual& elite = population[nextRandom(island.rngState) % eliteCount];
+            const Individual& other = population[eliteCount + nextRandom(island.rngState) % (size - eliteCount)];
+            for (size_t k = 0; k < keyCount; k++) {
+                child.keys[k] = randomUnit(island.rngState) < options.eliteBias ? elite.keys[k] : other.keys[k];
+            }
+        }
+
+        evaluate(child, island);
+        next.push_back(child);
+        if (shouldStop()) break;
+    }
+
+    // При досрочной остановке дополняем популяцию старыми особями
+    for (size_t i = next.size(); i < size; i++) {
+        Individual old = population[i];
+        old.keys = arena.copy(population[i].keys, keyCount);
+        next.push_back(old);
+    }
+    population.swap(next);
+    island.current = 1 - island.current;
+}
+
+void PackingSearch::runEpoch(size_t islandIndex) {
+    Island& island = islands[islandIndex];
+
+    if (!shouldStop() && !island.population.empty()) {
+        // Миграция: глобально лучшая особь заменяет худшую на острове
+        {
+            std::lock_guard<std::mutex> lock(bestMutex);
+            if (!bestKeys.empty()) {
+                auto worst = std::min_element(island.population.begin(), island.population.end(),
+                    [](const Individual& a, const Individual& b) {
+                        return isBetter(b.fitness, b.axleMargin, a.fitness, a.axleMargin);
+                    });
+                if (isBetter(bestVolume.load(), bestMargin, worst->fitness, worst->axleMargin)) {
+                    std::copy(bestKeys.begin(), bestKeys.end(), worst->keys);
+                    worst->fitness = bestVolume.load();
+                    worst->axleMargin = bestMargin;
+                }
+            }
+        }
+
+        for (int generation = 0; generation < options.generationsPerEpoch && !shouldStop(); generation++) {
+            evolve(island);
+        }
+    }
+
+    if (shouldStop()) {
+        finishTask();
+        return;
+    }
+
+    // Перезапуск через пул: свободные потоки могут перехватить эпоху
+    pool.submit([this, islandIndex]() { runEpoch(islandIndex); });
+}
+
+void PackingSearch::finishTask() {
+    // Под мьютексом, чтобы wait() не вернулся (и не разрушил объект) до notify
+    std::lock_guard<std::mutex> lock(doneMutex);
+    if (activeTasks.fetch_sub(1) == 1) {
+        done.notify_all();
+    }
+}
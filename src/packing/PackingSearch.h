@@ -0,0 +1,129 @@
+#ifndef PACKINGSEARCH_H
+#define PACKINGSEARCH_H
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "Arena.h"
+#include "Cargo.h"
+#include "LoadPlan.h"
+#include "Packer.h"
+#include "ThreadPool.h"
+
+struct SearchOptions {
+    int timeBudgetMs = 3000;
+    double targetUtilisation = 1.0;     // Остановка при достижении этой доли объема
+
+    // Biased random-key genetic algorithm
+    int populationSize = 48;
+    float eliteFraction = 0.2f;
+    float mutantFraction = 0.15f;
+    float eliteBias = 0.7f;             // Вероятность взять ген от элитного родителя
+    int generationsPerEpoch = 4;        // Поколений в одной задаче пула
+    int islands = 0;                    // 0 -> по числу потоков пула
+
+    uint64_t seed = 0x5EED5EEDULL;
+    PackerOptions packer;
+};
+
+// Параллельный многостартовый поиск (BRKGA с островами).
+// Каждый остров - независимая популяция; одна задача пула выполняет эпоху из
+// нескольких поколений и перезапускает сама себя, пока не выйдет время.
+// Лучшее решение общее для всех островов и периодически подселяется в их элиту.
+class PackingSearch {
+private:
+    struct Individual {
+        float* keys = nullptr;          // n ключей порядка + n ключей поворота в арене поколения
+        long long fitness = -1;         // Загруженный объем
+        double axleMargin = 0.0;        // Вторичный критерий при равном объеме
+    };
+
+    // Остров вместе с рабочим местом исполнителя. Эпохи острова выполняются
+    // по одной, поэтому его арены и состояние упаковщика в каждый момент
+    // принадлежат одному потоку пула, и поиск не обращается к общей куче.
+    struct Island {
+        std::vector<Individual> population;
+        std::vector<Individual> next;
+        Arena generations[2];           // Ключи текущего и следующего поколения
+        int current = 0;
+        Arena scratch;                  // Временные массивы декодирования
+        PackState state{TrailerSpec()};
+        LoadPlan plan;                  // Последнее декодированное решение
+        PackState spareState{TrailerSpec()};
+        LoadPlan sparePlan;             // Второй проход упаковщика для цилиндров
+        uint64_t rngState = 0;
+    };
+
+    Manifest manifest;                  // Копия: UI может менять свой манифест во время поиска
+    TrailerSpec trailer;
+    ThreadPool& pool;
+    SearchOptions options;
+    Packer packer;
+
+    std::vector<Island> islands;
+    LoadPlan warmPlan;
+    std::vector<float> warmKeys;
+    std::chrono::steady_clock::time_point deadline;
+
+    // Общий лучший результат
+    mutable std::mutex bestMutex;
+    LoadPlan bestPlan;
+    std::vector<float> bestKeys;
+    std::atomic<long long> bestVolume{-1};
+    double bestMargin = 0.0;
+    uint64_t bestVersion = 0;
+    uint64_t polledVersion = 0;
+
+    std::atomic<bool> cancelled{false};
+    std::atomic<int> activeTasks{0};
+    std::mutex doneMutex;
+    std::condition_variable done;
+
+    static bool isBetter(long long fitness, double margin, long long otherFitness, double otherMargin);
+
+    size_t keyCount() const { return 2 * manifest.items.size(); }
+
+    // Решение по ключам - в island.plan
+    void decode(const float* keys, Island& island) const;
+    void evaluate(Individual& individual, Island& island);
+    void offer(const Individual& individual, const LoadPlan& plan);
+    bool shouldStop() const;
+
+    void encode(const LoadPlan& plan, std::vector<float>& keys) const;
+    void perturb(const float* source, float amplitude, uint64_t& rng, float* result) const;
+    void seedIsland(Island& island, size_t index);
+    void evolve(Island& island);
+    void runEpoch(size_t islandIndex);
+    void finishTask();
+
+public:
+    PackingSearch(const Manifest& manifest, const TrailerSpec& trailer, ThreadPool& pool,
+                  const SearchOptions& options = SearchOptions());
+    ~PackingSearch();
+
+    PackingSearch(const PackingSearch&) = delete;
+    PackingSearch& operator=(const PackingSearch&) = delete;
+
+    // Теплый старт от готового плана (например, из кэша): он становится первым лучшим
+    // решением, а половина островов стартует с его порядка. Вызывать до start().
+    void setWarmStart(const LoadPlan& plan);
+
+    // Запускает поиск асинхронно на пуле
+    void start();
+    void cancel();
+    void wait();
+    bool isRunning() const { return activeTasks.load() > 0; }
+
+    // Для UI-потока: true, если с прошлого вызова нашлось лучшее решение
+    bool pollImprovement(LoadPlan& plan);
+
+    LoadPlan best() const;
+    double bestUtilisation() const;
+};
+
+#endif //PACKINGSEARCH_H
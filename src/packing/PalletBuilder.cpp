@@ -0,0 +1,302 @@
+#include "PalletBuilder.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+// Очередь готовых поддонов одной точки разгрузки: один производитель, один потребитель
+class PalletChannel {
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<BuiltPallet> pallets;
+    bool closed = false;
+
+public:
+    void push(BuiltPallet&& pallet) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pallets.push_back(std::move(pallet));
+        }
+        ready.notify_one();
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        ready.notify_one();
+    }
+
+    // false - поддонов больше не будет
+    bool pop(BuiltPallet& pallet) {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [this]() { return !pallets.empty() || closed; });
+        if (pallets.empty()) return false;
+
+        pallet = std::move(pallets.front());
+        pallets.pop_front();
+        return true;
+    }
+};
+
+// Закрывает канал при любом выходе из производителя, в том числе по исключению:
+// иначе потребитель навсегда останется в pop
+class ChannelCloser {
+private:
+    PalletChannel& channel;
+
+public:
+    explicit ChannelCloser(PalletChannel& channel) : channel(channel) {}
+    ~ChannelCloser() { channel.close(); }
+
+    ChannelCloser(const ChannelCloser&) = delete;
+    ChannelCloser& operator=(const ChannelCloser&) = delete;
+};
+
+// Сумма требований класса ко всем остальным: чем больше, тем строже класс
+int strictness(const SegregationRules& rules, uint8_t cls) {
+    int total = 0;
+    for (size_t other = 0; other < COMPATIBILITY_CLASS_COUNT; other++) {
+        total += static_cast<int>(rules.levelFor(cls, static_cast<uint8_t>(other)));
+    }
+    return total;
+}
+
+} // namespace
+
+PalletSpec PalletSpec::euro() {
+    PalletSpec spec;
+    spec.name = "EUR";
+    spec.width = 120;
+    spec.depth = 80;
+    spec.deckHeight = 15;
+    spec.deckWeight = 25.0f;
+    return spec;
+}
+
+PalletSpec PalletSpec::us() {
+    PalletSpec spec;
+    spec.name = "US";
+    spec.width = 122;
+    spec.depth = 102;
+    spec.deckHeight = 14;
+    spec.deckWeight = 20.0f;
+    return spec;
+}
+
+size_t PalletizedPlan::cartonCount() const {
+    size_t count = unpalletised.size();
+    for (const auto& pallet : built) {
+        count += pallet.cartons.placements.size();
+    }
+    return count;
+}
+
+size_t PalletizedPlan::loadedCartonCount() const {
+    size_t count = 0;
+    for (const auto& placement : trailerPlan.placements) {
+        count += built[placement.item].cartons.placements.size();
+    }
+    return count;
+}
+
+void PalletizedPlan::clear() {
+    pallets.clear();
+    built.clear();
+    trailerPlan.clear();
+    unpalletised.clear();
+}
+
+PalletBuilder::PalletBuilder(const Manifest& cartons, const PalletOptions& options, ThreadPool& pool)
+    : cartons(cartons), options(options), pool(pool) {
+}
+
+bool PalletBuilder::buildNext(std::vector<uint32_t>& remaining, size_t first, BuiltPallet& pallet) const {
+    Packer packer(cartons, options.cartons);
+    bool found = false;
+    double bestFill = 0.0;
+    const uint32_t* order = remaining.data() + first;
+    size_t count = remaining.size() - first;
+    PackState state{TrailerSpec()}, spareState{TrailerSpec()};
+    LoadPlan spare;
+    std::vector<uint32_t> leftovers;
+    std::vector<uint8_t> failedTypes;
+
+    // Пробуем все типы поддонов, берем самый плотно заполненный
+    for (size_t s = 0; s < options.specs.size(); s++) {
+        const PalletSpec& spec = options.specs[s];
+        TrailerSpec space{spec.width, spec.maxHeight - spec.deckHeight, spec.depth};
+        if (space.height <= 0) continue;
+
+        LoadPlan plan;
+        packer.pack(space, order, nullptr, count, state, plan, spareState, spare);
+
+        // Перегруз снимаем с конца порядка укладки: опоры оставшихся коробок не затрагиваются
+        float weight = 0.0f;
+        for (const auto& placement : plan.placements) {
+            weight += cartons.typeOf(placement.item).weight;
+        }
+        bool trimmed = false, inSync = true;
+        while (weight > spec.maxWeight && !plan.placements.empty()) {
+            uint32_t item = plan.placements.back().item;
+            const BoxType& type = cartons.typeOf(item);
+            // Состояние упаковщика снимает те же коробки, пока это не блок цилиндров
+            inSync = inSync && state.removeLast(type, cartons.stopOf(item));
+            weight -= type.weight;
+            plan.unplaced.push_back(item);
+            plan.placements.pop_back();
+            trimmed = true;
+        }
+        if (trimmed && inSync) {
+            // Освободившийся объем добираем более легкими коробками из остатка.
+            // Место только убывает, поэтому тип, который не встал, дальше не пробуем
+            packer.toSceneFrame(plan);
+            leftovers.swap(plan.unplaced);
+            plan.unplaced.clear();
+            failedTypes.assign(cartons.types.size(), 0);
+            for (uint32_t item : leftovers) {
+                uint32_t typeIndex = cartons.items[item];
+                const BoxType& type = cartons.types[typeIndex];
+                if (failedTypes[typeIndex] || weight + type.weight > spec.maxWeight) {
+                    plan.unplaced.push_back(item);
+                } else if (packer.placeItem(state, item, plan)) {
+                    weight += type.weight;
+                } else {
+                    failedTypes[typeIndex] = 1;
+                }
+            }
+            packer.toSceneFrame(plan);
+        }
+        if (plan.placements.empty()) continue;
+
+        double fill = plan.utilisation();
+        if (!found || fill > bestFill) {
+            found = true;
+            bestFill = fill;
+            pallet.spec = s;
+            pallet.weight = weight + spec.deckWeight;
+            pallet.cartons = std::move(plan);
+        }
+    }
+    if (!found) return false;
+
+    remaining = std::move(pallet.cartons.unplaced);
+    pallet.cartons.unplaced.clear();
+    packer.sortByDefaultOrder(remaining);
+    return true;
+}
+
+BoxType PalletBuilder::palletType(const BuiltPallet& pallet) const {
+    const PalletSpec& spec = options.specs[pallet.spec];
+
+    int cargoHeight = 0;
+    for (const auto& placement : pallet.cartons.placements) {
+        cargoHeight = std::max(cargoHeight, placement.maxY());
+    }
+
+    // Поддон наследует самый строгий класс своих коробок: для прицепа он один груз
+    uint8_t cls = 0;
+    const SegregationRules* rules = options.trailer.segregation.get();
+    for (const auto& placement : pallet.cartons.placements) {
+        uint8_t cartonClass = cartons.typeOf(placement.item).compatibilityClass;
+        if (cartonClass == 0 || cartonClass == cls) continue;
+        if (cls == 0 || (rules && strictness(*rules, cartonClass) > strictness(*rules, cls))) cls = cartonClass;
+    }
+
+    BoxType type;
+    type.sku = spec.name;
+    type.width = spec.width;
+    type.height = spec.deckHeight + cargoHeight;
+    type.depth = spec.depth;
+    type.weight = pallet.weight;
+    // Поддон не кладут на бок: только поворот вокруг вертикали
+    type.orientations = (1u << ORIENT_WHD) | (1u << ORIENT_DHW);
+    type.maxStackLoad = options.stackable ? options.maxStackLoad : 0.0f;
+    type.minSupport = 1.0f;
+    type.compatibilityClass = cls;
+    return type;
+}
+
+PalletizedPlan PalletBuilder::build(const TrailerSpec& trailer) const {
+    PalletizedPlan result;
+    result.trailerPlan.trailer = trailer;
+    if (cartons.empty()) return result;
+
+    // Коробки по точкам разгрузки, внутри точки - в порядке по умолчанию
+    size_t stopCount = cartons.stopCount();
+    std::vector<std::vector<uint32_t>> groups(stopCount);
+    for (uint32_t item : Packer(cartons).defaultOrder()) {
+        groups[cartons.stopOf(item)].push_back(item);
+    }
+
+    // Первая стадия: по производителю на точку, поддоны внутри точки собираются
+    // последовательно, потому что каждый следующий зависит от остатка
+    std::vector<std::unique_ptr<PalletChannel>> channels(stopCount);
+    std::vector<std::vector<uint32_t>> rejected(stopCount);
+    std::vector<std::future<void>> producers;
+    for (size_t stop = 0; stop < stopCount; stop++) {
+        channels[stop] = std::make_unique<PalletChannel>();
+        if (groups[stop].empty()) {
+            channels[stop]->close();
+            continue;
+        }
+
+        producers.push_back(pool.async([this, stop, &groups, &channels, &rejected]() {
+            ChannelCloser closer(*channels[stop]);
+            std::vector<uint32_t>& remaining = groups[stop];
+            // Отвергнутые коробки пропускаются курсором, а не стираются из начала
+            size_t first = 0;
+            while (first < remaining.size()) {
+                BuiltPallet pallet;
+                if (!buildNext(remaining, first, pallet)) {
+                    // Первая коробка не встает ни на один поддон
+                    rejected[stop].push_back(remaining[first++]);
+                    continue;
+                }
+                first = 0;
+                pallet.stop = static_cast<uint16_t>(stop);
+                channels[stop]->push(std::move(pallet));
+            }
+        }));
+    }
+
+    // Вторая стадия в этом потоке: поддоны ставятся в прицеп по мере готовности
+    Packer packer(result.pallets, options.trailer);
+    PackState state = packer.createState(trailer, stopCount);
+
+    try {
+        for (size_t s = stopCount; s-- > 0;) {
+            BuiltPallet pallet;
+            while (channels[s]->pop(pallet)) {
+                uint32_t type = result.pallets.addType(palletType(pallet));
+                result.pallets.addItems(type, 1, pallet.stop);
+                result.built.push_back(std::move(pallet));
+
+                packer.placeItem(state, static_cast<uint32_t>(result.pallets.items.size() - 1), result.trailerPlan);
+            }
+        }
+    } catch (...) {
+        // Производители ссылаются на локальные очереди - дожидаемся их до выхода
+        for (auto& producer : producers) {
+            producer.wait();
+        }
+        throw;
+    }
+
+    // Все каналы закрыты и выбраны; ошибка производителя пробрасывается здесь
+    for (auto& producer : producers) {
+        producer.get();
+    }
+    packer.toSceneFrame(result.trailerPlan);
+
+    for (const auto& items : rejected) {
+        result.unpalletised.insert(result.unpalletised.end(), items.begin(), items.end());
+    }
+    return result;
+}
@@ -0,0 +1,82 @@
+#ifndef PALLETBUILDER_H
+#define PALLETBUILDER_H
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Cargo.h"
+#include "LoadPlan.h"
+#include "Packer.h"
+#include "ThreadPool.h"
+
+// Стандартный поддон. width - вдоль x, depth - вдоль z, как у прицепа.
+struct PalletSpec {
+    std::string name;
+    int width = 120;
+    int depth = 80;
+    int deckHeight = 15;        // Высота самого поддона
+    int maxHeight = 180;        // Общая высота с грузом
+    float deckWeight = 25.0f;
+    float maxWeight = 1000.0f;  // Масса груза на поддоне
+
+    static PalletSpec euro();   // EUR 1200 x 800
+    static PalletSpec us();     // GMA 48" x 40"
+};
+
+struct PalletOptions {
+    std::vector<PalletSpec> specs = {PalletSpec::euro(), PalletSpec::us()};
+
+    // Можно ли ставить поддоны друг на друга в прицепе
+    bool stackable = false;
+    float maxStackLoad = 1000.0f;
+
+    PackerOptions cartons;      // Укладка коробок на поддон
+    PackerOptions trailer;      // Укладка поддонов в прицеп
+};
+
+// Собранный поддон: коробки в координатах над настилом (x вдоль PalletSpec::width)
+struct BuiltPallet {
+    size_t spec = 0;
+    uint16_t stop = 0;
+    LoadPlan cartons;
+    float weight = 0.0f;        // Вместе с поддоном
+};
+
+struct PalletizedPlan {
+    Manifest pallets;                   // Поддоны как коробки для прицепа
+    std::vector<BuiltPallet> built;     // built[i] - содержимое pallets.items[i]
+    LoadPlan trailerPlan;               // Индексы item - в pallets
+    std::vector<uint32_t> unpalletised; // Коробки, не помещающиеся ни на один поддон
+
+    size_t cartonCount() const;
+    size_t loadedCartonCount() const;
+    bool empty() const { return built.empty(); }
+    void clear();
+};
+
+// Двухуровневая упаковка: коробки -> поддоны -> прицеп.
+// Поддоны каждой точки разгрузки собираются отдельной задачей пула, а вызывающий
+// поток сразу ставит в прицеп каждый готовый поддон, не дожидаясь остальных.
+// Точки обрабатываются от последней к первой, как в Packer::defaultOrder.
+class PalletBuilder {
+private:
+    const Manifest& cartons;
+    PalletOptions options;
+    ThreadPool& pool;
+
+    // Собирает один поддон из remaining[first..]; при успехе remaining заменяется
+    // остатком этого диапазона в порядке по умолчанию
+    bool buildNext(std::vector<uint32_t>& remaining, size_t first, BuiltPallet& pallet) const;
+    BoxType palletType(const BuiltPallet& pallet) const;
+
+public:
+    PalletBuilder(const Manifest& cartons, const PalletOptions& options, ThreadPool& pool);
+
+    // Блокирует вызывающий поток; нельзя вызывать из потока пула
+    PalletizedPlan build(const TrailerSpec& trailer) const;
+
+    const PalletOptions& getOptions() const { return options; }
+};
+
+#endif //PALLETBUILDER_H
@@ -0,0 +1,64 @@
+#include "PresetComparison.h"
+#include <chrono>
+#include <exception>
+#include "LoadBalance.h"
+
+PresetComparison::PresetComparison(const Manifest& manifest, std::vector<ComparisonCandidate> candidates,
+                                   ThreadPool& pool)
+    : job(std::make_shared<Job>()) {
+    job->manifest = manifest;
+    job->candidates = std::move(candidates);
+    results.resize(job->candidates.size());
+    pending.reserve(job->candidates.size());
+    for (size_t i = 0; i < job->candidates.size(); i++) {
+        pending.push_back(pool.async([job = job, i]() { return solve(*job, i); }));
+    }
+}
+
+PresetComparison::~PresetComparison() {
+    // Не ждем: задачи держат job сами, а будущие от пула в деструкторе не блокируют
+    job->stopped = true;
+}
+
+ComparisonResult PresetComparison::solve(const Job& job, size_t index) {
+    ComparisonResult result;
+    if (job.stopped) return result;
+
+    const ComparisonCandidate& candidate = job.candidates[index];
+    auto start = std::chrono::steady_clock::now();
+    Packer packer(job.manifest, candidate.packer);
+    result.plan = packer.pack(candidate.trailer);
+    result.solveMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    result.utilisation = result.plan.utilisation();
+    result.leftover = result.plan.unplaced.size();
+    result.axlesChecked = candidate.packer.axles.enabled;
+    if (result.axlesChecked) {
+        result.axleMargin = LoadBalance::fromPlan(result.plan, job.manifest).axleMargin(candidate.packer.axles);
+    }
+    result.ready = true;
+    return result;
+}
+
+bool PresetComparison::poll() {
+    bool changed = false;
+    for (size_t i = 0; i < pending.size(); i++) {
+        std::future<ComparisonResult>& task = pending[i];
+        if (!task.valid() || task.wait_for(std::chrono::seconds(0)) != std::future_status::ready) continue;
+
+        // Ошибка одного варианта остается в его строке, остальные показываются
+        try {
+            results[i] = task.get();
+        } catch (const std::exception& e) {
+            results[i] = ComparisonResult();
+            results[i].error = e.what();
+        } catch (...) {
+            results[i] = ComparisonResult();
+            results[i].error = "unknown error";
+        }
+        results[i].ready = true;
+        readyCount++;
+        changed = true;
+    }
+    return changed;
+}
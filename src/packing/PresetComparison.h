@@ -0,0 +1,76 @@
+#ifndef PRESETCOMPARISON_H
+#define PRESETCOMPARISON_H
+
+#pragma once
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Cargo.h"
+#include "LoadPlan.h"
+#include "Packer.h"
+#include "ThreadPool.h"
+
+// Вариант прицепа для сравнения
+struct ComparisonCandidate {
+    std::string name;
+    TrailerSpec trailer;
+    PackerOptions packer;       // Опоры и дверь зависят от длины прицепа
+};
+
+// Готовый план варианта и его показатели для таблицы
+struct ComparisonResult {
+    bool ready = false;
+    LoadPlan plan;              // В системе сцены, как из Packer::pack
+    double utilisation = 0.0;
+    size_t leftover = 0;        // Коробок, которые не поместились
+    bool axlesChecked = false;  // false - у варианта нет ограничений по осям
+    double axleMargin = 0.0;    // См. LoadBalance::axleMargin
+    double solveMs = 0.0;
+    std::string error;          // Не пусто - упаковка варианта завершилась ошибкой, plan пуст
+};
+
+// Сравнение "что если": манифест упаковывается в каждый вариант отдельной
+// задачей пула. Ни конструктор, ни деструктор не блокируют - UI-поток забирает
+// готовые результаты через poll() и может показать любой из них без пересчета.
+// Задачи владеют копией данных вместе с объектом: после разрушения объекта
+// еще не начатые варианты пропускаются, начатые дорабатывают в фоне.
+class PresetComparison {
+private:
+    // Общие с задачами данные: копия манифеста (UI может открыть другой, пока задачи идут)
+    struct Job {
+        Manifest manifest;
+        std::vector<ComparisonCandidate> candidates;
+        std::atomic<bool> stopped{false};
+    };
+
+    std::shared_ptr<Job> job;
+    std::vector<ComparisonResult> results;
+    std::vector<std::future<ComparisonResult>> pending;
+    size_t readyCount = 0;
+
+    // Бросает, если упаковка не удалась; после остановки возвращает пустой результат
+    static ComparisonResult solve(const Job& job, size_t index);
+
+public:
+    PresetComparison(const Manifest& manifest, std::vector<ComparisonCandidate> candidates, ThreadPool& pool);
+    ~PresetComparison();
+
+    PresetComparison(const PresetComparison&) = delete;
+    PresetComparison& operator=(const PresetComparison&) = delete;
+
+    // Для UI-потока: переносит готовые результаты, true - появились новые.
+    // Ошибка упаковки варианта попадает в его ComparisonResult::error
+    bool poll();
+    bool isRunning() const { return readyCount < job->candidates.size(); }
+
+    size_t size() const { return job->candidates.size(); }
+    size_t finished() const { return readyCount; }
+    const ComparisonCandidate& getCandidate(size_t index) const { return job->candidates[index]; }
+    // results[i] относится к getCandidate(i); ready == false - еще считается
+    const ComparisonResult& getResult(size_t index) const { return results[index]; }
+};
+
+#endif //PRESETCOMPARISON_H
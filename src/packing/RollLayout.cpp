@@ -0,0 +1,303 @@
+#include "RollLayout.h"
+#include "Simd.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Наименьший шаг между рядами, при котором круги диаметра diameter,
+// сдвинутые на offset вдоль ряда, не пересекаются. Ближайший сосед в соседнем
+// ряду - на min(offset, diameter - offset) вдоль ряда
+int rowPitch(int diameter, int offset) {
+    long long along = std::min(offset, diameter - offset);
+    long long need = static_cast<long long>(diameter) * diameter - along * along;
+    int pitch = static_cast<int>(std::sqrt(static_cast<double>(std::max(0LL, need))));
+    while (static_cast<long long>(pitch) * pitch < need) pitch++;
+    return pitch;
+}
+
+bool clearOfScalar(const int* centersX2, const int* centersZ2, size_t count, int x2, int z2, int diameter) {
+    // Удвоенные координаты: расстояние между центрами не меньше диаметра
+    // <=> квадрат удвоенного расстояния не меньше (2 * diameter)^2
+    int limit = 4 * diameter * diameter;
+    for (size_t i = 0; i < count; i++) {
+        int dx = centersX2[i] - x2;
+        int dz = centersZ2[i] - z2;
+        if (dx * dx + dz * dz < limit) return false;
+    }
+    return true;
+}
+
+#if PACKING_SIMD_X86
+PACKING_TARGET_AVX2 bool clearOfAVX2(const int* centersX2, const int* centersZ2, size_t count, int x2, int z2,
+                                     int diameter) {
+    const __m256i vx = _mm256_set1_epi32(x2);
+    const __m256i vz = _mm256_set1_epi32(z2);
+    const __m256i limit = _mm256_set1_epi32(4 * diameter * diameter);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i dx = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(centersX2 + i)), vx);
+        __m256i dz = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(centersZ2 + i)), vz);
+        __m256i distance = _mm256_add_epi32(_mm256_mullo_epi32(dx, dx), _mm256_mullo_epi32(dz, dz));
+        if (!_mm256_testz_si256(_mm256_cmpgt_epi32(limit, distance), _mm256_set1_epi32(-1))) return false;
+    }
+    return clearOfScalar(centersX2 + i, centersZ2 + i, count - i, x2, z2, diameter);
+}
+#endif
+
+// Укладка слотов блока с проверкой кругов одной плоскости: остальные
+// плоскости раскладки повторяют ее, поэтому проверяется только первая
+class SlotWriter {
+private:
+    RollBlock& block;
+    size_t remaining;
+    int diameter;
+    std::vector<int> planeU, planeV;
+
+public:
+    SlotWriter(RollBlock& block, size_t count, int diameter) : block(block), remaining(count), diameter(diameter) {}
+
+    bool full() const { return remaining == 0; }
+
+    // (u, v) - угол габарита круга в проверяемой плоскости
+    bool add(const Placement& slot, bool checked, int u, int v) {
+        if (checked) {
+            int u2 = 2 * u + diameter;
+            int v2 = 2 * v + diameter;
+            if (!rolls::clearOf(planeU.data(), planeV.data(), planeU.size(), u2, v2, diameter)) return false;
+            planeU.push_back(u2);
+            planeV.push_back(v2);
+        }
+        block.slots.push_back(slot);
+        remaining--;
+        return true;
+    }
+};
+
+Placement makeSlot(uint8_t orientation, int x, int y, int z, int width, int height, int depth) {
+    Placement slot;
+    slot.item = 0;
+    slot.x = x;
+    slot.y = y;
+    slot.z = z;
+    slot.width = width;
+    slot.height = height;
+    slot.depth = depth;
+    slot.orientation = orientation;
+    return slot;
+}
+
+// Стоя на торце: ряды поперек кузова (вдоль z) идут от передней стенки,
+// внутри ряда - слой за слоем, так что неполный ряд стоит на полных
+bool buildUpright(const BoxType& type, bool hex, size_t count, const FreeSpaceIndex::Extent& limit, RollBlock& block) {
+    int length = type.height;
+    int diameter = type.width;
+    int layers = std::min(limit.height / length, rolls::stackLayers(type));
+    if (layers <= 0 || diameter > limit.depth || diameter > limit.width) return false;
+
+    int offset = hex ? (diameter + 1) / 2 : 0;
+    int pitch = hex ? rowPitch(diameter, offset) : diameter;
+    int evenRow = limit.depth / diameter;
+    int oddRow = (limit.depth - offset) / diameter;
+    if (oddRow == 0) return false;
+
+    SlotWriter writer(block, count, diameter);
+    for (int row = 0; !writer.full() && row * pitch + diameter <= limit.width; row++) {
+        int x = row * pitch;
+        int shift = row % 2 ? offset : 0;
+        int perRow = row % 2 ? oddRow : evenRow;
+        for (int layer = 0; layer < layers && !writer.full(); layer++) {
+            for (int j = 0; j < perRow && !writer.full(); j++) {
+                int z = shift + j * diameter;
+                Placement slot = makeSlot(block.orientation, x, layer * length, z, diameter, length, diameter);
+                if (!writer.add(slot, layer == 0, x, z)) return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Лежачие слои: в ложбинах (nested) нечетные слои на один цилиндр короче и
+// сдвинуты на полдиаметра, иначе цилиндры стоят точно друг над другом
+struct LyingRows {
+    bool nested;
+    int diameter, offset, pitch;
+
+    LyingRows(int diameter, bool nested)
+        : nested(nested), diameter(diameter), offset(nested ? (diameter + 1) / 2 : 0),
+          pitch(nested ? rowPitch(diameter, offset) : diameter) {}
+
+    int layers(const BoxType& type, int across, int height) const {
+        if (diameter > height) return 0;
+        if (nested && across < 2) return 1;
+        return std::min(1 + (height - diameter) / pitch, rolls::stackLayers(type));
+    }
+    int row(int across, int layer) const { return nested && layer % 2 ? across - 1 : across; }
+    int shift(int layer) const { return layer % 2 ? offset : 0; }
+};
+
+// Лежа осью вдоль x: поперечные срезы длиной в цилиндр от передней стенки
+bool buildLyingX(const BoxType& type, bool nested, size_t count, const FreeSpaceIndex::Extent& limit,
+                 RollBlock& block) {
+    int length = type.height;
+    int diameter = type.width;
+    int across = limit.depth / diameter;
+    if (across == 0 || length > limit.width) return false;
+
+    LyingRows rows(diameter, nested);
+    int layers = rows.layers(type, across, limit.height);
+    if (layers <= 0) return false;
+
+    SlotWriter writer(block, count, diameter);
+    for (int slice = 0; !writer.full() && (slice + 1) * length <= limit.width; slice++) {
+        for (int layer = 0; layer < layers && !writer.full(); layer++) {
+            for (int j = 0; j < rows.row(across, layer) && !writer.full(); j++) {
+                int y = layer * rows.pitch;
+                int z = rows.shift(layer) + j * diameter;
+                Placement slot = makeSlot(block.orientation, slice * length, y, z, length, diameter, diameter);
+                if (!writer.add(slot, slice == 0, z, y)) return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Лежа осью поперек кузова: дорожки длиной в цилиндр вдоль z, в каждой -
+// ряды в плоскости x-y. Ширина блока по x - наименьшая, вмещающая count
+bool buildLyingZ(const BoxType& type, bool nested, size_t count, const FreeSpaceIndex::Extent& limit,
+                 RollBlock& block) {
+    int length = type.height;
+    int diameter = type.width;
+    int lanes = limit.depth / length;
+    int widest = limit.width / diameter;
+    if (lanes == 0 || widest == 0) return false;
+
+    LyingRows rows(diameter, nested);
+    int across = 1;
+    int layers = 0;
+    for (; across <= widest; across++) {
+        layers = rows.layers(type, across, limit.height);
+        size_t capacity = 0;
+        for (int layer = 0; layer < layers; layer++) {
+            capacity += static_cast<size_t>(rows.row(across, layer)) * static_cast<size_t>(lanes);
+        }
+        if (capacity >= count || across == widest) break;
+    }
+    if (layers <= 0) return false;
+
+    SlotWriter writer(block, count, diameter);
+    for (int layer = 0; layer < layers && !writer.full(); layer++) {
+        for (int lane = 0; lane < lanes && !writer.full(); lane++) {
+            for (int j = 0; j < rows.row(across, layer) && !writer.full(); j++) {
+                int x = rows.shift(layer) + j * diameter;
+                int y = layer * rows.pitch;
+                Placement slot = makeSlot(block.orientation, x, y, lane * length, diameter, diameter, length);
+                if (!writer.add(slot, lane == 0, x, y)) return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+double RollBlock::density() const {
+    long long total = static_cast<long long>(size.width) * size.height * size.depth;
+    if (total <= 0) return 0.0;
+    long long used = 0;
+    for (const auto& slot : slots) used += slot.volume();
+    return static_cast<double>(used) / static_cast<double>(total);
+}
+
+void RollBlock::clear() {
+    size = {0, 0, 0};
+    slots.clear();
+    topX.clear();
+    topZ.clear();
+    radius = 0.0f;
+    flatTop = false;
+    layers = 0;
+}
+
+namespace rolls {
+
+uint8_t orientationFor(const BoxType& type, RollPattern pattern) {
+    int axis = 1;
+    if (pattern == RollPattern::LyingXNested || pattern == RollPattern::LyingXGrid) axis = 0;
+    if (pattern == RollPattern::LyingZNested || pattern == RollPattern::LyingZGrid) axis = 2;
+    for (uint8_t orientation = 0; orientation < ORIENTATION_COUNT; orientation++) {
+        if (type.allows(orientation) && BoxType::cylinderAxis(orientation) == axis) return orientation;
+    }
+    return ORIENTATION_COUNT;
+}
+
+bool packable(const BoxType& type) {
+    if (!type.isCylinder() || type.width != type.depth || type.width <= 0 || type.height <= 0) return false;
+    for (size_t pattern = 0; pattern < ROLL_PATTERN_COUNT; pattern++) {
+        if (orientationFor(type, static_cast<RollPattern>(pattern)) != ORIENTATION_COUNT) return true;
+    }
+    return false;
+}
+
+int stackLayers(const BoxType& type) {
+    constexpr int UNLIMITED = 1 << 20;
+    if (type.maxStackLoad < 0.0f || type.weight <= 0.0f) return UNLIMITED;
+    return 1 + static_cast<int>(std::min(static_cast<float>(UNLIMITED), type.maxStackLoad / type.weight));
+}
+
+bool build(const BoxType& type, RollPattern pattern, size_t count, const FreeSpaceIndex::Extent& limit,
+           RollBlock& block) {
+    block.clear();
+    block.pattern = pattern;
+    block.orientation = orientationFor(type, pattern);
+    if (!packable(type) || block.orientation == ORIENTATION_COUNT || count == 0) return false;
+
+    bool built = false;
+    switch (pattern) {
+        case RollPattern::UprightHex: built = buildUpright(type, true, count, limit, block); break;
+        case RollPattern::UprightGrid: built = buildUpright(type, false, count, limit, block); break;
+        case RollPattern::LyingXNested: built = buildLyingX(type, true, count, limit, block); break;
+        case RollPattern::LyingXGrid: built = buildLyingX(type, false, count, limit, block); break;
+        case RollPattern::LyingZNested: built = buildLyingZ(type, true, count, limit, block); break;
+        case RollPattern::LyingZGrid: built = buildLyingZ(type, false, count, limit, block); break;
+    }
+    if (!built || block.slots.empty()) {
+        block.slots.clear();
+        return false;
+    }
+
+    for (const auto& slot : block.slots) {
+        block.size.width = std::max(block.size.width, slot.maxX());
+        block.size.height = std::max(block.size.height, slot.maxY());
+        block.size.depth = std::max(block.size.depth, slot.maxZ());
+    }
+
+    bool upright = pattern == RollPattern::UprightHex || pattern == RollPattern::UprightGrid;
+    block.radius = 0.5f * static_cast<float>(type.width);
+    long long topArea = 0;
+    std::vector<int> levels;
+    for (const auto& slot : block.slots) {
+        if (std::find(levels.begin(), levels.end(), slot.y) == levels.end()) levels.push_back(slot.y);
+        if (slot.maxY() != block.size.height) continue;
+        topArea += static_cast<long long>(slot.width) * slot.depth;
+        if (!upright) continue;
+        block.topX.push_back(static_cast<float>(slot.x) + block.radius);
+        block.topZ.push_back(static_cast<float>(slot.z) + block.radius);
+    }
+    block.layers = static_cast<int>(levels.size());
+    // Верхний ряд лежачих цилиндров без пропусков накрывает весь габарит блока
+    block.flatTop = !upright && topArea == static_cast<long long>(block.size.width) * block.size.depth;
+    return true;
+}
+
+bool clearOf(const int* centersX2, const int* centersZ2, size_t count, int x2, int z2, int diameter) {
+#if PACKING_SIMD_X86
+    if (count >= 8 && simd::hasAVX2()) {
+        return clearOfAVX2(centersX2, centersZ2, count, x2, z2, diameter);
+    }
+#endif
+    return clearOfScalar(centersX2, centersZ2, count, x2, z2, diameter);
+}
+
+} // namespace rolls
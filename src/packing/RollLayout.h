@@ -0,0 +1,82 @@
+#ifndef ROLLLAYOUT_H
+#define ROLLLAYOUT_H
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Cargo.h"
+#include "FreeSpaceIndex.h"
+#include "LoadPlan.h"
+
+// Раскладки цилиндров (бочки, шины, рулоны) блоком: упаковщик ставит блок как
+// один параллелепипед, а внутри цилиндры лежат плотнее, чем их габариты.
+//   UprightHex   - стоя на торце, ряды вдоль z со сдвигом на полдиаметра (сотами)
+//   UprightGrid  - стоя на торце, квадратной сеткой
+//   LyingXNested - лежа осью вдоль x, верхние ряды - в ложбинах нижних
+//   LyingXGrid   - лежа осью вдоль x, ряды друг над другом
+//   LyingZNested, LyingZGrid - лежа осью поперек кузова, то же в плоскости x-y
+// Соты выгоднее сетки, только если в поперечник входит много цилиндров, поэтому
+// упаковщик пробует обе и выбирает по результату.
+enum class RollPattern : uint8_t {
+    UprightHex = 0,
+    UprightGrid = 1,
+    LyingXNested = 2,
+    LyingXGrid = 3,
+    LyingZNested = 4,
+    LyingZGrid = 5
+};
+
+constexpr size_t ROLL_PATTERN_COUNT = 6;
+
+struct RollBlock {
+    RollPattern pattern = RollPattern::UprightHex;
+    uint8_t orientation = ORIENT_WHD;       // Поворот каждого цилиндра блока
+    FreeSpaceIndex::Extent size = {0, 0, 0};
+
+    // Габариты цилиндров относительно угла блока, в порядке укладки:
+    // каждый цилиндр опирается на пол блока или на цилиндры раньше него
+    std::vector<Placement> slots;
+
+    // Центры торцов на верхней грани блока (только стоячие раскладки)
+    std::vector<float> topX, topZ;
+    float radius = 0.0f;
+
+    // Лежачий блок с полным верхним слоем: сверху можно ставить коробки, как
+    // на габарит. Над неполным слоем лежачих цилиндров не ставится ничего
+    bool flatTop = false;
+    int layers = 0;
+
+    // Можно ли что-то ставить на блок
+    bool carriesLoad() const { return flatTop || !topX.empty(); }
+
+    // Доля объема блока, занятая габаритами цилиндров
+    double density() const;
+    void clear();
+};
+
+namespace rolls {
+
+// Поворот цилиндра для раскладки; ORIENTATION_COUNT - раскладка запрещена типом
+uint8_t orientationFor(const BoxType& type, RollPattern pattern);
+
+// Можно ли укладывать тип блоками: цилиндр с width == depth и хотя бы одной раскладкой
+bool packable(const BoxType& type);
+
+// Сколько цилиндров можно поставить друг на друга по ограничению нагрузки типа
+int stackLayers(const BoxType& type);
+
+// Блок из не более чем count цилиндров, помещающийся в limit. Раскладка
+// компактна по x: сначала заполняется поперечное сечение, затем следующее.
+// false - не помещается ни один цилиндр или тип не цилиндр с width == depth.
+bool build(const BoxType& type, RollPattern pattern, size_t count, const FreeSpaceIndex::Extent& limit,
+           RollBlock& block);
+
+// Не пересекает ли круг с удвоенным центром (x2, z2) ни один из count кругов
+// того же диаметра; координаты удвоены, чтобы центры оставались целыми
+bool clearOf(const int* centersX2, const int* centersZ2, size_t count, int x2, int z2, int diameter);
+
+} // namespace rolls
+
+#endif //ROLLLAYOUT_H
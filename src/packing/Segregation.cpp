@@ -0,0 +1,182 @@
+#include "Segregation.h"
+#include <algorithm>
+
+namespace {
+
+inline void hashBytes(uint64_t& hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001B3ULL;
+    }
+}
+
+inline uint64_t classBit(uint8_t cls) {
+    return 1ULL << (cls % COMPATIBILITY_CLASS_COUNT);
+}
+
+} // namespace
+
+void SegregationRules::require(uint8_t a, uint8_t b, SegregationLevel level) {
+    a %= COMPATIBILITY_CLASS_COUNT;
+    b %= COMPATIBILITY_CLASS_COUNT;
+    if (a == 0 || b == 0) return;
+
+    for (auto& row : masks) {
+        row[a] &= ~classBit(b);
+        row[b] &= ~classBit(a);
+    }
+    if (level == SegregationLevel::None) return;
+
+    masks[static_cast<size_t>(level) - 1][a] |= classBit(b);
+    masks[static_cast<size_t>(level) - 1][b] |= classBit(a);
+}
+
+SegregationLevel SegregationRules::levelFor(uint8_t a, uint8_t b) const {
+    for (size_t level = 0; level < SEGREGATION_LEVEL_COUNT; level++) {
+        if (masks[level][a % COMPATIBILITY_CLASS_COUNT] & classBit(b)) return static_cast<SegregationLevel>(level + 1);
+    }
+    return SegregationLevel::None;
+}
+
+bool SegregationRules::restricts(uint8_t cls) const {
+    for (const auto& row : masks) {
+        if (row[cls % COMPATIBILITY_CLASS_COUNT]) return true;
+    }
+    return false;
+}
+
+void SegregationRules::setDistance(SegregationLevel level, int centimeters) {
+    if (level == SegregationLevel::None) return;
+    distances[static_cast<size_t>(level) - 1] = std::max(1, centimeters);
+}
+
+uint64_t SegregationRules::hash() const {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    hashBytes(hash, masks.data(), sizeof(masks));
+    hashBytes(hash, distances.data(), sizeof(distances));
+    return hash;
+}
+
+void SegregationIndex::reset(const TrailerSpec& trailer, std::shared_ptr<const SegregationRules> rules) {
+    this->rules = std::move(rules);
+    reset(trailer);
+}
+
+void SegregationIndex::reset(const TrailerSpec& trailer) {
+    // Столбцы очищаются с сохранением емкости - состояние упаковщика переиспользуется поиском
+    cellsX = std::max(1, (trailer.width + cellSize - 1) / cellSize);
+    cellsZ = std::max(1, (trailer.depth + cellSize - 1) / cellSize);
+    cells.assign(static_cast<size_t>(cellsX) * cellsZ, 0);
+    present = 0;
+    for (ClassBoxes& group : boxes) {
+        for (std::vector<int>* column : {&group.minX, &group.minY, &group.minZ,
+                                         &group.maxX, &group.maxY, &group.maxZ}) {
+            column->clear();
+        }
+    }
+}
+
+uint64_t SegregationIndex::classesAround(const Placement& box, int margin) const {
+    // Коробки, стоящие к box ближе margin, задевают ячейки в расширенном на margin габарите
+    int x0 = std::max(0, box.x - margin) / cellSize;
+    int z0 = std::max(0, box.z - margin) / cellSize;
+    int x1 = std::min(cellsX - 1, std::max(0, box.maxX() + margin - 1) / cellSize);
+    int z1 = std::min(cellsZ - 1, std::max(0, box.maxZ() + margin - 1) / cellSize);
+
+    uint64_t mask = 0;
+    for (int x = x0; x <= x1; x++) {
+        const uint64_t* column = cells.data() + static_cast<size_t>(x) * cellsZ;
+        for (int z = z0; z <= z1; z++) mask |= column[z];
+    }
+    return mask;
+}
+
+bool SegregationIndex::tooClose(const ClassBoxes& group, const Placement& candidate, int distance) const {
+    // Зазор меньше distance по всем трем осям сразу - коробки слишком близко
+    int lowX = candidate.x - distance, highX = candidate.maxX() + distance;
+    int lowY = candidate.y - distance, highY = candidate.maxY() + distance;
+    int lowZ = candidate.z - distance, highZ = candidate.maxZ() + distance;
+    for (size_t i = 0; i < group.size(); i++) {
+        if (group.minX[i] < highX && group.maxX[i] > lowX &&
+            group.minY[i] < highY && group.maxY[i] > lowY &&
+            group.minZ[i] < highZ && group.maxZ[i] > lowZ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SegregationIndex::allows(const Placement& candidate, uint8_t cls) const {
+    cls %= COMPATIBILITY_CLASS_COUNT;
+    if (!rules || cls == 0 || present == 0) return true;
+
+    for (size_t level = 1; level <= SEGREGATION_LEVEL_COUNT; level++) {
+        SegregationLevel required = static_cast<SegregationLevel>(level);
+        uint64_t conflicting = rules->conflicts(required, cls) & present;
+        if (!conflicting) continue;
+
+        int distance = rules->distance(required);
+        uint64_t nearby = conflicting & classesAround(candidate, distance);
+        for (size_t other = 0; nearby; other++, nearby >>= 1) {
+            if ((nearby & 1) && tooClose(boxes[other], candidate, distance)) return false;
+        }
+    }
+    return true;
+}
+
+void SegregationIndex::add(const Placement& placement, uint8_t cls) {
+    cls %= COMPATIBILITY_CLASS_COUNT;
+    if (!rules || cls == 0) return;
+
+    present |= classBit(cls);
+    int x0 = std::max(0, placement.x) / cellSize;
+    int z0 = std::max(0, placement.z) / cellSize;
+    int x1 = std::min(cellsX - 1, std::max(0, placement.maxX() - 1) / cellSize);
+    int z1 = std::min(cellsZ - 1, std::max(0, placement.maxZ() - 1) / cellSize);
+    for (int x = x0; x <= x1; x++) {
+        uint64_t* column = cells.data() + static_cast<size_t>(x) * cellsZ;
+        for (int z = z0; z <= z1; z++) column[z] |= classBit(cls);
+    }
+
+    if (boxes.empty()) boxes.resize(COMPATIBILITY_CLASS_COUNT);
+    ClassBoxes& group = boxes[cls];
+    group.minX.push_back(placement.x);
+    group.minY.push_back(placement.y);
+    group.minZ.push_back(placement.z);
+    group.maxX.push_back(placement.maxX());
+    group.maxY.push_back(placement.maxY());
+    group.maxZ.push_back(placement.maxZ());
+}
+
+void SegregationIndex::removeLast(const Placement& placement, uint8_t cls) {
+    cls %= COMPATIBILITY_CLASS_COUNT;
+    if (!rules || cls == 0 || boxes.empty() || boxes[cls].size() == 0) return;
+
+    ClassBoxes& group = boxes[cls];
+    for (std::vector<int>* column : {&group.minX, &group.minY, &group.minZ,
+                                     &group.maxX, &group.maxY, &group.maxZ}) {
+        column->pop_back();
+    }
+    if (group.size() == 0) present &= ~classBit(cls);
+
+    // Бит класса в ячейках коробки снимается и ставится заново по оставшимся
+    // коробкам того же класса, задевающим эти ячейки
+    int x0 = std::max(0, placement.x) / cellSize;
+    int z0 = std::max(0, placement.z) / cellSize;
+    int x1 = std::min(cellsX - 1, std::max(0, placement.maxX() - 1) / cellSize);
+    int z1 = std::min(cellsZ - 1, std::max(0, placement.maxZ() - 1) / cellSize);
+    for (int x = x0; x <= x1; x++) {
+        uint64_t* column = cells.data() + static_cast<size_t>(x) * cellsZ;
+        for (int z = z0; z <= z1; z++) column[z] &= ~classBit(cls);
+    }
+    for (size_t i = 0; i < group.size(); i++) {
+        int bx0 = std::max(x0, std::max(0, group.minX[i]) / cellSize);
+        int bz0 = std::max(z0, std::max(0, group.minZ[i]) / cellSize);
+        int bx1 = std::min(x1, std::max(0, group.maxX[i] - 1) / cellSize);
+        int bz1 = std::min(z1, std::max(0, group.maxZ[i] - 1) / cellSize);
+        for (int x = bx0; x <= bx1; x++) {
+            uint64_t* column = cells.data() + static_cast<size_t>(x) * cellsZ;
+            for (int z = bz0; z <= bz1; z++) column[z] |= classBit(cls);
+        }
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef SEGREGATION_H
+#define SEGREGATION_H
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Cargo.h"
+#include "LoadPlan.h"
+
+// Классы совместимости груза (BoxType::compatibilityClass): опасные грузы по
+// классам ДОПОГ, продукты питания и все, что нельзя ставить рядом. Класс 0 -
+// обычный груз без ограничений.
+constexpr size_t COMPATIBILITY_CLASS_COUNT = 64;
+
+// Требование к паре классов, по возрастанию строгости:
+//   NoContact - не касаться (пищевые продукты и химия)
+//   Away      - не ближе distance(Away), по умолчанию 3 м
+//   Separated - не ближе distance(Separated), по умолчанию 6 м
+enum class SegregationLevel : uint8_t {
+    None = 0,
+    NoContact = 1,
+    Away = 2,
+    Separated = 3
+};
+
+constexpr size_t SEGREGATION_LEVEL_COUNT = 3;   // Без None
+
+// Матрица совместимости: для класса c и уровня L - битовая маска классов,
+// с которыми у c требование ровно L. Матрица симметрична, поэтому проверка
+// кандидата - AND его строки с маской классов вокруг.
+class SegregationRules {
+private:
+    std::array<std::array<uint64_t, COMPATIBILITY_CLASS_COUNT>, SEGREGATION_LEVEL_COUNT> masks = {};
+    std::array<int, SEGREGATION_LEVEL_COUNT> distances = {1, 300, 600};
+
+public:
+    // Требование для пары (a, b) и (b, a); заменяет прежнее. Класс 0 не ограничивается
+    void require(uint8_t a, uint8_t b, SegregationLevel level);
+    SegregationLevel levelFor(uint8_t a, uint8_t b) const;
+
+    // Классы, с которыми у cls требование level
+    uint64_t conflicts(SegregationLevel level, uint8_t cls) const {
+        return masks[static_cast<size_t>(level) - 1][cls % COMPATIBILITY_CLASS_COUNT];
+    }
+    // Есть ли у cls хоть одно требование
+    bool restricts(uint8_t cls) const;
+
+    // Минимальный зазор уровня в см: по каждой оси, как расстояние Чебышёва между
+    // габаритами. NoContact - 1 см, то есть любой зазор
+    int distance(SegregationLevel level) const { return distances[static_cast<size_t>(level) - 1]; }
+    void setDistance(SegregationLevel level, int centimeters);
+
+    uint64_t hash() const;
+};
+
+// Расстановка классов в прицепе для проверки кандидата. Пол разбит на ячейки
+// cellSize x cellSize, у каждой - маска классов, габариты которых ее задевают.
+// Если маска ячеек вокруг кандидата не пересекается с его строкой матрицы,
+// кандидат допустим без перебора соседей; иначе точная проверка идет только
+// по коробкам конфликтующих классов.
+class SegregationIndex {
+private:
+    // Габариты коробок одного класса столбцами
+    struct ClassBoxes {
+        std::vector<int> minX, minY, minZ, maxX, maxY, maxZ;
+        size_t size() const { return minX.size(); }
+    };
+
+    std::shared_ptr<const SegregationRules> rules;
+    int cellSize = 50;
+    int cellsX = 0, cellsZ = 0;
+    std::vector<uint64_t> cells;
+    uint64_t present = 0;                   // Классы, уже стоящие в прицепе
+    std::vector<ClassBoxes> boxes;          // Индекс - класс
+
+    // Маска классов в ячейках, задевающих box, расширенный на margin по x и z
+    uint64_t classesAround(const Placement& box, int margin) const;
+    bool tooClose(const ClassBoxes& group, const Placement& candidate, int distance) const;
+
+public:
+    // Пустой прицеп; rules == nullptr - проверка выключена
+    void reset(const TrailerSpec& trailer, std::shared_ptr<const SegregationRules> rules);
+    void reset(const TrailerSpec& trailer);
+
+    // true, если коробку класса cls можно поставить в candidate
+    bool allows(const Placement& candidate, uint8_t cls) const;
+    void add(const Placement& placement, uint8_t cls);
+    // Снимает последнюю коробку класса cls (ту же, что была передана в add)
+    void removeLast(const Placement& placement, uint8_t cls);
+
+    bool enabled() const { return rules != nullptr; }
+    const std::shared_ptr<const SegregationRules>& getRules() const { return rules; }
+};
+
+#endif //SEGREGATION_H
@@ -0,0 +1,36 @@
+#include "Simd.h"
+
+#if PACKING_SIMD_X86 && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace {
+
+bool detectAVX2() {
+#if !PACKING_SIMD_X86
+    return false;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    bool popcnt = (info[2] & (1 << 23)) != 0;
+    if (!osxsave || !avx || !popcnt) return false;
+
+    // ОС должна сохранять регистры YMM
+    if ((_xgetbv(0) & 0x6) != 0x6) return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+#endif
+}
+
+} // namespace
+
+bool simd::hasAVX2() {
+    static const bool supported = detectAVX2();
+    return supported;
+}
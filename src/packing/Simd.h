@@ -0,0 +1,28 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#pragma once
+
+// Общие макросы для SIMD-ядер упаковщика.
+// AVX2-функции компилируются с атрибутом target, поэтому весь проект
+// не требует -mavx2; выбор реализации делается во время выполнения.
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define PACKING_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define PACKING_SIMD_X86 0
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define PACKING_TARGET_AVX2
+#else
+#define PACKING_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#endif
+
+namespace simd {
+    // Проверка поддержки AVX2 процессором и ОС (результат кэшируется)
+    bool hasAVX2();
+}
+
+#endif //SIMD_H
@@ -0,0 +1,361 @@
+#include "SupportGraph.h"
+#include "Simd.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Площади пересечения прямоугольника [x0, x1) x [z0, z1) с каждым из count прямоугольников слоя
+void overlapAreasScalar(const int* minX, const int* maxX, const int* minZ, const int* maxZ, size_t count,
+                        int x0, int x1, int z0, int z1, int* areas) {
+    for (size_t i = 0; i < count; i++) {
+        int overlapX = std::max(0, std::min(maxX[i], x1) - std::max(minX[i], x0));
+        int overlapZ = std::max(0, std::min(maxZ[i], z1) - std::max(minZ[i], z0));
+        areas[i] = overlapX * overlapZ;
+    }
+}
+
+#if PACKING_SIMD_X86
+PACKING_TARGET_AVX2 void overlapAreasAVX2(const int* minX, const int* maxX, const int* minZ, const int* maxZ,
+                                          size_t count, int x0, int x1, int z0, int z1, int* areas) {
+    const __m256i vx0 = _mm256_set1_epi32(x0);
+    const __m256i vx1 = _mm256_set1_epi32(x1);
+    const __m256i vz0 = _mm256_set1_epi32(z0);
+    const __m256i vz1 = _mm256_set1_epi32(z1);
+    const __m256i zero = _mm256_setzero_si256();
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i ax0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(minX + i));
+        __m256i ax1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(maxX + i));
+        __m256i az0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(minZ + i));
+        __m256i az1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(maxZ + i));
+
+        __m256i overlapX = _mm256_max_epi32(zero, _mm256_sub_epi32(_mm256_min_epi32(ax1, vx1), _mm256_max_epi32(ax0, vx0)));
+        __m256i overlapZ = _mm256_max_epi32(zero, _mm256_sub_epi32(_mm256_min_epi32(az1, vz1), _mm256_max_epi32(az0, vz0)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(areas + i), _mm256_mullo_epi32(overlapX, overlapZ));
+    }
+    overlapAreasScalar(minX + i, maxX + i, minZ + i, maxZ + i, count - i, x0, x1, z0, z1, areas + i);
+}
+#endif
+
+void overlapAreas(const int* minX, const int* maxX, const int* minZ, const int* maxZ, size_t count,
+                  int x0, int x1, int z0, int z1, int* areas) {
+#if PACKING_SIMD_X86
+    if (count >= 8 && simd::hasAVX2()) {
+        overlapAreasAVX2(minX, maxX, minZ, maxZ, count, x0, x1, z0, z1, areas);
+        return;
+    }
+#endif
+    overlapAreasScalar(minX, maxX, minZ, maxZ, count, x0, x1, z0, z1, areas);
+}
+
+// Площадь пересечения кругов радиуса r с прямоугольником [x0, x1) x [z0, z1):
+// формула трапеций по CIRCLE_STRIPS полосам вдоль x. Длина хорды вогнута по x,
+// поэтому трапеции дают оценку снизу - опора не завышается
+constexpr int CIRCLE_STRIPS = 16;
+
+float circleRectAreaScalar(const float* cx, const float* cz, size_t count, float r,
+                           float x0, float x1, float z0, float z1) {
+    float total = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        float from = std::max(x0, cx[i] - r);
+        float to = std::min(x1, cx[i] + r);
+        if (from >= to) continue;
+
+        float step = (to - from) / CIRCLE_STRIPS;
+        float sum = 0.0f;
+        for (int k = 0; k <= CIRCLE_STRIPS; k++) {
+            float dx = from + step * static_cast<float>(k) - cx[i];
+            float half = std::sqrt(std::max(0.0f, r * r - dx * dx));
+            float length = std::max(0.0f, std::min(z1, cz[i] + half) - std::max(z0, cz[i] - half));
+            sum += (k == 0 || k == CIRCLE_STRIPS) ? 0.5f * length : length;
+        }
+        total += sum * step;
+    }
+    return total;
+}
+
+#if PACKING_SIMD_X86
+PACKING_TARGET_AVX2 float circleRectAreaAVX2(const float* cx, const float* cz, size_t count, float r,
+                                             float x0, float x1, float z0, float z1) {
+    const __m256 vx0 = _mm256_set1_ps(x0);
+    const __m256 vx1 = _mm256_set1_ps(x1);
+    const __m256 vz0 = _mm256_set1_ps(z0);
+    const __m256 vz1 = _mm256_set1_ps(z1);
+    const __m256 vr = _mm256_set1_ps(r);
+    const __m256 r2 = _mm256_set1_ps(r * r);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 halfWeight = _mm256_set1_ps(0.5f);
+    const __m256 strips = _mm256_set1_ps(1.0f / CIRCLE_STRIPS);
+
+    __m256 total = zero;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(cx + i);
+        __m256 z = _mm256_loadu_ps(cz + i);
+        __m256 from = _mm256_max_ps(vx0, _mm256_sub_ps(x, vr));
+        __m256 to = _mm256_min_ps(vx1, _mm256_add_ps(x, vr));
+        // Круги вне прямоугольника по x получают нулевой шаг
+        __m256 step = _mm256_mul_ps(_mm256_max_ps(zero, _mm256_sub_ps(to, from)), strips);
+
+        __m256 sum = zero;
+        for (int k = 0; k <= CIRCLE_STRIPS; k++) {
+            __m256 dx = _mm256_sub_ps(_mm256_add_ps(from, _mm256_mul_ps(step, _mm256_set1_ps(static_cast<float>(k)))), x);
+            __m256 half = _mm256_sqrt_ps(_mm256_max_ps(zero, _mm256_sub_ps(r2, _mm256_mul_ps(dx, dx))));
+            __m256 length = _mm256_max_ps(zero, _mm256_sub_ps(_mm256_min_ps(vz1, _mm256_add_ps(z, half)),
+                                                              _mm256_max_ps(vz0, _mm256_sub_ps(z, half))));
+            sum = _mm256_add_ps(sum, (k == 0 || k == CIRCLE_STRIPS) ? _mm256_mul_ps(halfWeight, length) : length);
+        }
+        total = _mm256_add_ps(total, _mm256_mul_ps(sum, step));
+    }
+
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, total);
+    float result = 0.0f;
+    for (float lane : lanes) result += lane;
+    return result + circleRectAreaScalar(cx + i, cz + i, count - i, r, x0, x1, z0, z1);
+}
+#endif
+
+float circleRectArea(const float* cx, const float* cz, size_t count, float r, float x0, float x1, float z0, float z1) {
+#if PACKING_SIMD_X86
+    if (count >= 8 && simd::hasAVX2()) {
+        return circleRectAreaAVX2(cx, cz, count, r, x0, x1, z0, z1);
+    }
+#endif
+    return circleRectAreaScalar(cx, cz, count, r, x0, x1, z0, z1);
+}
+
+} // namespace
+
+SupportGraph::SupportGraph() {
+    edgeBegin.push_back(0);
+}
+
+void SupportGraph::clear() {
+    // Пустой слой ведет себя как отсутствующий, поэтому слои не удаляются,
+    // а очищаются: при переиспользовании графа память не перевыделяется
+    for (auto& entry : layers) {
+        Layer& layer = entry.second;
+        layer.minX.clear();
+        layer.maxX.clear();
+        layer.minZ.clear();
+        layer.maxZ.clear();
+        layer.nodes.clear();
+        layer.rollBegin.clear();
+        layer.rollCount.clear();
+        layer.rollRadius.clear();
+        layer.rollEntries = 0;
+    }
+    rollX.clear();
+    rollZ.clear();
+    edgeBegin.assign(1, 0);
+    edges.clear();
+    loadOnTop.clear();
+    maxLoad.clear();
+    pendingDelta.clear();
+}
+
+const SupportGraph::Layer* SupportGraph::layerAt(int height) const {
+    auto it = layers.find(height);
+    return it == layers.end() ? nullptr : &it->second;
+}
+
+long long SupportGraph::contactArea(const Placement& candidate) const {
+    if (candidate.y == 0) {
+        return static_cast<long long>(candidate.width) * candidate.depth;
+    }
+
+    const Layer* layer = layerAt(candidate.y);
+    if (!layer) return 0;
+
+    size_t count = layer->nodes.size();
+    scratchAreas.resize(count);
+    overlapAreas(layer->minX.data(), layer->maxX.data(), layer->minZ.data(), layer->maxZ.data(), count,
+                 candidate.x, candidate.maxX(), candidate.z, candidate.maxZ(), scratchAreas.data());
+    if (layer->rollEntries > 0) clipToRolls(*layer, candidate);
+
+    long long total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += scratchAreas[i];
+    }
+    return total;
+}
+
+bool SupportGraph::canSupport(const Placement& candidate, float mass, float minSupportRatio) const {
+    if (candidate.y == 0) return true;
+
+    // Площадь контакта считается один раз и переиспользуется из scratchAreas
+    long long total = contactArea(candidate);
+    long long baseArea = static_cast<long long>(candidate.width) * candidate.depth;
+    if (total < static_cast<long long>(baseArea * minSupportRatio)) return false;
+    if (total <= 0 || mass <= 0.0f) return true;
+
+    const Layer& layer = *layerAt(candidate.y);
+    pendingDelta.resize(loadOnTop.size(), 0.0f);
+    pendingNodes.clear();
+
+    // Массу кандидата делим между опорами пропорционально площади контакта
+    for (size_t i = 0; i < layer.nodes.size(); i++) {
+        if (scratchAreas[i] <= 0) continue;
+        uint32_t node = layer.nodes[i];
+        pendingDelta[node] += mass * static_cast<float>(scratchAreas[i]) / static_cast<float>(total);
+        pendingNodes.push_back(node);
+        std::push_heap(pendingNodes.begin(), pendingNodes.end());
+    }
+
+    // Обход сверху вниз по убыванию индекса: опоры всегда добавлены раньше,
+    // поэтому к моменту извлечения узла все вклады в него уже собраны
+    bool ok = true;
+    while (!pendingNodes.empty()) {
+        std::pop_heap(pendingNodes.begin(), pendingNodes.end());
+        uint32_t node = pendingNodes.back();
+        pendingNodes.pop_back();
+
+        float delta = pendingDelta[node];
+        if (delta == 0.0f) continue;          // Узел уже обработан (дубликат в куче)
+        pendingDelta[node] = 0.0f;
+
+        if (!ok) continue;                    // Только очищаем оставшиеся буферы
+        if (maxLoad[node] >= 0.0f && loadOnTop[node] + delta > maxLoad[node]) {
+            ok = false;
+            continue;
+        }
+
+        for (uint32_t e = edgeBegin[node]; e < edgeBegin[node + 1]; e++) {
+            uint32_t supporter = edges[e].supporter;
+            if (pendingDelta[supporter] == 0.0f) {
+                pendingNodes.push_back(supporter);
+                std::push_heap(pendingNodes.begin(), pendingNodes.end());
+            }
+            pendingDelta[supporter] += delta * edges[e].share;
+        }
+    }
+    return ok;
+}
+
+void SupportGraph::clipToRolls(const Layer& layer, const Placement& candidate) const {
+    float x0 = static_cast<float>(candidate.x), x1 = static_cast<float>(candidate.maxX());
+    float z0 = static_cast<float>(candidate.z), z1 = static_cast<float>(candidate.maxZ());
+    for (size_t i = 0; i < layer.nodes.size(); i++) {
+        if (layer.rollCount[i] == 0 || scratchAreas[i] <= 0) continue;
+        uint32_t begin = layer.rollBegin[i];
+        float area = circleRectArea(rollX.data() + begin, rollZ.data() + begin, layer.rollCount[i],
+                                    layer.rollRadius[i], x0, x1, z0, z1);
+        scratchAreas[i] = std::min(scratchAreas[i], static_cast<int>(area));
+    }
+}
+
+void SupportGraph::add(const Placement& placement, float mass, float maxStackLoad) {
+    addTop(placement, addNode(placement, mass, maxStackLoad));
+}
+
+void SupportGraph::removeLast(const Placement& placement, float mass) {
+    if (loadOnTop.empty()) return;
+    uint32_t node = static_cast<uint32_t>(loadOnTop.size() - 1);
+
+    // Сверху на последней коробке ничего нет, так что снимается только ее масса с опор
+    spreadDown(edgeBegin[node], edgeBegin[node + 1], -mass);
+    edges.resize(edgeBegin[node]);
+    edgeBegin.pop_back();
+    loadOnTop.pop_back();
+    maxLoad.pop_back();
+    pendingDelta.pop_back();
+
+    auto it = layers.find(placement.maxY());
+    if (it == layers.end() || it->second.nodes.empty() || it->second.nodes.back() != node) return;
+    Layer& top = it->second;
+    top.minX.pop_back();
+    top.maxX.pop_back();
+    top.minZ.pop_back();
+    top.maxZ.pop_back();
+    top.nodes.pop_back();
+    top.rollBegin.pop_back();
+    top.rollCount.pop_back();
+    top.rollRadius.pop_back();
+}
+
+void SupportGraph::addRolls(const Placement& placement, float mass, float maxStackLoad,
+                            const float* centerX, const float* centerZ, size_t count, float radius) {
+    uint32_t node = addNode(placement, mass, maxStackLoad);
+    if (count == 0) return;
+
+    Layer& top = addTop(placement, node);
+    top.rollBegin.back() = static_cast<uint32_t>(rollX.size());
+    top.rollCount.back() = static_cast<uint32_t>(count);
+    top.rollRadius.back() = radius;
+    top.rollEntries++;
+    for (size_t i = 0; i < count; i++) {
+        rollX.push_back(static_cast<float>(placement.x) + centerX[i]);
+        rollZ.push_back(static_cast<float>(placement.z) + centerZ[i]);
+    }
+}
+
+void SupportGraph::spreadDown(uint32_t firstEdge, uint32_t lastEdge, float mass) {
+    // Распространяем массу вниз тем же обходом, что и в canSupport, но с записью
+    pendingDelta.resize(loadOnTop.size(), 0.0f);
+    pendingNodes.clear();
+    for (uint32_t e = firstEdge; e < lastEdge; e++) {
+        pendingDelta[edges[e].supporter] += mass * edges[e].share;
+        pendingNodes.push_back(edges[e].supporter);
+        std::push_heap(pendingNodes.begin(), pendingNodes.end());
+    }
+
+    while (!pendingNodes.empty()) {
+        std::pop_heap(pendingNodes.begin(), pendingNodes.end());
+        uint32_t current = pendingNodes.back();
+        pendingNodes.pop_back();
+
+        float delta = pendingDelta[current];
+        if (delta == 0.0f) continue;
+        pendingDelta[current] = 0.0f;
+        loadOnTop[current] += delta;
+
+        for (uint32_t e = edgeBegin[current]; e < edgeBegin[current + 1]; e++) {
+            uint32_t supporter = edges[e].supporter;
+            if (pendingDelta[supporter] == 0.0f) {
+                pendingNodes.push_back(supporter);
+                std::push_heap(pendingNodes.begin(), pendingNodes.end());
+            }
+            pendingDelta[supporter] += delta * edges[e].share;
+        }
+    }
+}
+
+uint32_t SupportGraph::addNode(const Placement& placement, float mass, float maxStackLoad) {
+    uint32_t node = static_cast<uint32_t>(loadOnTop.size());
+
+    if (placement.y > 0) {
+        long long total = contactArea(placement);
+        const Layer* layer = layerAt(placement.y);
+
+        if (layer && total > 0) {
+            for (size_t i = 0; i < layer->nodes.size(); i++) {
+                if (scratchAreas[i] <= 0) continue;
+                edges.push_back({layer->nodes[i], static_cast<float>(scratchAreas[i]) / static_cast<float>(total)});
+            }
+
+            spreadDown(edgeBegin[node], static_cast<uint32_t>(edges.size()), mass);
+        }
+    }
+
+    edgeBegin.push_back(static_cast<uint32_t>(edges.size()));
+    loadOnTop.push_back(0.0f);
+    maxLoad.push_back(maxStackLoad);
+    pendingDelta.push_back(0.0f);
+    return node;
+}
+
+SupportGraph::Layer& SupportGraph::addTop(const Placement& placement, uint32_t node) {
+    Layer& top = layers[placement.maxY()];
+    top.minX.push_back(placement.x);
+    top.maxX.push_back(placement.maxX());
+    top.minZ.push_back(placement.z);
+    top.maxZ.push_back(placement.maxZ());
+    top.nodes.push_back(node);
+    top.rollBegin.push_back(0);
+    top.rollCount.push_back(0);
+    top.rollRadius.push_back(0.0f);
+    return top;
+}
@@ -0,0 +1,83 @@
+#ifndef SUPPORTGRAPH_H
+#define SUPPORTGRAPH_H
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "LoadPlan.h"
+
+// Граф опор: какая коробка на какой стоит и с какой площадью контакта.
+// Коробки добавляются только сверху, поэтому опоры всегда имеют меньший индекс,
+// а ребра хранятся в плоском массиве без перестроений (как CSR).
+class SupportGraph {
+private:
+    struct Edge {
+        uint32_t supporter;
+        float share;          // Доля веса, передаваемая на эту опору
+    };
+
+    // Коробки, чей верх находится на одной высоте, в виде структуры массивов.
+    // У блока стоячих цилиндров верх - не прямоугольник, а торцы верхнего слоя:
+    // rollCount > 0, круги лежат в rollX/rollZ с rollBegin
+    struct Layer {
+        std::vector<int> minX, maxX, minZ, maxZ;
+        std::vector<uint32_t> nodes;
+        std::vector<uint32_t> rollBegin, rollCount;
+        std::vector<float> rollRadius;
+        size_t rollEntries = 0;
+    };
+
+    std::unordered_map<int, Layer> layers;
+    std::vector<float> rollX, rollZ;    // Центры торцов, общий пул слоев
+
+    std::vector<uint32_t> edgeBegin;    // edges[edgeBegin[n] .. edgeBegin[n + 1])
+    std::vector<Edge> edges;
+    std::vector<float> loadOnTop;       // Накопленная нагрузка сверху, кг
+    std::vector<float> maxLoad;         // < 0 - без ограничения
+
+    // Рабочие буферы проверки, чтобы не выделять память на каждый кандидат
+    mutable std::vector<int> scratchAreas;
+    mutable std::vector<float> pendingDelta;
+    mutable std::vector<uint32_t> pendingNodes;
+
+    const Layer* layerAt(int height) const;
+    // Площади контакта с блоками цилиндров - по кругам вместо габаритов
+    void clipToRolls(const Layer& layer, const Placement& candidate) const;
+    // Прибавляет mass (для снятия - отрицательную) к нагрузке опор по ребрам
+    // edges[firstEdge .. lastEdge) и дальше вниз
+    void spreadDown(uint32_t firstEdge, uint32_t lastEdge, float mass);
+    uint32_t addNode(const Placement& placement, float mass, float maxStackLoad);
+    Layer& addTop(const Placement& placement, uint32_t node);
+
+public:
+    SupportGraph();
+
+    void clear();
+
+    // Суммарная площадь опоры под основанием кандидата (на полу - вся площадь)
+    long long contactArea(const Placement& candidate) const;
+
+    // Достаточна ли опора (доля основания >= minSupportRatio) и выдержат ли все
+    // коробки ниже дополнительную массу. Проверяются только пути от опор кандидата вниз.
+    bool canSupport(const Placement& candidate, float mass, float minSupportRatio) const;
+
+    // Добавляет коробку; индекс узла совпадает с порядком добавления
+    void add(const Placement& placement, float mass, float maxStackLoad);
+
+    // Снимает последнюю коробку, добавленную через add, с той же массой:
+    // нагрузка ее опор уменьшается, узел и его ребра удаляются
+    void removeLast(const Placement& placement, float mass);
+
+    // Блок цилиндров в габарите placement. Опорой сверху служат только торцы
+    // стоячих цилиндров - круги радиуса radius с центрами (centerX, centerZ)
+    // относительно угла блока; count == 0 (лежачие цилиндры) - на блок ничего не ставится
+    void addRolls(const Placement& placement, float mass, float maxStackLoad,
+                  const float* centerX, const float* centerZ, size_t count, float radius);
+
+    float getLoadOnTop(uint32_t node) const { return loadOnTop[node]; }
+    size_t size() const { return loadOnTop.size(); }
+};
+
+#endif //SUPPORTGRAPH_H
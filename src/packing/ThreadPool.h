@@ -0,0 +1,70 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Пул потоков с перехватом задач (work stealing).
+// У каждого потока своя очередь: задачи, отправленные изнутри пула, попадают
+// в очередь текущего потока (LIFO), свободные потоки забирают работу у соседей (FIFO).
+class ThreadPool {
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    std::condition_variable idle;
+    std::atomic<size_t> queued{0};
+    std::atomic<size_t> pending{0};    // В очереди + выполняются
+    std::atomic<size_t> nextQueue{0};
+    bool stopping = false;
+
+    bool tryPop(size_t index, std::function<void()>& task);
+    bool trySteal(size_t thief, std::function<void()>& task);
+    void workerLoop(size_t index);
+
+public:
+    // threadCount == 0 -> по числу аппаратных потоков
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    template <typename F>
+    auto async(F&& function) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(function));
+        std::future<Result> result = task->get_future();
+        submit([task]() { (*task)(); });
+        return result;
+    }
+
+    // Ждет, пока не останется ни одной задачи. Нельзя вызывать из потока пула.
+    void waitIdle();
+
+    size_t size() const { return workers.size(); }
+
+    // Индекс текущего потока пула или -1 для внешних потоков
+    static int currentWorkerIndex();
+};
+
+#endif //THREADPOOL_H
@@ -0,0 +1,459 @@
+#include "TrailerInterior.h"
+#include "Simd.h"
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <initializer_list>
+
+namespace {
+
+constexpr size_t MAX_AXES = 13;
+
+// Оси разделения одного треугольника относительно вокселя: 3 оси сетки,
+// нормаль и 9 произведений ребер на оси. Для центра вокселя c треугольник
+// и воксель пересекаются, если для каждой оси a: lo <= a.c <= hi.
+// Оси с a.x != 0 дают на строке (y, z) отрезок по x, остальные - условие на строку.
+struct TriangleAxes {
+    size_t slopeCount = 0;
+    float slopeY[MAX_AXES], slopeZ[MAX_AXES], slopeInvX[MAX_AXES], slopeLo[MAX_AXES], slopeHi[MAX_AXES];
+    size_t flatCount = 0;
+    float flatY[MAX_AXES], flatZ[MAX_AXES], flatLo[MAX_AXES], flatHi[MAX_AXES];
+};
+
+struct Vec3 {
+    float x, y, z;
+};
+
+inline Vec3 sub(const Vec3& a, const Vec3& b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+inline float dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline Vec3 cross(const Vec3& a, const Vec3& b) {
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+void setupAxes(const Vec3 (&vertices)[3], float half, TriangleAxes& axes) {
+    Vec3 edges[3] = {sub(vertices[1], vertices[0]), sub(vertices[2], vertices[1]), sub(vertices[0], vertices[2])};
+
+    // Треугольник сдвигается на малую долю вокселя против нормали (в глубь тела,
+    // нормали glTF смотрят наружу), а радиус вокселя ниже чуть уменьшен. Поверхность,
+    // лежащая ровно на грани вокселя, занимает воксель с внутренней стороны тела -
+    // замкнутое препятствие по границам сетки не "протекает" при заливке, а пол и
+    // стенки кузова, обращенные в грузовой объем, не отнимают у него слой вокселей
+    Vec3 normal = cross(edges[0], edges[1]);
+    float normalLength = std::sqrt(dot(normal, normal));
+    float shift = normalLength > 0.0f ? 2e-3f * half / normalLength : 0.0f;
+    Vec3 v[3];
+    for (int i = 0; i < 3; i++) {
+        v[i] = {vertices[i].x - normal.x * shift, vertices[i].y - normal.y * shift, vertices[i].z - normal.z * shift};
+    }
+
+    Vec3 candidates[MAX_AXES] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, normal};
+    const Vec3 unit[3] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}};
+    size_t count = 4;
+    for (const Vec3& edge : edges) {
+        for (const Vec3& axis : unit) candidates[count++] = cross(edge, axis);
+    }
+
+    axes.slopeCount = 0;
+    axes.flatCount = 0;
+    for (size_t i = 0; i < count; i++) {
+        const Vec3& a = candidates[i];
+        float length = std::fabs(a.x) + std::fabs(a.y) + std::fabs(a.z);
+        if (length < 1e-6f) continue;       // Вырожденное ребро или треугольник
+
+        float p0 = dot(a, v[0]), p1 = dot(a, v[1]), p2 = dot(a, v[2]);
+        float radius = half * length * (1.0f - 1e-3f);
+        float lo = std::min(p0, std::min(p1, p2)) - radius;
+        float hi = std::max(p0, std::max(p1, p2)) + radius;
+
+        if (std::fabs(a.x) > 1e-6f * length) {
+            axes.slopeY[axes.slopeCount] = a.y;
+            axes.slopeZ[axes.slopeCount] = a.z;
+            axes.slopeInvX[axes.slopeCount] = 1.0f / a.x;
+            axes.slopeLo[axes.slopeCount] = lo;
+            axes.slopeHi[axes.slopeCount] = hi;
+            axes.slopeCount++;
+        } else {
+            axes.flatY[axes.flatCount] = a.y;
+            axes.flatZ[axes.flatCount] = a.z;
+            axes.flatLo[axes.flatCount] = lo;
+            axes.flatHi[axes.flatCount] = hi;
+            axes.flatCount++;
+        }
+    }
+}
+
+// Отрезки центров вокселей [xlo, xhi] по x, которые пересекает треугольник, для
+// строк с центрами (cy, cz[i]); пустой отрезок - xlo > xhi
+struct VoxelKernels {
+    void (*spans)(const TriangleAxes& axes, float cy, const float* cz, size_t count, float* xlo, float* xhi);
+};
+
+void spansScalar(const TriangleAxes& axes, float cy, const float* cz, size_t count, float* xlo, float* xhi) {
+    for (size_t row = 0; row < count; row++) {
+        float lo = -HUGE_VALF, hi = HUGE_VALF;
+        bool inside = true;
+        for (size_t i = 0; i < axes.flatCount; i++) {
+            float b = axes.flatY[i] * cy + axes.flatZ[i] * cz[row];
+            inside = inside && b >= axes.flatLo[i] && b <= axes.flatHi[i];
+        }
+        for (size_t i = 0; i < axes.slopeCount; i++) {
+            float b = axes.slopeY[i] * cy + axes.slopeZ[i] * cz[row];
+            float t0 = (axes.slopeLo[i] - b) * axes.slopeInvX[i];
+            float t1 = (axes.slopeHi[i] - b) * axes.slopeInvX[i];
+            lo = std::max(lo, std::min(t0, t1));
+            hi = std::min(hi, std::max(t0, t1));
+        }
+        xlo[row] = inside ? lo : HUGE_VALF;
+        xhi[row] = hi;
+    }
+}
+
+#if PACKING_SIMD_X86
+
+// ---------------- SSE2 ----------------
+
+void spansSSE2(const TriangleAxes& axes, float cy, const float* cz, size_t count, float* xlo, float* xhi) {
+    const __m128 vcy = _mm_set1_ps(cy);
+    const __m128 infinity = _mm_set1_ps(HUGE_VALF);
+    const __m128 negInfinity = _mm_set1_ps(-HUGE_VALF);
+
+    size_t row = 0;
+    for (; row + 4 <= count; row += 4) {
+        __m128 vcz = _mm_loadu_ps(cz + row);
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (size_t i = 0; i < axes.flatCount; i++) {
+            __m128 b = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(axes.flatY[i]), vcy),
+                                  _mm_mul_ps(_mm_set1_ps(axes.flatZ[i]), vcz));
+            inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpge_ps(b, _mm_set1_ps(axes.flatLo[i])),
+                                                   _mm_cmple_ps(b, _mm_set1_ps(axes.flatHi[i]))));
+        }
+
+        __m128 lo = negInfinity, hi = infinity;
+        for (size_t i = 0; i < axes.slopeCount; i++) {
+            __m128 b = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(axes.slopeY[i]), vcy),
+                                  _mm_mul_ps(_mm_set1_ps(axes.slopeZ[i]), vcz));
+            __m128 inv = _mm_set1_ps(axes.slopeInvX[i]);
+            __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(axes.slopeLo[i]), b), inv);
+            __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(axes.slopeHi[i]), b), inv);
+            lo = _mm_max_ps(lo, _mm_min_ps(t0, t1));
+            hi = _mm_min_ps(hi, _mm_max_ps(t0, t1));
+        }
+
+        // Строки, отсеченные осями без x, получают пустой отрезок
+        lo = _mm_or_ps(_mm_and_ps(inside, lo), _mm_andnot_ps(inside, infinity));
+        _mm_storeu_ps(xlo + row, lo);
+        _mm_storeu_ps(xhi + row, hi);
+    }
+    spansScalar(axes, cy, cz + row, count - row, xlo + row, xhi + row);
+}
+
+// ---------------- AVX2 ----------------
+
+PACKING_TARGET_AVX2 void spansAVX2(const TriangleAxes& axes, float cy, const float* cz, size_t count,
+                                   float* xlo, float* xhi) {
+    const __m256 vcy = _mm256_set1_ps(cy);
+    const __m256 infinity = _mm256_set1_ps(HUGE_VALF);
+    const __m256 negInfinity = _mm256_set1_ps(-HUGE_VALF);
+
+    size_t row = 0;
+    for (; row + 8 <= count; row += 8) {
+        __m256 vcz = _mm256_loadu_ps(cz + row);
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (size_t i = 0; i < axes.flatCount; i++) {
+            __m256 b = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(axes.flatY[i]), vcy),
+                                     _mm256_mul_ps(_mm256_set1_ps(axes.flatZ[i]), vcz));
+            inside = _mm256_and_ps(inside, _mm256_and_ps(_mm256_cmp_ps(b, _mm256_set1_ps(axes.flatLo[i]), _CMP_GE_OQ),
+                                                         _mm256_cmp_ps(b, _mm256_set1_ps(axes.flatHi[i]), _CMP_LE_OQ)));
+        }
+
+        __m256 lo = negInfinity, hi = infinity;
+        for (size_t i = 0; i < axes.slopeCount; i++) {
+            __m256 b = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(axes.slopeY[i]), vcy),
+                                     _mm256_mul_ps(_mm256_set1_ps(axes.slopeZ[i]), vcz));
+            __m256 inv = _mm256_set1_ps(axes.slopeInvX[i]);
+            __m256 t0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(axes.slopeLo[i]), b), inv);
+            __m256 t1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(axes.slopeHi[i]), b), inv);
+            lo = _mm256_max_ps(lo, _mm256_min_ps(t0, t1));
+            hi = _mm256_min_ps(hi, _mm256_max_ps(t0, t1));
+        }
+
+        _mm256_storeu_ps(xlo + row, _mm256_blendv_ps(infinity, lo, inside));
+        _mm256_storeu_ps(xhi + row, hi);
+    }
+    spansScalar(axes, cy, cz + row, count - row, xlo + row, xhi + row);
+}
+
+#endif
+
+const VoxelKernels& kernels() {
+    static const VoxelKernels selected = [] {
+#if PACKING_SIMD_X86
+        if (simd::hasAVX2()) return VoxelKernels{spansAVX2};
+        return VoxelKernels{spansSSE2};
+#else
+        return VoxelKernels{spansScalar};
+#endif
+    }();
+    return selected;
+}
+
+// Воксельная сетка прицепа по байту на воксель: строки по x, затем z, затем y
+struct VoxelGrid {
+    int sizeX = 0, sizeY = 0, sizeZ = 0;
+    std::vector<uint8_t> cells;
+
+    size_t index(int x, int y, int z) const {
+        return (static_cast<size_t>(y) * sizeZ + z) * sizeX + x;
+    }
+};
+
+// Допуск границ треугольника: его сдвиг против нормали (см. setupAxes)
+constexpr float BOUNDS_MARGIN = 1e-2f;
+
+// Индекс вокселя, содержащего координату, с ограничением [0, size - 1]
+inline int voxelOf(float coordinate, float res, int size) {
+    float index = std::floor(coordinate / res);
+    if (!(index > 0.0f)) return 0;
+    return index >= static_cast<float>(size) ? size - 1 : static_cast<int>(index);
+}
+
+constexpr uint8_t EMPTY = 0;
+constexpr uint8_t SOLID = 1;
+constexpr uint8_t REACHED = 2;
+constexpr uint8_t MERGED = 3;
+
+// Отмечает воксели слоев [y0, y1), которые пересекают треугольники из list
+void voxeliseBand(const std::vector<float>& triangles, const std::vector<uint32_t>& list, int y0, int y1,
+                  int resolution, VoxelGrid& grid) {
+    const VoxelKernels& k = kernels();
+    const float res = static_cast<float>(resolution);
+    const float half = 0.5f * res;
+    // Запись байтов сетки может указывать на что угодно - размеры и буферы
+    // держим в локальных переменных, чтобы компилятор не перечитывал их
+    const int sizeX = grid.sizeX, sizeY = grid.sizeY, sizeZ = grid.sizeZ;
+    const float limitX = static_cast<float>(sizeX) * res;
+    uint8_t* const cells = grid.cells.data();
+
+    std::vector<float> centerBuffer(sizeZ), loBuffer(sizeZ), hiBuffer(sizeZ);
+    float* const centers = centerBuffer.data();
+    float* const xlo = loBuffer.data();
+    float* const xhi = hiBuffer.data();
+    for (int z = 0; z < sizeZ; z++) centers[z] = (static_cast<float>(z) + 0.5f) * res;
+
+    TriangleAxes axes;
+    for (uint32_t triangle : list) {
+        const float* t = triangles.data() + static_cast<size_t>(triangle) * 9;
+        const Vec3 v[3] = {{t[0], t[1], t[2]}, {t[3], t[4], t[5]}, {t[6], t[7], t[8]}};
+        setupAxes(v, half, axes);
+
+        // Строки внутри ограничивающего параллелепипеда треугольника
+        const float margin = BOUNDS_MARGIN * res;
+        float minY = std::min(v[0].y, std::min(v[1].y, v[2].y)), maxY = std::max(v[0].y, std::max(v[1].y, v[2].y));
+        float minZ = std::min(v[0].z, std::min(v[1].z, v[2].z)), maxZ = std::max(v[0].z, std::max(v[1].z, v[2].z));
+        int fromY = std::max(y0, voxelOf(minY - margin, res, sizeY));
+        int toY = std::min(y1, voxelOf(maxY + margin, res, sizeY) + 1);
+        int fromZ = voxelOf(minZ - margin, res, sizeZ);
+        int toZ = voxelOf(maxZ + margin, res, sizeZ) + 1;
+        if (fromZ >= toZ) continue;
+
+        size_t rows = static_cast<size_t>(toZ - fromZ);
+        for (int y = fromY; y < toY; y++) {
+            float cy = (static_cast<float>(y) + 0.5f) * res;
+            k.spans(axes, cy, centers + fromZ, rows, xlo, xhi);
+
+            for (size_t row = 0; row < rows; row++) {
+                if (!(xlo[row] <= xhi[row])) continue;
+                // Центры (i + 0.5) * res внутри [xlo, xhi]
+                float from = std::ceil(std::max(0.0f, xlo[row]) / res - 0.5f);
+                float to = std::floor(std::min(limitX, xhi[row]) / res - 0.5f);
+                if (from > to) continue;
+                int first = static_cast<int>(from);
+                int last = std::min(sizeX - 1, static_cast<int>(to));
+                if (first > last) continue;
+                uint8_t* line = cells + (static_cast<size_t>(y) * sizeZ + fromZ + row) * sizeX;
+                std::fill(line + first, line + last + 1, SOLID);
+            }
+        }
+    }
+}
+
+// Заливка пустых вокселей от проема двери; false, если проем целиком закрыт
+bool floodFromDoor(VoxelGrid& grid, bool doorAtMaxX) {
+    std::vector<size_t> stack;
+    int doorX = doorAtMaxX ? grid.sizeX - 1 : 0;
+    for (int y = 0; y < grid.sizeY; y++) {
+        for (int z = 0; z < grid.sizeZ; z++) {
+            size_t cell = grid.index(doorX, y, z);
+            if (grid.cells[cell] != EMPTY) continue;
+            grid.cells[cell] = REACHED;
+            stack.push_back(cell);
+        }
+    }
+    if (stack.empty()) return false;
+
+    const size_t strideY = static_cast<size_t>(grid.sizeX) * grid.sizeZ;
+    const size_t strideZ = static_cast<size_t>(grid.sizeX);
+    while (!stack.empty()) {
+        size_t cell = stack.back();
+        stack.pop_back();
+
+        int x = static_cast<int>(cell % strideZ);
+        int z = static_cast<int>((cell / strideZ) % grid.sizeZ);
+        int y = static_cast<int>(cell / strideY);
+
+        auto visit = [&](size_t next) {
+            if (grid.cells[next] != EMPTY) return;
+            grid.cells[next] = REACHED;
+            stack.push_back(next);
+        };
+        if (x > 0) visit(cell - 1);
+        if (x + 1 < grid.sizeX) visit(cell + 1);
+        if (z > 0) visit(cell - strideZ);
+        if (z + 1 < grid.sizeZ) visit(cell + strideZ);
+        if (y > 0) visit(cell - strideY);
+        if (y + 1 < grid.sizeY) visit(cell + strideY);
+    }
+    return true;
+}
+
+inline void hashBytes(uint64_t& hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001B3ULL;
+    }
+}
+
+// Поля хэшируются по одному: раскладка структур и выравнивание в хэш не попадают
+inline void hashInts(uint64_t& hash, std::initializer_list<int> values) {
+    for (int value : values) hashBytes(hash, &value, sizeof(value));
+}
+
+} // namespace
+
+TrailerInterior::TrailerInterior(const TrailerSpec& trailer, int resolution, bool doorAtMaxX)
+    : trailer(trailer), resolution(resolution), doorAtMaxX(doorAtMaxX), blocked(resolution) {
+    blocked.reset(trailer);
+}
+
+std::shared_ptr<const TrailerInterior> TrailerInterior::build(const std::vector<float>& triangles,
+                                                              const TrailerSpec& trailer, bool doorAtMaxX,
+                                                              int resolution, ThreadPool* pool) {
+    resolution = std::max(1, resolution);
+    std::shared_ptr<TrailerInterior> interior(new TrailerInterior(trailer, resolution, doorAtMaxX));
+
+    VoxelGrid grid;
+    grid.sizeX = (trailer.width + resolution - 1) / resolution;
+    grid.sizeY = (trailer.height + resolution - 1) / resolution;
+    grid.sizeZ = (trailer.depth + resolution - 1) / resolution;
+    if (grid.sizeX <= 0 || grid.sizeY <= 0 || grid.sizeZ <= 0) return interior;
+    grid.cells.assign(static_cast<size_t>(grid.sizeX) * grid.sizeY * grid.sizeZ, EMPTY);
+
+    // Слои по y делятся на полосы; треугольник попадает в каждую полосу, которую
+    // задевает, поэтому полосы пишут в непересекающиеся части сетки
+    int bandCount = pool ? static_cast<int>(std::min<size_t>(pool->size() * 2, static_cast<size_t>(grid.sizeY))) : 1;
+    bandCount = std::max(1, bandCount);
+    int bandHeight = (grid.sizeY + bandCount - 1) / bandCount;
+    bandCount = (grid.sizeY + bandHeight - 1) / bandHeight;
+    std::vector<std::vector<uint32_t>> bands(bandCount);
+
+    const float res = static_cast<float>(resolution);
+    const float limitX = static_cast<float>(grid.sizeX) * res;
+    const float limitY = static_cast<float>(grid.sizeY) * res;
+    const float limitZ = static_cast<float>(grid.sizeZ) * res;
+    size_t triangleCount = triangles.size() / 9;
+    for (size_t i = 0; i < triangleCount; i++) {
+        const float* t = triangles.data() + i * 9;
+        float minX = std::min(t[0], std::min(t[3], t[6])), maxX = std::max(t[0], std::max(t[3], t[6]));
+        float minY = std::min(t[1], std::min(t[4], t[7])), maxY = std::max(t[1], std::max(t[4], t[7]));
+        float minZ = std::min(t[2], std::min(t[5], t[8])), maxZ = std::max(t[2], std::max(t[5], t[8]));
+        // Шасси под полом и кабина перед прицепом в сетку не попадают
+        if (maxX <= 0.0f || minX >= limitX || maxY <= 0.0f || minY >= limitY || maxZ <= 0.0f || minZ >= limitZ) continue;
+
+        int first = voxelOf(minY - BOUNDS_MARGIN * res, res, grid.sizeY) / bandHeight;
+        int last = voxelOf(maxY + BOUNDS_MARGIN * res, res, grid.sizeY) / bandHeight;
+        for (int band = first; band <= last; band++) bands[band].push_back(static_cast<uint32_t>(i));
+    }
+
+    if (pool && bandCount > 1) {
+        std::vector<std::future<void>> done;
+        done.reserve(bandCount);
+        for (int band = 0; band < bandCount; band++) {
+            if (bands[band].empty()) continue;
+            done.push_back(pool->async([&, band]() {
+                int y0 = band * bandHeight;
+                voxeliseBand(triangles, bands[band], y0, std::min(grid.sizeY, y0 + bandHeight), resolution, grid);
+            }));
+        }
+        for (auto& future : done) future.get();
+    } else {
+        for (int band = 0; band < bandCount; band++) {
+            int y0 = band * bandHeight;
+            voxeliseBand(triangles, bands[band], y0, std::min(grid.sizeY, y0 + bandHeight), resolution, grid);
+        }
+    }
+
+    // Недостижимые от двери пустоты (внутри колесных арок, за перегородками)
+    // занимаются вместе со стенками. Если проем закрыт целиком, модель не
+    // годится для заливки - остаются только воксели поверхности
+    bool reached = floodFromDoor(grid, doorAtMaxX);
+    for (uint8_t& cell : grid.cells) {
+        cell = (reached ? cell != REACHED : cell == SOLID) ? SOLID : EMPTY;
+    }
+
+    // Слияние занятых вокселей в параллелепипеды: по x, затем по z, затем по y
+    auto solidRun = [&grid](int x0, int x1, int y, int z) {
+        const uint8_t* cells = grid.cells.data() + grid.index(0, y, z);
+        for (int x = x0; x < x1; x++) {
+            if (cells[x] != SOLID) return false;
+        }
+        return true;
+    };
+    auto solidRect = [&](int x0, int x1, int y, int z0, int z1) {
+        for (int z = z0; z < z1; z++) {
+            if (!solidRun(x0, x1, y, z)) return false;
+        }
+        return true;
+    };
+
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    hashInts(hash, {trailer.width, trailer.height, trailer.depth, resolution});
+    for (int y = 0; y < grid.sizeY; y++) {
+        for (int z = 0; z < grid.sizeZ; z++) {
+            for (int x = 0; x < grid.sizeX; x++) {
+                if (grid.cells[grid.index(x, y, z)] != SOLID) continue;
+
+                int x1 = x + 1;
+                while (x1 < grid.sizeX && grid.cells[grid.index(x1, y, z)] == SOLID) x1++;
+                int z1 = z + 1;
+                while (z1 < grid.sizeZ && solidRun(x, x1, y, z1)) z1++;
+                int y1 = y + 1;
+                while (y1 < grid.sizeY && solidRect(x, x1, y1, z, z1)) y1++;
+
+                for (int vy = y; vy < y1; vy++) {
+                    for (int vz = z; vz < z1; vz++) {
+                        uint8_t* cells = grid.cells.data() + grid.index(0, vy, vz);
+                        std::fill(cells + x, cells + x1, MERGED);
+                    }
+                }
+
+                // Последний воксель может выходить за габарит прицепа
+                Placement obstacle{OBSTACLE, x * resolution, y * resolution, z * resolution, 0, 0, 0, 0};
+                obstacle.width = std::min(trailer.width, x1 * resolution) - obstacle.x;
+                obstacle.height = std::min(trailer.height, y1 * resolution) - obstacle.y;
+                obstacle.depth = std::min(trailer.depth, z1 * resolution) - obstacle.z;
+
+                interior->obstacles.push_back(obstacle);
+                interior->obstacleVolume += obstacle.volume();
+                interior->blocked.stamp(obstacle);
+                hashInts(hash, {obstacle.x, obstacle.y, obstacle.z, obstacle.width, obstacle.height, obstacle.depth});
+            }
+        }
+    }
+    interior->fingerprint = hash;
+    return interior;
+}
+
+double TrailerInterior::usableRatio() const {
+    long long capacity = trailer.volume();
+    return capacity > 0 ? static_cast<double>(usableVolume()) / static_cast<double>(capacity) : 0.0;
+}
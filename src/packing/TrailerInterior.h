@@ -0,0 +1,60 @@
+#ifndef TRAILERINTERIOR_H
+#define TRAILERINTERIOR_H
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Cargo.h"
+#include "LoadPlan.h"
+#include "OccupancyGrid.h"
+#include "ThreadPool.h"
+
+// Полезный объем прицепа с учетом геометрии кузова: колесных арок, стоек,
+// рам дверей. Строится один раз на модель и прицеп вокселизацией сетки:
+// воксели, которые пересекает треугольник (тест разделяющих осей), - стенки,
+// а свободным считается только объем, достижимый от проема двери. Все
+// остальное слито в параллелепипеды-препятствия, которые упаковщик ставит
+// в состояние до первой коробки, - сетка при упаковке больше не нужна.
+//
+// Координаты - см в системе груза сцены, как у LoadPlan: x от передней
+// стенки, y от пола, z от 0 до depth.
+class TrailerInterior {
+private:
+    TrailerSpec trailer;
+    int resolution;
+    bool doorAtMaxX;
+    OccupancyGrid blocked;
+    std::vector<Placement> obstacles;
+    long long obstacleVolume = 0;
+    uint64_t fingerprint = 0;
+
+    TrailerInterior(const TrailerSpec& trailer, int resolution, bool doorAtMaxX);
+
+public:
+    // Номер "коробки" у препятствий
+    static constexpr uint32_t OBSTACLE = 0xFFFFFFFFu;
+
+    // triangles - по 9 float на треугольник (вершины x, y, z) в см системы груза.
+    // Слои по y вокселизируются параллельно на pool (nullptr - в текущем потоке);
+    // из потока того же пула вызывать нельзя.
+    static std::shared_ptr<const TrailerInterior> build(const std::vector<float>& triangles, const TrailerSpec& trailer,
+                                                        bool doorAtMaxX, int resolution = 5, ThreadPool* pool = nullptr);
+
+    const TrailerSpec& getTrailer() const { return trailer; }
+    int getResolution() const { return resolution; }
+    bool isDoorAtMaxX() const { return doorAtMaxX; }
+
+    // Занятые воксели внутри габарита прицепа
+    const OccupancyGrid& getBlocked() const { return blocked; }
+    const std::vector<Placement>& getObstacles() const { return obstacles; }
+
+    long long usableVolume() const { return trailer.volume() - obstacleVolume; }
+    double usableRatio() const;
+
+    // Хэш препятствий - часть ключа кэша планов
+    uint64_t hash() const { return fingerprint; }
+};
+
+#endif //TRAILERINTERIOR_H
@@ -0,0 +1,215 @@
+#include "UnloadingOrder.h"
+#include "Simd.h"
+#include <algorithm>
+
+namespace {
+
+// Столбцы коробок одной группы: minX, minY, minZ, maxX, maxY, maxZ
+using BoxColumns = const int* const*;
+
+// Границы кандидата для пакетной проверки. Коробка и кандидат мешают друг другу,
+// если пересекаются по z и либо одна стоит ближе к двери при пересечении по y,
+// либо стоит сверху при пересечении по x. later - кто из двоих выгружается позже.
+struct Probe {
+    int x, y, z, maxX, maxY, maxZ;
+    bool boxIsLater;
+};
+
+// ---------------- Scalar ----------------
+
+bool blocksScalar(BoxColumns c, size_t i, const Probe& p) {
+    bool overlapX = c[0][i] < p.maxX && p.x < c[3][i];
+    bool overlapY = c[1][i] < p.maxY && p.y < c[4][i];
+    bool overlapZ = c[2][i] < p.maxZ && p.z < c[5][i];
+    if (!overlapZ) return false;
+
+    // later мешает выгрузить earlier, если стоит между ним и дверью или сверху
+    bool front = p.boxIsLater ? c[0][i] >= p.maxX : p.x >= c[3][i];
+    bool top = p.boxIsLater ? c[1][i] >= p.maxY : p.y >= c[4][i];
+    return (overlapY && front) || (overlapX && top);
+}
+
+bool anyBlockingScalar(BoxColumns c, size_t from, size_t count, const Probe& p) {
+    for (size_t i = from; i < count; i++) {
+        if (blocksScalar(c, i, p)) return true;
+    }
+    return false;
+}
+
+#if PACKING_SIMD_X86
+
+// ---------------- SSE2 ----------------
+// a < b проверяется как b > a, a >= b - как a > b - 1
+
+inline __m128i load4(const int* column, size_t i) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + i));
+}
+
+// Границы кандидата, размноженные по дорожкам
+enum ProbeLane { LANE_X, LANE_Y, LANE_Z, LANE_MAX_X, LANE_MAX_Y, LANE_MAX_Z, LANE_FRONT, LANE_TOP, LANE_COUNT };
+
+void probeLanes(const Probe& p, int* lanes) {
+    lanes[LANE_X] = p.x;
+    lanes[LANE_Y] = p.y;
+    lanes[LANE_Z] = p.z;
+    lanes[LANE_MAX_X] = p.maxX;
+    lanes[LANE_MAX_Y] = p.maxY;
+    lanes[LANE_MAX_Z] = p.maxZ;
+    lanes[LANE_FRONT] = p.boxIsLater ? p.maxX - 1 : p.x + 1;
+    lanes[LANE_TOP] = p.boxIsLater ? p.maxY - 1 : p.y + 1;
+}
+
+inline __m128i hitsSSE2(BoxColumns c, size_t i, const __m128i* v, bool boxIsLater) {
+    __m128i lowX = load4(c[0], i), lowY = load4(c[1], i), lowZ = load4(c[2], i);
+    __m128i highX = load4(c[3], i), highY = load4(c[4], i), highZ = load4(c[5], i);
+
+    __m128i overlapX = _mm_and_si128(_mm_cmpgt_epi32(v[LANE_MAX_X], lowX), _mm_cmpgt_epi32(highX, v[LANE_X]));
+    __m128i overlapY = _mm_and_si128(_mm_cmpgt_epi32(v[LANE_MAX_Y], lowY), _mm_cmpgt_epi32(highY, v[LANE_Y]));
+    __m128i overlapZ = _mm_and_si128(_mm_cmpgt_epi32(v[LANE_MAX_Z], lowZ), _mm_cmpgt_epi32(highZ, v[LANE_Z]));
+    __m128i front = boxIsLater ? _mm_cmpgt_epi32(lowX, v[LANE_FRONT]) : _mm_cmpgt_epi32(v[LANE_FRONT], highX);
+    __m128i top = boxIsLater ? _mm_cmpgt_epi32(lowY, v[LANE_TOP]) : _mm_cmpgt_epi32(v[LANE_TOP], highY);
+    return _mm_and_si128(overlapZ, _mm_or_si128(_mm_and_si128(overlapY, front), _mm_and_si128(overlapX, top)));
+}
+
+bool anyBlockingSSE2(BoxColumns c, size_t count, const Probe& p) {
+    int lanes[LANE_COUNT];
+    probeLanes(p, lanes);
+    __m128i v[LANE_COUNT];
+    for (int k = 0; k < LANE_COUNT; k++) v[k] = _mm_set1_epi32(lanes[k]);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        if (_mm_movemask_ps(_mm_castsi128_ps(hitsSSE2(c, i, v, p.boxIsLater)))) return true;
+    }
+    return anyBlockingScalar(c, i, count, p);
+}
+
+// ---------------- AVX2 ----------------
+
+PACKING_TARGET_AVX2 inline __m256i load8(const int* column, size_t i) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + i));
+}
+
+PACKING_TARGET_AVX2 inline __m256i hitsAVX2(BoxColumns c, size_t i, const __m256i* v, bool boxIsLater) {
+    __m256i lowX = load8(c[0], i), lowY = load8(c[1], i), lowZ = load8(c[2], i);
+    __m256i highX = load8(c[3], i), highY = load8(c[4], i), highZ = load8(c[5], i);
+
+    __m256i overlapX = _mm256_and_si256(_mm256_cmpgt_epi32(v[LANE_MAX_X], lowX), _mm256_cmpgt_epi32(highX, v[LANE_X]));
+    __m256i overlapY = _mm256_and_si256(_mm256_cmpgt_epi32(v[LANE_MAX_Y], lowY), _mm256_cmpgt_epi32(highY, v[LANE_Y]));
+    __m256i overlapZ = _mm256_and_si256(_mm256_cmpgt_epi32(v[LANE_MAX_Z], lowZ), _mm256_cmpgt_epi32(highZ, v[LANE_Z]));
+    __m256i front = boxIsLater ? _mm256_cmpgt_epi32(lowX, v[LANE_FRONT]) : _mm256_cmpgt_epi32(v[LANE_FRONT], highX);
+    __m256i top = boxIsLater ? _mm256_cmpgt_epi32(lowY, v[LANE_TOP]) : _mm256_cmpgt_epi32(v[LANE_TOP], highY);
+    return _mm256_and_si256(overlapZ, _mm256_or_si256(_mm256_and_si256(overlapY, front), _mm256_and_si256(overlapX, top)));
+}
+
+PACKING_TARGET_AVX2 bool anyBlockingAVX2(BoxColumns c, size_t count, const Probe& p) {
+    int lanes[LANE_COUNT];
+    probeLanes(p, lanes);
+    __m256i v[LANE_COUNT];
+    for (int k = 0; k < LANE_COUNT; k++) v[k] = _mm256_set1_epi32(lanes[k]);
+
+    // Два блока по 8 коробок за итерацию
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i hit = _mm256_or_si256(hitsAVX2(c, i, v, p.boxIsLater), hitsAVX2(c, i + 8, v, p.boxIsLater));
+        if (!_mm256_testz_si256(hit, hit)) return true;
+    }
+    for (; i + 8 <= count; i += 8) {
+        __m256i hit = hitsAVX2(c, i, v, p.boxIsLater);
+        if (!_mm256_testz_si256(hit, hit)) return true;
+    }
+    return anyBlockingScalar(c, i, count, p);
+}
+
+#else
+
+bool anyBlockingPortable(BoxColumns c, size_t count, const Probe& p) {
+    return anyBlockingScalar(c, 0, count, p);
+}
+
+#endif // PACKING_SIMD_X86
+
+using AnyBlocking = bool (*)(BoxColumns c, size_t count, const Probe& p);
+
+AnyBlocking anyBlocking() {
+    static const AnyBlocking selected = [] {
+#if PACKING_SIMD_X86
+        return simd::hasAVX2() ? anyBlockingAVX2 : anyBlockingSSE2;
+#else
+        return anyBlockingPortable;
+#endif
+    }();
+    return selected;
+}
+
+} // namespace
+
+void UnloadingOrder::reset(size_t stopCount) {
+    // Столбцы очищаются с сохранением емкости - состояние упаковщика переиспользуется поиском
+    groups.resize(stopCount);
+    for (StopGroup& group : groups) {
+        group.minX = INT_MAX;
+        group.maxX = INT_MIN;
+        for (std::vector<int>* column : {&group.boxMinX, &group.boxMinY, &group.boxMinZ,
+                                         &group.boxMaxX, &group.boxMaxY, &group.boxMaxZ}) {
+            column->clear();
+        }
+    }
+}
+
+bool UnloadingOrder::allows(const Placement& candidate, uint16_t stop) const {
+    if (!enabled()) return true;
+
+    Probe probe{candidate.x, candidate.y, candidate.z, candidate.maxX(), candidate.maxY(), candidate.maxZ(), false};
+    AnyBlocking kernel = anyBlocking();
+
+    // Быстрый путь по габаритам групп: при заполнении от передней стенки поздние
+    // точки оказываются глубже кандидата, ранние - ближе к двери, и перебор не нужен
+    for (size_t s = 0; s < groups.size(); s++) {
+        const StopGroup& group = groups[s];
+        if (s == stop || group.size() == 0) continue;
+
+        if (s > stop) {
+            if (group.maxX <= candidate.x) continue;
+        } else {
+            if (group.minX >= candidate.maxX()) continue;
+        }
+
+        const int* columns[6] = {group.boxMinX.data(), group.boxMinY.data(), group.boxMinZ.data(),
+                                 group.boxMaxX.data(), group.boxMaxY.data(), group.boxMaxZ.data()};
+        probe.boxIsLater = s > stop;
+        if (kernel(columns, group.size(), probe)) return false;
+    }
+    return true;
+}
+
+void UnloadingOrder::add(const Placement& placement, uint16_t stop) {
+    if (!enabled()) return;
+
+    StopGroup& group = groups[stop];
+    group.minX = std::min(group.minX, placement.x);
+    group.maxX = std::max(group.maxX, placement.maxX());
+    group.boxMinX.push_back(placement.x);
+    group.boxMinY.push_back(placement.y);
+    group.boxMinZ.push_back(placement.z);
+    group.boxMaxX.push_back(placement.maxX());
+    group.boxMaxY.push_back(placement.maxY());
+    group.boxMaxZ.push_back(placement.maxZ());
+}
+
+void UnloadingOrder::removeLast(uint16_t stop) {
+    if (!enabled() || groups[stop].size() == 0) return;
+
+    StopGroup& group = groups[stop];
+    for (std::vector<int>* column : {&group.boxMinX, &group.boxMinY, &group.boxMinZ,
+                                     &group.boxMaxX, &group.boxMaxY, &group.boxMaxZ}) {
+        column->pop_back();
+    }
+    // Границы группы только расширялись, поэтому после снятия считаются заново
+    group.minX = INT_MAX;
+    group.maxX = INT_MIN;
+    for (size_t i = 0; i < group.size(); i++) {
+        group.minX = std::min(group.minX, group.boxMinX[i]);
+        group.maxX = std::max(group.maxX, group.boxMaxX[i]);
+    }
+}
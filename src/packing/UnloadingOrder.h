@@ -0,0 +1,40 @@
+#ifndef UNLOADINGORDER_H
+#define UNLOADINGORDER_H
+
+#pragma once
+
+#include <climits>
+#include <cstdint>
+#include <vector>
+#include "LoadPlan.h"
+
+// Ограничение порядка разгрузки (LIFO) для маршрута с несколькими точками.
+// Работает в системе координат упаковщика, где дверь прицепа - на стороне max x.
+// Коробка точки s не может стоять дальше от двери, чем коробка более поздней
+// точки (с перекрытием по сечению y-z), и не может оказаться под ней.
+class UnloadingOrder {
+private:
+    // Коробки группы хранятся столбцами: кандидат проверяется пачками по 8-16 коробок
+    struct StopGroup {
+        int minX = INT_MAX;
+        int maxX = INT_MIN;
+        std::vector<int> boxMinX, boxMinY, boxMinZ, boxMaxX, boxMaxY, boxMaxZ;
+
+        size_t size() const { return boxMinX.size(); }
+    };
+
+    std::vector<StopGroup> groups;   // Индекс - номер точки разгрузки
+
+public:
+    void reset(size_t stopCount);
+
+    // true, если коробку точки stop можно поставить в candidate
+    bool allows(const Placement& candidate, uint16_t stop) const;
+    void add(const Placement& placement, uint16_t stop);
+    // Снимает последнюю коробку точки stop
+    void removeLast(uint16_t stop);
+
+    bool enabled() const { return groups.size() > 1; }
+};
+
+#endif //UNLOADINGORDER_H
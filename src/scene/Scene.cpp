@@ -1,15 +1,32 @@
 #include "Scene.h"
 #include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 
+namespace {
+
+std::shared_future<std::shared_ptr<const TrailerInterior>> readyInterior(std::shared_ptr<const TrailerInterior> value) {
+    std::promise<std::shared_ptr<const TrailerInterior>> ready;
+    ready.set_value(std::move(value));
+    return ready.get_future().share();
+}
+
+} // namespace
+
 Scene::Scene() {
     // Инициализация сцены
+    cargoMesh = createUnitCube();
+    deckMesh = createUnitCube();
+    rollMesh = createUnitCylinder();
 }
 
 void Scene::loadTruckModel(const std::string& path) {
     try {
         truckModel = std::make_unique<Model>(path);
+        interiors.clear();
         std::cout << "Truck model loaded successfully from: " << path << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "Failed to load truck model: " << e.what() << std::endl;
@@ -27,31 +44,446 @@ void Scene::loadWheelModel(const std::string& path) {
     }
 }
 
+void Scene::setLoadPlan(const LoadPlan& plan, const Manifest& manifest) {
+    clearCargo();
+    cargoTransforms.reserve(plan.placements.size());
+    cargoColors.reserve(plan.placements.size());
+    addLane(plan, manifest, glm::vec3(0.0f));
+    uploadInstances();
+}
+
+void Scene::setFleetPlan(const FleetPlan& fleet, const Manifest& manifest) {
+    clearCargo();
+
+    size_t total = fleet.placedCount();
+    cargoTransforms.reserve(total);
+    cargoColors.reserve(total);
+
+    // Шаг полос - по самому широкому прицепу, первая машина остается на месте
+    int maxDepth = 0;
+    for (const auto& load : fleet.loads) {
+        maxDepth = std::max(maxDepth, load.plan.trailer.depth);
+    }
+    float step = maxDepth * cargoScale + laneGap;
+
+    for (size_t i = 0; i < fleet.loads.size(); i++) {
+        addLane(fleet.loads[i].plan, manifest, glm::vec3(0.0f, 0.0f, step * static_cast<float>(i)));
+    }
+    uploadInstances();
+}
+
+void Scene::setPalletPlan(const PalletizedPlan& plan, const Manifest& cartons, const std::vector<PalletSpec>& specs) {
+    clearCargo();
+
+    const TrailerSpec& trailer = plan.trailerPlan.trailer;
+    float halfDepth = trailer.depth * 0.5f;
+
+    Lane lane = beginLane(glm::vec3(0.0f));
+    glm::vec3 origin = cargoOrigin + lane.offset;
+
+    for (const auto& placement : plan.trailerPlan.placements) {
+        const BuiltPallet& pallet = plan.built[placement.item];
+        int deckHeight = specs[pallet.spec].deckHeight;
+
+        glm::vec3 corner(placement.x, placement.y, placement.z - halfDepth);
+        deckTransforms.push_back(boxTransform(origin, corner,
+                                              glm::vec3(placement.width, deckHeight, placement.depth)));
+        deckColors.push_back(glm::vec3(0.60f, 0.45f, 0.28f));
+
+        // Поддон мог быть повернут вокруг вертикали: тогда x и z его груза меняются местами
+        bool rotated = placement.orientation == ORIENT_DHW;
+        for (const auto& carton : pallet.cartons.placements) {
+            glm::vec3 offset = rotated ? glm::vec3(carton.z, carton.y, carton.x) : glm::vec3(carton.x, carton.y, carton.z);
+            glm::vec3 size = rotated ? glm::vec3(carton.depth, carton.height, carton.width)
+                                     : glm::vec3(carton.width, carton.height, carton.depth);
+
+            cargoTransforms.push_back(boxTransform(origin, corner + glm::vec3(0.0f, deckHeight, 0.0f) + offset, size));
+            cargoColors.push_back(cargoColor(cartons.items[carton.item]));
+        }
+    }
+
+    finishLane(lane, trailer);
+    uploadInstances();
+}
+
+glm::vec3 Scene::cargoColor(uint32_t type) {
+    static const glm::vec3 palette[] = {
+        glm::vec3(0.80f, 0.55f, 0.30f),
+        glm::vec3(0.35f, 0.60f, 0.85f),
+        glm::vec3(0.45f, 0.75f, 0.40f),
+        glm::vec3(0.85f, 0.75f, 0.30f),
+        glm::vec3(0.70f, 0.40f, 0.70f),
+        glm::vec3(0.85f, 0.40f, 0.40f)
+    };
+    const size_t paletteSize = sizeof(palette) / sizeof(palette[0]);
+    return palette[type % paletteSize];
+}
+
+glm::mat4 Scene::boxTransform(const glm::vec3& origin, const glm::vec3& corner, const glm::vec3& size) const {
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::translate(model, origin + (corner + size * 0.5f) * cargoScale);
+    model = glm::scale(model, size * cargoScale);
+    return model;
+}
+
+glm::mat4 Scene::rollTransform(const glm::vec3& origin, const glm::vec3& corner, const Placement& placement) const {
+    glm::vec3 size(placement.width, placement.height, placement.depth);
+    int axis = BoxType::cylinderAxis(placement.orientation);
+
+    // Ось единичного цилиндра - y: масштаб задается до поворота на ось груза
+    float diameter = axis == 1 ? size.x : size.y;
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::translate(model, origin + (corner + size * 0.5f) * cargoScale);
+    if (axis == 0) model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    if (axis == 2) model = glm::rotate(model, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+    model = glm::scale(model, glm::vec3(diameter, size[axis], diameter) * cargoScale);
+    return model;
+}
+
+Scene::Lane Scene::beginLane(const glm::vec3& offset) const {
+    Lane lane;
+    lane.offset = offset;
+    lane.cargoBegin = cargoTransforms.size();
+    lane.deckBegin = deckTransforms.size();
+    lane.rollBegin = rollTransforms.size();
+    return lane;
+}
+
+void Scene::finishLane(Lane& lane, const TrailerSpec& trailer) {
+    lane.cargoEnd = cargoTransforms.size();
+    lane.deckEnd = deckTransforms.size();
+    lane.rollEnd = rollTransforms.size();
+
+    // Границы полосы: прицеп вместе с моделями тягача и колес
+    float halfDepth = trailer.depth * 0.5f;
+    glm::vec3 origin = cargoOrigin + lane.offset;
+    lane.boundsMin = origin + glm::vec3(0.0f, 0.0f, -halfDepth * cargoScale);
+    lane.boundsMax = origin + glm::vec3(trailer.width, trailer.height, halfDepth) * cargoScale;
+    if (truckModel) {
+        lane.boundsMin = glm::min(lane.boundsMin, truckPosition + lane.offset + truckModel->getMinBounds());
+        lane.boundsMax = glm::max(lane.boundsMax, truckPosition + lane.offset + truckModel->getMaxBounds());
+    }
+    if (wheelModel) {
+        lane.boundsMin = glm::min(lane.boundsMin, wheelPosition + lane.offset + wheelModel->getMinBounds());
+        lane.boundsMax = glm::max(lane.boundsMax, wheelPosition + lane.offset + wheelModel->getMaxBounds());
+    }
+
+    lanes.push_back(lane);
+}
+
+void Scene::addLane(const LoadPlan& plan, const Manifest& manifest, const glm::vec3& offset) {
+    Lane lane = beginLane(offset);
+
+    // Прицеп центрируем по ширине кузова (ось z)
+    float halfDepth = plan.trailer.depth * 0.5f;
+    glm::vec3 origin = cargoOrigin + offset;
+
+    for (const auto& placement : plan.placements) {
+        glm::vec3 corner(placement.x, placement.y, placement.z - halfDepth);
+        uint32_t type = manifest.items[placement.item];
+
+        if (manifest.types[type].isCylinder()) {
+            rollTransforms.push_back(rollTransform(origin, corner, placement));
+            rollColors.push_back(cargoColor(type));
+            continue;
+        }
+        glm::vec3 size(placement.width, placement.height, placement.depth);
+        cargoTransforms.push_back(boxTransform(origin, corner, size));
+        cargoColors.push_back(cargoColor(type));
+    }
+
+    finishLane(lane, plan.trailer);
+}
+
+void Scene::uploadInstances() {
+    // Данные экземпляров меняются только вместе с планом, а не каждый кадр
+    if (cargoMesh) cargoMesh->setInstances(cargoTransforms, cargoColors);
+    if (deckMesh) deckMesh->setInstances(deckTransforms, deckColors);
+    if (rollMesh) rollMesh->setInstances(rollTransforms, rollColors);
+}
+
+void Scene::clearCargo() {
+    cargoTransforms.clear();
+    cargoColors.clear();
+    deckTransforms.clear();
+    deckColors.clear();
+    rollTransforms.clear();
+    rollColors.clear();
+    lanes.clear();
+}
+
+bool Scene::isBoxVisible(const glm::mat4& viewProjection, const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+    // Плоскости отсечения из строк матрицы (Gribb, Hartmann); glm хранит по столбцам
+    glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+    glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+    glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+    glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+    const glm::vec4 planes[6] = {
+        row3 + row0, row3 - row0,
+        row3 + row1, row3 - row1,
+        row3 + row2, row3 - row2
+    };
+
+    for (const auto& plane : planes) {
+        // Вершина коробки, дальше всех продвинутая вдоль нормали плоскости
+        glm::vec3 corner(plane.x >= 0.0f ? boundsMax.x : boundsMin.x,
+                         plane.y >= 0.0f ? boundsMax.y : boundsMin.y,
+                         plane.z >= 0.0f ? boundsMax.z : boundsMin.z);
+        if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) return false;
+    }
+    return true;
+}
+
+float Scene::toCargoX(float worldX) const {
+    return (worldX - cargoOrigin.x) / cargoScale;
+}
+
+AxleLayout Scene::getAxleLayout(const TrailerSpec& trailer) const {
+    AxleLayout axles;
+    float length = static_cast<float>(trailer.width);
+
+    // Передняя опора - задний край тягача (седельное устройство),
+    // задняя - центр колесной группы, как они расставлены в render()
+    float front = truckModel ? toCargoX(truckPosition.x + truckModel->getMaxBounds().x) : 0.0f;
+    float rear = toCargoX(wheelPosition.x + (wheelModel ? wheelModel->getCenter().x * cargoScale : 0.0f));
+
+    axles.frontPosition = std::max(0.0f, std::min(length, front));
+    axles.rearPosition = std::max(0.0f, std::min(length, rear));
+    if (axles.rearPosition <= axles.frontPosition) {
+        axles.rearPosition = length * 0.8f;
+    }
+    axles.enabled = true;
+    return axles;
+}
+
+bool Scene::isDoorAtMaxX(const TrailerSpec& trailer) const {
+    // Дверь - в торце прицепа, противоположном тягачу
+    if (!truckModel) return true;
+    float tractor = toCargoX(truckPosition.x + truckModel->getCenter().x);
+    return tractor < trailer.width * 0.5f;
+}
+
+void Scene::appendCargoTriangles(const Model& model, const glm::vec3& position, const TrailerSpec& trailer,
+                                 std::vector<float>& triangles) const {
+    // Модели рисуются только со сдвигом position, груз - от cargoOrigin с центром по z
+    glm::vec3 offset = (position - cargoOrigin) / cargoScale + glm::vec3(0.0f, 0.0f, trailer.depth * 0.5f);
+    glm::vec3 limit(trailer.width, trailer.height, trailer.depth);
+    for (const auto& mesh : model.getMeshes()) {
+        const std::vector<Vertex>& vertices = mesh->getVertices();
+        const std::vector<unsigned int>& indices = mesh->getIndices();
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            glm::vec3 a = vertices[indices[i]].position / cargoScale + offset;
+            glm::vec3 b = vertices[indices[i + 1]].position / cargoScale + offset;
+            glm::vec3 c = vertices[indices[i + 2]].position / cargoScale + offset;
+
+            // Треугольники вне габарита груза не дают ни одного вокселя
+            glm::vec3 low = glm::min(a, glm::min(b, c));
+            glm::vec3 high = glm::max(a, glm::max(b, c));
+            if (glm::any(glm::lessThan(high, glm::vec3(0.0f))) || glm::any(glm::greaterThan(low, limit))) continue;
+
+            for (const glm::vec3& point : {a, b, c}) {
+                triangles.push_back(point.x);
+                triangles.push_back(point.y);
+                triangles.push_back(point.z);
+            }
+        }
+    }
+}
+
+std::vector<float> Scene::cargoTriangles(const TrailerSpec& trailer) const {
+    std::vector<float> triangles;
+    if (truckModel) appendCargoTriangles(*truckModel, truckPosition, trailer, triangles);
+    return triangles;
+}
+
+std::shared_ptr<const TrailerInterior> Scene::getInterior(const TrailerSpec& trailer, ThreadPool* pool) const {
+    bool doorAtMaxX = isDoorAtMaxX(trailer);
+    auto slot = std::find_if(interiors.begin(), interiors.end(), [&](const InteriorSlot& cached) {
+        return cached.trailer == trailer && cached.doorAtMaxX == doorAtMaxX;
+    });
+
+    if (slot == interiors.end()) {
+        // Треугольники копируются в задачу: сцена может смениться, пока объем строится.
+        // Слои задача вокселизует сама - из потока пула нельзя ждать его же задач
+        auto build = [triangles = cargoTriangles(trailer), trailer, doorAtMaxX]() {
+            return triangles.empty() ? std::shared_ptr<const TrailerInterior>()
+                                     : TrailerInterior::build(triangles, trailer, doorAtMaxX, 5, nullptr);
+        };
+        auto interior = pool ? pool->async(std::move(build)).share() : readyInterior(build());
+        if (interiors.size() == MAX_INTERIORS) interiors.pop_back();
+        interiors.insert(interiors.begin(), InteriorSlot{trailer, doorAtMaxX, std::move(interior)});
+        slot = interiors.begin();
+    }
+
+    if (slot->interior.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return nullptr;
+    try {
+        return slot->interior.get();
+    } catch (const std::exception& e) {
+        // Без объема кузова упаковка идет в пустой параллелепипед
+        std::cerr << "Failed to build trailer interior: " << e.what() << std::endl;
+        slot->interior = readyInterior(nullptr);
+        return nullptr;
+    }
+}
+
+bool Scene::isInteriorBuilding(const TrailerSpec& trailer) const {
+    bool doorAtMaxX = isDoorAtMaxX(trailer);
+    for (const InteriorSlot& slot : interiors) {
+        if (slot.trailer == trailer && slot.doorAtMaxX == doorAtMaxX) {
+            return slot.interior.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+        }
+    }
+    return false;
+}
+
 void Scene::update(float deltaTime) {
     // Обновление логики сцены
     // Пока ничего не делаем
 }
 
-void Scene::render(const Shader& shader) const {
-    // Render truck
-    if (truckModel) {
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(-4.0f, -1.25f, 0.0f));
-        model = glm::scale(model, glm::vec3(1.0f, 1.0f, 1.0f));
-        shader.setMat4("model", model);
+void Scene::render(const Shader& shader, const glm::mat4& viewProjection) const {
+    // Без плана - одна машина без груза
+    static const Lane emptyLane = {glm::vec3(0.0f), 0, 0, 0, 0, 0, 0, glm::vec3(0.0f), glm::vec3(0.0f)};
+    const Lane* begin = lanes.empty() ? &emptyLane : lanes.data();
+    const Lane* end = lanes.empty() ? &emptyLane + 1 : lanes.data() + lanes.size();
+
+    for (const Lane* lane = begin; lane != end; lane++) {
+        if (!lanes.empty() && !isBoxVisible(viewProjection, lane->boundsMin, lane->boundsMax)) continue;
+
+        // Render truck
+        if (truckModel) {
+            glm::mat4 model = glm::mat4(1.0f);
+            model = glm::translate(model, truckPosition + lane->offset);
+            model = glm::scale(model, glm::vec3(1.0f, 1.0f, 1.0f));
+            shader.setMat4("model", model);
+
+            shader.setBool("use_material_override", false);
+            truckModel->draw(shader);
+        }
+
+        // Render wheel
+        if (wheelModel) {
+            glm::mat4 model = glm::mat4(1.0f);
+            model = glm::translate(model, wheelPosition + lane->offset);
+            model = glm::scale(model, glm::vec3(1.0f, 1.0f, 1.0f));
+            shader.setMat4("model", model);
 
+            shader.setBool("use_material_override", false);
+            wheelModel->draw(shader);
+        }
+
+        // Render cargo: каждая группа полосы - один инстансный вызов
+        shader.setBool("use_material_override", true);
+        if (cargoMesh) {
+            cargoMesh->drawInstances(shader, lane->cargoBegin, lane->cargoEnd - lane->cargoBegin);
+        }
+        if (deckMesh) {
+            deckMesh->drawInstances(shader, lane->deckBegin, lane->deckEnd - lane->deckBegin);
+        }
+        if (rollMesh) {
+            rollMesh->drawInstances(shader, lane->rollBegin, lane->rollEnd - lane->rollBegin);
+        }
         shader.setBool("use_material_override", false);
-        truckModel->draw(shader);
     }
+}
 
-    // Render wheel
-    if (wheelModel) {
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(0.5f, -1.25f, 0.0f));
-        model = glm::scale(model, glm::vec3(1.0f, 1.0f, 1.0f));
-        shader.setMat4("model", model);
+std::unique_ptr<Mesh> Scene::createUnitCube() {
+    // Куб с центром в начале координат и ребром 1, по 4 вершины на грань для плоских нормалей
+    static const glm::vec3 normals[6] = {
+        glm::vec3( 1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+        glm::vec3( 0.0f, 1.0f, 0.0f), glm::vec3( 0.0f,-1.0f, 0.0f),
+        glm::vec3( 0.0f, 0.0f, 1.0f), glm::vec3( 0.0f, 0.0f,-1.0f)
+    };
 
-        shader.setBool("use_material_override", false);
-        wheelModel->draw(shader);
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    vertices.reserve(24);
+    indices.reserve(36);
+
+    for (const auto& normal : normals) {
+        glm::vec3 tangent = glm::abs(normal.y) > 0.5f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::vec3 bitangent = glm::cross(normal, tangent);
+
+        unsigned int base = static_cast<unsigned int>(vertices.size());
+        const glm::vec2 corners[4] = {
+            glm::vec2(-0.5f, -0.5f), glm::vec2(0.5f, -0.5f),
+            glm::vec2(0.5f, 0.5f), glm::vec2(-0.5f, 0.5f)
+        };
+        for (const auto& corner : corners) {
+            Vertex vertex;
+            vertex.position = normal * 0.5f + tangent * corner.x + bitangent * corner.y;
+            vertex.normal = normal;
+            vertex.texCoords = corner + glm::vec2(0.5f);
+            vertex.tangent = tangent;
+            vertex.bitangent = bitangent;
+            vertices.push_back(vertex);
+        }
+
+        indices.insert(indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+    }
+
+    return std::make_unique<Mesh>(vertices, indices, std::vector<Texture>(), Material::createPlastic(glm::vec3(0.8f)));
+}
+
+std::unique_ptr<Mesh> Scene::createUnitCylinder(int segments) {
+    // Боковая поверхность с гладкими нормалями и два торца с плоскими:
+    // вершины на краю торца дублируются, чтобы ребро оставалось резким
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    vertices.reserve(static_cast<size_t>(segments + 1) * 4 + 2);
+    indices.reserve(static_cast<size_t>(segments) * 12);
+
+    const float pi = glm::pi<float>();
+    for (int i = 0; i <= segments; i++) {
+        float u = static_cast<float>(i) / static_cast<float>(segments);
+        glm::vec3 normal(glm::cos(2.0f * pi * u), 0.0f, glm::sin(2.0f * pi * u));
+        glm::vec3 tangent(-normal.z, 0.0f, normal.x);
+
+        for (float y : {-0.5f, 0.5f}) {
+            Vertex vertex;
+            vertex.position = normal * 0.5f + glm::vec3(0.0f, y, 0.0f);
+            vertex.normal = normal;
+            vertex.texCoords = glm::vec2(u, y + 0.5f);
+            vertex.tangent = tangent;
+            vertex.bitangent = glm::vec3(0.0f, 1.0f, 0.0f);
+            vertices.push_back(vertex);
+        }
+        if (i < segments) {
+            unsigned int base = static_cast<unsigned int>(i * 2);
+            indices.insert(indices.end(), {base, base + 1, base + 3, base, base + 3, base + 2});
+        }
     }
-}
\ No newline at end of file
+
+    for (float y : {-0.5f, 0.5f}) {
+        glm::vec3 normal(0.0f, y > 0.0f ? 1.0f : -1.0f, 0.0f);
+        unsigned int center = static_cast<unsigned int>(vertices.size());
+
+        Vertex vertex;
+        vertex.position = glm::vec3(0.0f, y, 0.0f);
+        vertex.normal = normal;
+        vertex.texCoords = glm::vec2(0.5f);
+        vertex.tangent = glm::vec3(1.0f, 0.0f, 0.0f);
+        vertex.bitangent = glm::cross(normal, vertex.tangent);
+        vertices.push_back(vertex);
+
+        for (int i = 0; i <= segments; i++) {
+            float angle = 2.0f * pi * static_cast<float>(i) / static_cast<float>(segments);
+            glm::vec2 rim(glm::cos(angle) * 0.5f, glm::sin(angle) * 0.5f);
+            vertex.position = glm::vec3(rim.x, y, rim.y);
+            vertex.texCoords = rim + glm::vec2(0.5f);
+            vertices.push_back(vertex);
+        }
+        // Обход против часовой стрелки, если смотреть снаружи торца
+        for (unsigned int i = 0; i < static_cast<unsigned int>(segments); i++) {
+            unsigned int a = center + 1 + i;
+            if (y > 0.0f) {
+                indices.insert(indices.end(), {center, a + 1, a});
+            } else {
+                indices.insert(indices.end(), {center, a, a + 1});
+            }
+        }
+    }
+
+    return std::make_unique<Mesh>(vertices, indices, std::vector<Texture>(), Material::createPlastic(glm::vec3(0.8f)));
+}
@@ -3,30 +3,133 @@
 
 #pragma once
 
+#include <future>
 #include <memory>
 #include <vector>
 #include <string>
+#include <glm/glm.hpp>
 #include "../graphics/Model.h"
+#include "../graphics/Mesh.h"
 #include "../graphics/Shader.h"
+#include "../packing/Cargo.h"
+#include "../packing/LoadPlan.h"
+#include "../packing/LoadBalance.h"
+#include "../packing/FleetPacker.h"
+#include "../packing/PalletBuilder.h"
+#include "../packing/ThreadPool.h"
+#include "../packing/TrailerInterior.h"
 
 class Scene {
 private:
     std::unique_ptr<Model> truckModel;
     std::unique_ptr<Model> wheelModel;
 
+    // Расстановка моделей
+    glm::vec3 truckPosition = glm::vec3(-4.0f, -1.25f, 0.0f);
+    glm::vec3 wheelPosition = glm::vec3(0.5f, -1.25f, 0.0f);
+
+    // Груз: единичный куб, растягиваемый под каждую коробку
+    std::unique_ptr<Mesh> cargoMesh;
+    std::vector<glm::mat4> cargoTransforms;
+    std::vector<glm::vec3> cargoColors;
+
+    // Настилы поддонов - отдельная группа экземпляров того же куба
+    std::unique_ptr<Mesh> deckMesh;
+    std::vector<glm::mat4> deckTransforms;
+    std::vector<glm::vec3> deckColors;
+
+    // Цилиндры (бочки, шины, рулоны): единичный цилиндр, повернутый по оси груза
+    std::unique_ptr<Mesh> rollMesh;
+    std::vector<glm::mat4> rollTransforms;
+    std::vector<glm::vec3> rollColors;
+
+    // Машина парка: свой сдвиг по z и непрерывные диапазоны в cargoTransforms,
+    // deckTransforms и rollTransforms, чтобы полосу можно было целиком отсечь
+    // или нарисовать инстансно
+    struct Lane {
+        glm::vec3 offset;
+        size_t cargoBegin, cargoEnd;
+        size_t deckBegin, deckEnd;
+        size_t rollBegin, rollEnd;
+        glm::vec3 boundsMin, boundsMax;
+    };
+    std::vector<Lane> lanes;
+    float laneGap = 1.5f;
+
+    // Положение пола прицепа в мировых координатах и перевод см -> м
+    glm::vec3 cargoOrigin = glm::vec3(-4.0f, -0.05f, 0.0f);
+    float cargoScale = 0.01f;
+
+    // Полезный объем под модель прицепа по (габарит, сторона двери): строится задачей
+    // пула при первом запросе, смена модели прицепа сбрасывает кэш
+    struct InteriorSlot {
+        TrailerSpec trailer;
+        bool doorAtMaxX;
+        std::shared_future<std::shared_ptr<const TrailerInterior>> interior;
+    };
+    static constexpr size_t MAX_INTERIORS = 16;
+    mutable std::vector<InteriorSlot> interiors;    // От свежих к старым
+
+    float toCargoX(float worldX) const;
+    void appendCargoTriangles(const Model& model, const glm::vec3& position, const TrailerSpec& trailer,
+                              std::vector<float>& triangles) const;
+
+    static glm::vec3 cargoColor(uint32_t type);
+    glm::mat4 boxTransform(const glm::vec3& origin, const glm::vec3& corner, const glm::vec3& size) const;
+    // Цилиндр, вписанный в габарит placement, с осью по повороту
+    glm::mat4 rollTransform(const glm::vec3& origin, const glm::vec3& corner, const Placement& placement) const;
+
+    Lane beginLane(const glm::vec3& offset) const;
+    void finishLane(Lane& lane, const TrailerSpec& trailer);
+    void addLane(const LoadPlan& plan, const Manifest& manifest, const glm::vec3& offset);
+    void uploadInstances();
+    static bool isBoxVisible(const glm::mat4& viewProjection, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+
 public:
     Scene();
     ~Scene() = default;
 
+    // Куб с ребром 1 и центром в начале координат: сетка груза и настилов
+    static std::unique_ptr<Mesh> createUnitCube();
+    // Цилиндр диаметром и высотой 1 с осью y и центром в начале координат
+    static std::unique_ptr<Mesh> createUnitCylinder(int segments = 24);
+
     void loadTruckModel(const std::string& path);
     void loadWheelModel(const std::string& path);
 
+    // Перестраивает отображение груза по плану загрузки
+    void setLoadPlan(const LoadPlan& plan, const Manifest& manifest);
+    // Несколько машин рядом, по полосам вдоль z
+    void setFleetPlan(const FleetPlan& fleet, const Manifest& manifest);
+    // Поддоны с коробками: настилы и груз - две инстансные группы
+    void setPalletPlan(const PalletizedPlan& plan, const Manifest& cartons, const std::vector<PalletSpec>& specs);
+    void clearCargo();
+
+    // Положение опор прицепа в координатах груза по расстановке моделей сцены
+    AxleLayout getAxleLayout(const TrailerSpec& trailer) const;
+    bool isDoorAtMaxX(const TrailerSpec& trailer) const;
+
+    // Треугольники модели прицепа (truckModel) в см системы груза (по 9 float на
+    // треугольник), только те, что задевают габарит груза; wheelModel не вокселизуется.
+    // Поставляемый lorry.glb целиком ниже пола груза, так что с ним список пуст и
+    // упаковка идет в пустой параллелепипед
+    std::vector<float> cargoTriangles(const TrailerSpec& trailer) const;
+    // Геометрия кузова для упаковщика. Строится в фоне задачей pool (без pool - сразу);
+    // nullptr, пока объем строится или если модель не заходит в габарит груза.
+    // Вызывать из UI-потока
+    std::shared_ptr<const TrailerInterior> getInterior(const TrailerSpec& trailer, ThreadPool* pool) const;
+    // true, если getInterior уже запустил построение для прицепа и оно не закончено
+    bool isInteriorBuilding(const TrailerSpec& trailer) const;
+
     void update(float deltaTime);
-    void render(const Shader& shader) const;
+    // Полосы вне пирамиды видимости viewProjection не рисуются
+    void render(const Shader& shader, const glm::mat4& viewProjection) const;
 
     // Getters
     Model* getTruckModel() const { return truckModel.get(); }
     Model* getWheelModel() const { return wheelModel.get(); }
+    size_t getCargoCount() const { return cargoTransforms.size() + rollTransforms.size(); }
+    size_t getLaneCount() const { return lanes.size(); }
 };
 
 #endif //SCENE_H
\ No newline at end of file
@@ -0,0 +1,227 @@
+#include "SocketServer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef _WIN32
+using NativeSocket = uintptr_t;
+#else
+using NativeSocket = int;
+#endif
+
+#ifdef _WIN32
+constexpr SOCKET INVALID_LISTENER = INVALID_SOCKET;
+
+int pollSocket(NativeSocket socket, int timeoutMs) {
+    WSAPOLLFD descriptor = {};
+    descriptor.fd = static_cast<SOCKET>(socket);
+    descriptor.events = POLLRDNORM;
+    return WSAPoll(&descriptor, 1, timeoutMs);
+}
+
+struct WinsockInit {
+    WinsockInit() {
+        WSADATA data;
+        WSAStartup(MAKEWORD(2, 2), &data);
+    }
+    ~WinsockInit() { WSACleanup(); }
+};
+#else
+constexpr int INVALID_LISTENER = -1;
+
+int pollSocket(NativeSocket socket, int timeoutMs) {
+    pollfd descriptor = {};
+    descriptor.fd = socket;
+    descriptor.events = POLLIN;
+    return poll(&descriptor, 1, timeoutMs);
+}
+#endif
+
+constexpr int POLL_INTERVAL_MS = 200;
+constexpr size_t MAX_LINE = 1u << 20;
+
+bool sendAll(NativeSocket socket, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+#ifdef _WIN32
+        int result = send(static_cast<SOCKET>(socket), data.data() + sent, static_cast<int>(data.size() - sent), 0);
+#else
+        ssize_t result = send(socket, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+#endif
+        if (result <= 0) return false;
+        sent += static_cast<size_t>(result);
+    }
+    return true;
+}
+
+} // namespace
+
+SocketServer::SocketServer(SolverService& service, size_t maxClients)
+    : service(service), maxClients(std::max<size_t>(1, maxClients)), listener(static_cast<Socket>(INVALID_LISTENER)) {
+#ifdef _WIN32
+    static WinsockInit winsock;
+#endif
+}
+
+SocketServer::~SocketServer() {
+    if (listener != static_cast<Socket>(INVALID_LISTENER)) closeSocket(listener);
+#ifndef _WIN32
+    if (!socketPath.empty()) unlink(socketPath.c_str());
+#endif
+}
+
+void SocketServer::closeSocket(Socket socket) {
+#ifdef _WIN32
+    closesocket(static_cast<SOCKET>(socket));
+#else
+    close(socket);
+#endif
+}
+
+void SocketServer::listenUnix(const std::string& path) {
+#ifdef _WIN32
+    (void)path;
+    throw std::runtime_error("Unix sockets are not supported on this platform, use --port");
+#else
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) throw std::runtime_error("Socket path is too long: " + path);
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) throw std::runtime_error("Cannot create socket");
+
+    // Файл от прошлого запуска мешает bind
+    unlink(path.c_str());
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listener, 64) != 0) {
+        throw std::runtime_error("Cannot listen on " + path + ": " + std::strerror(errno));
+    }
+    socketPath = path;
+#endif
+}
+
+void SocketServer::listenTcp(uint16_t port) {
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    listener = static_cast<Socket>(socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+    if (listener == static_cast<Socket>(INVALID_LISTENER)) throw std::runtime_error("Cannot create socket");
+
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listener, 64) != 0) {
+        throw std::runtime_error("Cannot listen on 127.0.0.1:" + std::to_string(port));
+    }
+}
+
+void SocketServer::run() {
+    if (listener == static_cast<Socket>(INVALID_LISTENER)) throw std::runtime_error("Server is not listening");
+
+    running = true;
+    while (running) {
+        // Опрос с таймаутом, чтобы заметить stop() без закрытия сокета из другого потока
+        if (pollSocket(listener, POLL_INTERVAL_MS) <= 0) continue;
+
+        Socket client = static_cast<Socket>(accept(listener, nullptr, nullptr));
+        if (client == static_cast<Socket>(INVALID_LISTENER)) continue;
+        if (socketPath.empty()) {
+            // Для TCP отключаем Nagle: ответы короткие, задержка важнее
+            int noDelay = 1;
+            setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+        }
+        bool accepted;
+        {
+            std::lock_guard<std::mutex> lock(clientsMutex);
+            accepted = clientSockets.size() < maxClients;
+            if (accepted) clientSockets.push_back(client);
+        }
+        if (!accepted) {
+            sendAll(client, "ERR too many connections\n");
+            closeSocket(client);
+            continue;
+        }
+        std::thread(&SocketServer::serveClient, this, client).detach();
+    }
+
+    // Будим клиентов, застрявших в recv, и ждем их завершения
+    std::unique_lock<std::mutex> lock(clientsMutex);
+    for (Socket client : clientSockets) {
+#ifdef _WIN32
+        shutdown(static_cast<SOCKET>(client), SD_BOTH);
+#else
+        shutdown(client, SHUT_RDWR);
+#endif
+    }
+    clientsDone.wait(lock, [this]() { return clientSockets.empty(); });
+}
+
+void SocketServer::serveClient(Socket client) {
+    std::string buffer;
+    std::vector<std::future<std::string>> pending;
+    char chunk[16384];
+
+    while (running) {
+        if (pollSocket(client, POLL_INTERVAL_MS) == 0) continue;
+#ifdef _WIN32
+        int received = recv(static_cast<SOCKET>(client), chunk, static_cast<int>(sizeof(chunk)), 0);
+#else
+        ssize_t received = recv(client, chunk, sizeof(chunk), 0);
+#endif
+        if (received <= 0) break;
+        buffer.append(chunk, static_cast<size_t>(received));
+
+        // Все строки куска уходят в сервис до ожидания первого ответа
+        size_t start = 0;
+        size_t end;
+        while ((end = buffer.find('\n', start)) != std::string::npos) {
+            std::string line = buffer.substr(start, end - start);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (!line.empty()) pending.push_back(service.submit(line));
+            start = end + 1;
+        }
+        buffer.erase(0, start);
+
+        std::string response;
+        for (auto& future : pending) {
+            try {
+                response += future.get();
+            } catch (const std::exception& e) {
+                response += std::string("ERR ") + e.what();
+            }
+            response += '\n';
+        }
+        pending.clear();
+
+        if (buffer.size() > MAX_LINE) {
+            response += "ERR request line is too long\n";
+            sendAll(client, response);
+            break;
+        }
+        if (!response.empty() && !sendAll(client, response)) break;
+    }
+
+    closeSocket(client);
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    clientSockets.erase(std::find(clientSockets.begin(), clientSockets.end(), client));
+    if (clientSockets.empty()) clientsDone.notify_all();
+}
@@ -0,0 +1,59 @@
+#ifndef SOCKETSERVER_H
+#define SOCKETSERVER_H
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "SolverService.h"
+
+// Локальный сервер для SolverService: Unix domain socket или TCP на 127.0.0.1.
+// Один поток на соединение: он читает все пришедшие целиком строки, отправляет их
+// в сервис сразу (так запросы одного клиента попадают в одну пачку) и отвечает
+// в порядке запросов. Соединения живут долго, поэтому не занимают пул решателя;
+// их число ограничено maxClients, лишние получают ERR и закрываются.
+class SocketServer {
+private:
+#ifdef _WIN32
+    using Socket = uintptr_t;
+#else
+    using Socket = int;
+#endif
+
+    SolverService& service;
+    size_t maxClients;
+    Socket listener;
+    std::string socketPath;
+    std::atomic<bool> running{false};
+
+    // Потоки клиентов отсоединены; run() перед выходом ждет, пока их не останется
+    std::mutex clientsMutex;
+    std::condition_variable clientsDone;
+    std::vector<Socket> clientSockets;
+
+    void serveClient(Socket client);
+    static void closeSocket(Socket socket);
+
+public:
+    explicit SocketServer(SolverService& service, size_t maxClients = 64);
+    ~SocketServer();
+
+    SocketServer(const SocketServer&) = delete;
+    SocketServer& operator=(const SocketServer&) = delete;
+
+    // Бросают std::runtime_error, если сокет не удалось открыть
+    void listenUnix(const std::string& path);
+    void listenTcp(uint16_t port);
+
+    // Блокирует вызывающий поток до stop()
+    void run();
+
+    // Только взводит флаг, поэтому безопасна в обработчике сигнала
+    void stop() { running = false; }
+};
+
+#endif //SOCKETSERVER_H
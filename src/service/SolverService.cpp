@@ -0,0 +1,424 @@
+#include "SolverService.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <sstream>
+
+namespace {
+
+std::vector<std::string_view> splitTokens(std::string_view line) {
+    std::vector<std::string_view> tokens;
+    size_t pos = 0;
+    while (pos < line.size()) {
+        while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t' || line[pos] == '\r')) pos++;
+        size_t end = pos;
+        while (end < line.size() && line[end] != ' ' && line[end] != '\t' && line[end] != '\r') end++;
+        if (end > pos) tokens.push_back(line.substr(pos, end - pos));
+        pos = end;
+    }
+    return tokens;
+}
+
+template <typename T>
+bool parseNumber(std::string_view text, T& value) {
+    if (text.empty()) return false;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+// <Ш>x<В>x<Г>
+bool parseDimensions(std::string_view text, int& width, int& height, int& depth) {
+    size_t first = text.find('x');
+    size_t second = first == std::string_view::npos ? first : text.find('x', first + 1);
+    if (second == std::string_view::npos) return false;
+    return parseNumber(text.substr(0, first), width) &&
+           parseNumber(text.substr(first + 1, second - first - 1), height) &&
+           parseNumber(text.substr(second + 1), depth) &&
+           width > 0 && height > 0 && depth > 0 && width <= SERVICE_MAX_DIMENSION &&
+           height <= SERVICE_MAX_DIMENSION && depth <= SERVICE_MAX_DIMENSION;
+}
+
+bool fitsAnyOrientation(const BoxType& type, const TrailerSpec& trailer) {
+    for (uint8_t o = 0; o < ORIENTATION_COUNT; o++) {
+        if (!type.allows(o)) continue;
+        int x, y, z;
+        type.orientedSize(o, x, y, z);
+        if (x <= trailer.width && y <= trailer.height && z <= trailer.depth) return true;
+    }
+    return false;
+}
+
+std::string formatResult(bool fits, size_t placed, size_t total, double utilisation, long long micros, bool cached) {
+    char buffer[128];
+    std::snprintf(buffer, sizeof(buffer), "OK %d %zu %zu %.4f %lld%s", fits ? 1 : 0, placed, total,
+                  utilisation, micros, cached ? " cached" : "");
+    return buffer;
+}
+
+} // namespace
+
+SolverService::SolverService(ThreadPool& pool, const ServiceOptions& options)
+    : options(options), pool(pool) {}
+
+SolverService::~SolverService() {
+    stop();
+}
+
+void SolverService::setSkuTable(const Manifest& manifest) {
+    skuTable = manifest.types;
+    skuIndex.clear();
+    for (size_t t = 0; t < skuTable.size(); t++) {
+        // При повторе SKU с разными размерами действует первое описание
+        skuIndex.emplace(skuTable[t].sku, static_cast<uint32_t>(t));
+    }
+}
+
+void SolverService::addTruck(const std::string& name, const TrailerSpec& trailer) {
+    trucks.emplace_back(name, trailer);
+}
+
+void SolverService::start() {
+    if (dispatcher.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = false;
+    }
+    dispatcher = std::thread(&SolverService::dispatchLoop, this);
+}
+
+void SolverService::stop() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueReady.notify_all();
+    if (dispatcher.joinable()) dispatcher.join();
+}
+
+std::future<std::string> SolverService::submit(const std::string& line) {
+    requestCount++;
+
+    Request request;
+    request.line = line;
+    std::future<std::string> response = request.response.get_future();
+
+    // Служебные команды не ждут пачку
+    std::string_view view = line;
+    if (view.compare(0, 3, "FIT") != 0) {
+        request.response.set_value(handleControl(line));
+        return response;
+    }
+
+    bool wasEmpty;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (stopping) {
+            request.response.set_value("ERR service is stopping");
+            return response;
+        }
+        wasEmpty = queue.empty();
+        queue.push_back(std::move(request));
+    }
+    if (wasEmpty) queueReady.notify_one();
+    return response;
+}
+
+std::string SolverService::handleControl(const std::string& line) const {
+    std::vector<std::string_view> tokens = splitTokens(line);
+    if (tokens.empty()) return "ERR empty request";
+
+    if (tokens[0] == "PING") return "OK PONG";
+    if (tokens[0] == "TRUCKS") {
+        std::string response = "OK";
+        for (const auto& truck : trucks) {
+            response += " " + truck.first + "=" + std::to_string(truck.second.width) + "x" +
+                        std::to_string(truck.second.height) + "x" + std::to_string(truck.second.depth);
+        }
+        return response;
+    }
+    if (tokens[0] == "STATS") {
+        std::ostringstream response;
+        response << "OK requests=" << requestCount.load() << " batches=" << batchCount.load()
+                 << " cache_hits=" << cacheHits.load() << " skus=" << skuTable.size()
+                 << " trucks=" << trucks.size();
+        return response.str();
+    }
+    return "ERR unknown command " + std::string(tokens[0]);
+}
+
+bool SolverService::parseTrailer(const std::string& token, TrailerSpec& trailer) const {
+    for (const auto& truck : trucks) {
+        if (truck.first == token) {
+            trailer = truck.second;
+            return true;
+        }
+    }
+    return parseDimensions(token, trailer.width, trailer.height, trailer.depth);
+}
+
+bool SolverService::parseProblem(const std::string& line, Problem& problem, std::string& error) const {
+    std::vector<std::string_view> tokens = splitTokens(line);
+    bool custom = tokens[0] == "FITBOX";
+    if (!custom && tokens[0] != "FIT") {
+        error = "unknown command " + std::string(tokens[0]);
+        return false;
+    }
+    if (tokens.size() < 3) {
+        error = "expected <truck> and at least one item";
+        return false;
+    }
+    if (!parseTrailer(std::string(tokens[1]), problem.trailer)) {
+        error = "unknown truck " + std::string(tokens[1]);
+        return false;
+    }
+
+    // Позиции сворачиваются по (тип, точка), чтобы "A*2 A*3" и "A*5" давали один ключ
+    std::vector<std::pair<BoxType, std::pair<long long, uint16_t>>> lines;
+    for (size_t i = 2; i < tokens.size(); i++) {
+        std::string_view token = tokens[i];
+        uint16_t stop = 0;
+        size_t at = token.find('@');
+        if (at != std::string_view::npos) {
+            if (!parseNumber(token.substr(at + 1), stop)) {
+                error = "bad stop in " + std::string(token);
+                return false;
+            }
+            token = token.substr(0, at);
+        }
+
+        long long quantity = 1;
+        size_t star = token.find('*');
+        if (star != std::string_view::npos) {
+            if (!parseNumber(token.substr(star + 1), quantity) || quantity <= 0 || quantity > options.maxItems) {
+                error = "bad quantity in " + std::string(tokens[i]);
+                return false;
+            }
+            token = token.substr(0, star);
+        }
+
+        BoxType type;
+        if (custom) {
+            // SKU произвольной коробки - весь ее токен, так что класс входит в ключ кэша
+            type.sku = std::string(token);
+            size_t mark = token.find('#');
+            int compatibilityClass = 0;
+            if (mark != std::string_view::npos) {
+                if (!parseNumber(token.substr(mark + 1), compatibilityClass) || compatibilityClass < 0 ||
+                    compatibilityClass >= static_cast<int>(COMPATIBILITY_CLASS_COUNT)) {
+                    error = "bad class in " + std::string(tokens[i]);
+                    return false;
+                }
+                token = token.substr(0, mark);
+            }
+            type.compatibilityClass = static_cast<uint8_t>(compatibilityClass);
+
+            size_t colon = token.find(':');
+            if (!parseDimensions(token.substr(0, colon), type.width, type.height, type.depth) ||
+                (colon != std::string_view::npos && !parseNumber(token.substr(colon + 1), type.weight))) {
+                error = "bad box " + std::string(tokens[i]);
+                return false;
+            }
+        } else {
+            auto found = skuIndex.find(std::string(token));
+            if (found == skuIndex.end()) {
+                error = "unknown SKU " + std::string(token);
+                return false;
+            }
+            type = skuTable[found->second];
+        }
+        lines.push_back({type, {quantity, stop}});
+    }
+
+    std::sort(lines.begin(), lines.end(), [](const auto& a, const auto& b) {
+        if (a.first.sku != b.first.sku) return a.first.sku < b.first.sku;
+        return a.second.second < b.second.second;
+    });
+
+    // Сначала свертка и пределы: каждая позиция не больше maxItems, а сумма проверяется
+    // после каждого сложения, поэтому 64-битный счетчик не переполняется
+    std::vector<std::pair<size_t, long long>> merged;   // (первая позиция, количество)
+    long long total = 0;
+    long long volume = 0;
+    for (size_t i = 0; i < lines.size(); i++) {
+        size_t first = i;
+        long long quantity = lines[i].second.first;
+        while (i + 1 < lines.size() && lines[i + 1].first.sku == lines[first].first.sku &&
+               lines[i + 1].second.second == lines[first].second.second) {
+            quantity += lines[++i].second.first;
+            if (quantity > options.maxItems) break;
+        }
+        total += quantity;
+        if (total > options.maxItems) {
+            error = "too many boxes, limit is " + std::to_string(options.maxItems);
+            return false;
+        }
+        merged.emplace_back(first, quantity);
+
+        // Быстрый отказ до выделения коробок: коробка не проходит ни в одном повороте
+        // или груз больше кузова. Объем считается только для прошедших в кузов коробок
+        if (!fitsAnyOrientation(lines[first].first, problem.trailer)) {
+            problem.rejected = true;
+        } else {
+            volume += lines[first].first.volume() * quantity;
+        }
+    }
+    problem.total = static_cast<size_t>(total);
+    if (volume > problem.trailer.volume()) problem.rejected = true;
+
+    std::string& key = problem.key;
+    key = std::to_string(problem.trailer.width) + "x" + std::to_string(problem.trailer.height) + "x" +
+          std::to_string(problem.trailer.depth);
+    for (const auto& [first, quantity] : merged) {
+        const BoxType& type = lines[first].first;
+        uint16_t stop = lines[first].second.second;
+
+        if (!problem.rejected) {
+            uint32_t typeIndex = static_cast<uint32_t>(problem.manifest.types.size());
+            if (typeIndex == 0 || problem.manifest.types.back().sku != type.sku) {
+                problem.manifest.addType(type);
+            } else {
+                typeIndex--;
+            }
+            problem.manifest.addItems(typeIndex, static_cast<int>(quantity), stop);
+        }
+
+        char weight[32];
+        std::snprintf(weight, sizeof(weight), "%g", type.weight);
+        key += " " + type.sku + ":" + std::to_string(type.width) + "x" + std::to_string(type.height) + "x" +
+               std::to_string(type.depth) + ":" + weight + "*" + std::to_string(quantity) + "@" +
+               std::to_string(stop);
+    }
+    return true;
+}
+
+SolverService::CachedResult SolverService::solve(const Problem& problem) const {
+    CachedResult result{false, 0, problem.total, 0.0};
+
+    // Быстрый отказ решен при разборе; placed в этом случае 0 - размещение не вычислялось
+    if (problem.rejected) return result;
+
+    Packer packer(problem.manifest, options.packer);
+    LoadPlan plan = packer.pack(problem.trailer);
+    result.placed = plan.placements.size();
+    result.fits = plan.unplaced.empty();
+    result.utilisation = plan.utilisation();
+    return result;
+}
+
+bool SolverService::findCached(const std::string& key, CachedResult& result) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto found = cacheIndex.find(key);
+    if (found == cacheIndex.end()) return false;
+    cacheOrder.splice(cacheOrder.begin(), cacheOrder, found->second);
+    result = found->second->second;
+    return true;
+}
+
+void SolverService::storeCached(const std::string& key, const CachedResult& result) {
+    if (options.cacheSize == 0) return;
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (cacheIndex.count(key)) return;
+    cacheOrder.emplace_front(key, result);
+    cacheIndex.emplace(key, cacheOrder.begin());
+    if (cacheOrder.size() > options.cacheSize) {
+        cacheIndex.erase(cacheOrder.back().first);
+        cacheOrder.pop_back();
+    }
+}
+
+void SolverService::dispatchLoop() {
+    std::vector<Request> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueReady.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (queue.empty()) return;
+
+            // Короткое окно для попутных запросов, если пачка еще не полна
+            if (queue.size() < options.maxBatch && !stopping) {
+                queueReady.wait_for(lock, options.batchWindow, [this]() {
+                    return stopping || queue.size() >= options.maxBatch;
+                });
+            }
+
+            size_t count = std::min(queue.size(), options.maxBatch);
+            batch.assign(std::make_move_iterator(queue.begin()), std::make_move_iterator(queue.begin() + count));
+            queue.erase(queue.begin(), queue.begin() + count);
+        }
+
+        processBatch(batch);
+        batch.clear();
+    }
+}
+
+void SolverService::processBatch(std::vector<Request>& batch) {
+    batchCount++;
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed = [&start]() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // Разбор и кэш в потоке диспетчера, одинаковые задачи пачки решаются один раз
+    std::vector<Problem> problems;
+    std::unordered_map<std::string, size_t> problemIndex;
+    std::vector<std::pair<size_t, size_t>> waiting;     // (запрос, задача)
+
+    for (size_t r = 0; r < batch.size(); r++) {
+        Problem problem;
+        std::string error;
+        bool parsed = false;
+        try {
+            parsed = parseProblem(batch[r].line, problem, error);
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        if (!parsed) {
+            batch[r].response.set_value("ERR " + error);
+            continue;
+        }
+
+        CachedResult cached;
+        if (findCached(problem.key, cached)) {
+            cacheHits++;
+            batch[r].response.set_value(formatResult(cached.fits, cached.placed, cached.total,
+                                                     cached.utilisation, elapsed(), true));
+            continue;
+        }
+
+        auto found = problemIndex.find(problem.key);
+        if (found == problemIndex.end()) {
+            found = problemIndex.emplace(problem.key, problems.size()).first;
+            problems.push_back(std::move(problem));
+        }
+        waiting.emplace_back(r, found->second);
+    }
+
+    std::vector<std::future<CachedResult>> futures;
+    futures.reserve(problems.size());
+    for (const Problem& problem : problems) {
+        futures.push_back(pool.async([this, &problem]() { return solve(problem); }));
+    }
+
+    // Исключение задачи становится ответом ERR: поток диспетчера не должен падать
+    std::vector<CachedResult> results(problems.size());
+    std::vector<std::string> errors(problems.size());
+    for (size_t p = 0; p < problems.size(); p++) {
+        try {
+            results[p] = futures[p].get();
+            storeCached(problems[p].key, results[p]);
+        } catch (const std::exception& e) {
+            errors[p] = std::string("ERR ") + e.what();
+        }
+    }
+
+    long long micros = elapsed();
+    for (const auto& [request, problem] : waiting) {
+        if (!errors[problem].empty()) {
+            batch[request].response.set_value(errors[problem]);
+            continue;
+        }
+        const CachedResult& result = results[problem];
+        batch[request].response.set_value(formatResult(result.fits, result.placed, result.total,
+                                                       result.utilisation, micros, false));
+    }
+}
@@ -0,0 +1,127 @@
+#ifndef SOLVERSERVICE_H
+#define SOLVERSERVICE_H
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "../packing/Cargo.h"
+#include "../packing/Packer.h"
+#include "../packing/ThreadPool.h"
+
+// Предел размера в запросе, см: объемы в 64 битах не переполняются
+constexpr int SERVICE_MAX_DIMENSION = 10000;
+
+struct ServiceOptions {
+    size_t maxBatch = 64;
+    std::chrono::microseconds batchWindow{1000};   // Сколько ждать попутных запросов
+    size_t cacheSize = 4096;                        // Ответов в LRU
+    long long maxItems = 100000;                    // Коробок в одном запросе, больше - ERR
+    PackerOptions packer;                           // segregation - правила для классов груза
+};
+
+// Ядро сервиса "поместится ли заказ": строковый протокол, пакетирование и кэш.
+//
+// Запрос - одна строка:
+//   FIT <прицеп> <sku>*<кол-во>[@<точка>] ...         SKU из загруженной таблицы
+//   FITBOX <прицеп> <Ш>x<В>x<Г>[:<кг>][#<класс>]*<кол-во> ...   произвольные коробки
+//   TRUCKS | STATS | PING
+// <прицеп> - имя пресета или <Ш>x<В>x<Г> в см. Класс совместимости берется из
+// таблицы SKU или из #<класс>; правила для классов - ServiceOptions::packer.segregation.
+// Ответ - одна строка:
+//   OK <fits 0|1> <размещено> <всего> <заполнение> <мкс> [cached]
+//     (при быстром отказе по объему или размерам размещено = 0)
+//   ERR <сообщение>
+// Размеры прицепа и коробок - до SERVICE_MAX_DIMENSION см, коробок в запросе - до
+// ServiceOptions::maxItems; запрос сверх пределов получает ERR и не решается.
+//
+// Запросы из разных соединений копятся в очереди; диспетчер забирает до maxBatch
+// штук (или все, что пришло за batchWindow), сворачивает одинаковые и решает пачку
+// параллельно на пуле. Таблицы SKU и прицепов загружены один раз и только читаются.
+class SolverService {
+private:
+    struct Request {
+        std::string line;
+        std::promise<std::string> response;
+    };
+
+    // Разобранный запрос в каноническом виде: ключ кэша не зависит от порядка коробок.
+    // Если груз заведомо не помещается (объем или габарит), манифест не строится
+    struct Problem {
+        TrailerSpec trailer;
+        Manifest manifest;
+        std::string key;
+        size_t total = 0;
+        bool rejected = false;
+    };
+
+    struct CachedResult {
+        bool fits;
+        size_t placed;
+        size_t total;
+        double utilisation;
+    };
+
+    ServiceOptions options;
+    ThreadPool& pool;
+
+    std::vector<BoxType> skuTable;
+    std::unordered_map<std::string, uint32_t> skuIndex;
+    std::vector<std::pair<std::string, TrailerSpec>> trucks;
+
+    // Очередь запросов
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::vector<Request> queue;
+    bool stopping = false;
+    std::thread dispatcher;
+
+    // LRU: список от свежих к старым, map указывает в список
+    std::mutex cacheMutex;
+    std::list<std::pair<std::string, CachedResult>> cacheOrder;
+    std::unordered_map<std::string, std::list<std::pair<std::string, CachedResult>>::iterator> cacheIndex;
+
+    // Статистика
+    std::atomic<uint64_t> requestCount{0};
+    std::atomic<uint64_t> cacheHits{0};
+    std::atomic<uint64_t> batchCount{0};
+
+    bool parseTrailer(const std::string& token, TrailerSpec& trailer) const;
+    bool parseProblem(const std::string& line, Problem& problem, std::string& error) const;
+    CachedResult solve(const Problem& problem) const;
+
+    bool findCached(const std::string& key, CachedResult& result);
+    void storeCached(const std::string& key, const CachedResult& result);
+
+    std::string handleControl(const std::string& line) const;
+    void dispatchLoop();
+    void processBatch(std::vector<Request>& batch);
+
+public:
+    SolverService(ThreadPool& pool, const ServiceOptions& options = ServiceOptions());
+    ~SolverService();
+
+    SolverService(const SolverService&) = delete;
+    SolverService& operator=(const SolverService&) = delete;
+
+    // Таблицы загружаются до start(); SKU берутся из манифеста, количества игнорируются
+    void setSkuTable(const Manifest& manifest);
+    void addTruck(const std::string& name, const TrailerSpec& trailer);
+
+    void start();
+    void stop();
+
+    // Потокобезопасно; ответ приходит, когда пачка с этим запросом решена
+    std::future<std::string> submit(const std::string& line);
+};
+
+#endif //SOLVERSERVICE_H
@@ -0,0 +1,232 @@
+// Пакетный решатель без окна: упаковывает все манифесты каталога во все
+// заданные прицепы и пишет планы (.tlp) и сводку results.csv.
+//
+//   TruckLoadingSolver <каталог манифестов> [--trucks trucks.csv] [--rules segregation.csv]
+//                      [--out каталог] [--jobs N]
+//
+// trucks.csv: name,width,height,depth (см). Без --trucks используются пресеты симулятора.
+// segregation.csv - совместимость классов груза (см. SegregationPresets.h); без --rules
+// действуют правила симулятора.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "packing/Packer.h"
+#include "packing/ThreadPool.h"
+#include "io/LoadPlanFile.h"
+#include "io/ManifestImporter.h"
+#include "io/SegregationPresets.h"
+#include "io/TruckPresets.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct SolverOptions {
+    fs::path input;
+    fs::path trucks;
+    fs::path rules;
+    fs::path output = "solver_output";
+    size_t jobs = 0;
+};
+
+// Одна строка сводки: манифест x прицеп
+struct JobResult {
+    std::string manifest;
+    std::string truck;
+    size_t boxes = 0;
+    size_t placed = 0;
+    double utilisation = 0.0;
+    double loadMs = 0.0;
+    double packMs = 0.0;
+    std::string status = "ok";
+};
+
+std::string fileSafe(const std::string& name) {
+    std::string result = name;
+    for (char& c : result) {
+        bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_';
+        if (!safe) c = '_';
+    }
+    return result;
+}
+
+std::string csvField(const std::string& value) {
+    if (value.find_first_of(",\"\n") == std::string::npos) return value;
+
+    std::string quoted = "\"";
+    for (char c : value) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+void printUsage() {
+    std::cerr << "Usage: TruckLoadingSolver <manifest-dir> [--trucks trucks.csv] [--rules segregation.csv]"
+                 " [--out dir] [--jobs N]" << std::endl;
+}
+
+bool parseArguments(int argc, char** argv, SolverOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--trucks" && hasValue) {
+            options.trucks = argv[++i];
+        } else if (arg == "--rules" && hasValue) {
+            options.rules = argv[++i];
+        } else if (arg == "--out" && hasValue) {
+            options.output = argv[++i];
+        } else if (arg == "--jobs" && hasValue) {
+            options.jobs = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (!arg.empty() && arg[0] != '-' && options.input.empty()) {
+            options.input = arg;
+        } else {
+            return false;
+        }
+    }
+    return !options.input.empty();
+}
+
+// Задача пула: один манифест во все прицепы. Манифест живет только внутри задачи,
+// поэтому память ограничена числом потоков, а не числом файлов.
+std::vector<JobResult> solveManifest(const fs::path& path, const std::vector<TruckPreset>& trucks,
+                                     const PackerOptions& packerOptions, const fs::path& output) {
+    std::vector<JobResult> results;
+    std::string name = path.filename().string();
+
+    auto loadStart = std::chrono::steady_clock::now();
+    ProjectSnapshot snapshot;
+    try {
+        // Без пула: ожидание вложенных задач из потока пула могло бы его заблокировать
+        snapshot.manifest = ManifestImporter().load(path.string());
+    } catch (const std::exception& e) {
+        JobResult failed;
+        failed.manifest = name;
+        failed.status = e.what();
+        results.push_back(failed);
+        return results;
+    }
+    double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+
+    Packer packer(snapshot.manifest, packerOptions);
+    for (const auto& truck : trucks) {
+        JobResult result;
+        result.manifest = name;
+        result.truck = truck.name;
+        result.boxes = snapshot.manifest.items.size();
+        result.loadMs = loadMs;
+
+        // Ошибка одного прицепа попадает в его строку сводки, остальные решаются
+        try {
+            auto packStart = std::chrono::steady_clock::now();
+            snapshot.plan = packer.pack(truck.trailer);
+            result.packMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - packStart).count();
+            result.placed = snapshot.plan.placements.size();
+            result.utilisation = snapshot.plan.utilisation();
+
+            fs::path planPath = output / (path.stem().string() + "_" + fileSafe(truck.name) + ".tlp");
+            LoadPlanFile::save(snapshot, planPath.string());
+        } catch (const std::exception& e) {
+            result.status = e.what();
+        }
+        results.push_back(result);
+    }
+    return results;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    SolverOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    try {
+        std::vector<TruckPreset> trucks = options.trucks.empty() ? defaultTruckPresets() : readTruckPresets(options.trucks.string());
+        PackerOptions packerOptions;
+        packerOptions.segregation = options.rules.empty() ? defaultSegregationRules()
+                                                         : readSegregationRules(options.rules.string());
+        fs::create_directories(options.output);
+
+        // Манифесты - все .csv и .json каталога, кроме файлов прицепов и правил; порядок стабилен
+        std::vector<fs::path> manifests;
+        for (const auto& entry : fs::directory_iterator(options.input)) {
+            if (!entry.is_regular_file()) continue;
+            std::string extension = entry.path().extension().string();
+            if (extension != ".csv" && extension != ".json") continue;
+            if (!options.trucks.empty() && fs::equivalent(entry.path(), options.trucks)) continue;
+            if (!options.rules.empty() && fs::equivalent(entry.path(), options.rules)) continue;
+            manifests.push_back(entry.path());
+        }
+        std::sort(manifests.begin(), manifests.end());
+
+        std::vector<std::vector<JobResult>> results(manifests.size());
+        std::atomic<size_t> finished{0};
+        std::mutex printMutex;
+
+        auto start = std::chrono::steady_clock::now();
+        {
+            ThreadPool pool(options.jobs);
+            std::vector<std::future<std::vector<JobResult>>> jobs;
+            jobs.reserve(manifests.size());
+            for (size_t i = 0; i < manifests.size(); i++) {
+                jobs.push_back(pool.async([&, i]() {
+                    std::vector<JobResult> jobResults = solveManifest(manifests[i], trucks, packerOptions, options.output);
+
+                    size_t done = ++finished;
+                    std::lock_guard<std::mutex> lock(printMutex);
+                    std::cout << "[" << done << "/" << manifests.size() << "] " << manifests[i].filename().string() << std::endl;
+                    return jobResults;
+                }));
+            }
+
+            // Исключение задачи (например, нехватка памяти) не роняет пакет: файл получает строку с ошибкой
+            for (size_t i = 0; i < jobs.size(); i++) {
+                try {
+                    results[i] = jobs[i].get();
+                } catch (const std::exception& e) {
+                    JobResult failed;
+                    failed.manifest = manifests[i].filename().string();
+                    failed.status = e.what();
+                    results[i].push_back(failed);
+                }
+            }
+        }
+        double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        fs::path reportPath = options.output / "results.csv";
+        FILE* report = std::fopen(reportPath.string().c_str(), "w");
+        if (!report) throw std::runtime_error("Cannot write " + reportPath.string());
+
+        size_t failures = 0;
+        std::fprintf(report, "manifest,truck,boxes,placed,utilisation,load_ms,pack_ms,status\n");
+        for (const auto& jobResults : results) {
+            for (const auto& result : jobResults) {
+                if (result.status != "ok") failures++;
+                std::fprintf(report, "%s,%s,%zu,%zu,%.4f,%.2f,%.2f,%s\n", csvField(result.manifest).c_str(),
+                             csvField(result.truck).c_str(), result.boxes, result.placed, result.utilisation,
+                             result.loadMs, result.packMs, csvField(result.status).c_str());
+            }
+        }
+        std::fclose(report);
+
+        std::cout << "Solved " << manifests.size() << " manifests x " << trucks.size() << " trucks in "
+                  << totalMs << " ms, report: " << reportPath.string() << std::endl;
+        return failures == 0 ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Solver error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
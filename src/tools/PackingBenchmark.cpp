@@ -0,0 +1,464 @@
+// Бенчмарк упаковщика: качество (доля объема) и скорость на воспроизводимых наборах задач.
+//
+//   PackingBenchmark [--instances N] [--search мс] [--threads 1,2,4] [--out result.json]
+//                    [--baseline old.json] [--label текст]
+//
+// Наборы:
+//   BR1..BR15  - генератор в духе Bischoff-Ratcliff / Davies-Bischoff: контейнер 587x220x233 (ШxВxГ),
+//                от 3 до 100 типов коробок, коробки добавляются до объема контейнера;
+//   truck:<имя> - синтетические заказы под каждый пресет прицепа (95% объема, 3 точки разгрузки);
+//   rolls:<имя> - то же с преобладанием цилиндров: бочки, шины и рулоны (около 2/3 типов);
+//   hazmat:<имя> - заказы truck: с опасными грузами и продуктами, которые нельзя ставить рядом.
+// Для каждого набора - средняя, минимальная и максимальная доля объема, среднее и p95 время.
+// Масштабирование: все задачи решаются на пуле из 1, 2, 4... потоков, пишется пропускная
+// способность. С --baseline сравнивает с прошлым JSON и возвращает 1 при регрессии.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "io/SegregationPresets.h"
+#include "io/TruckPresets.h"
+#include "packing/Packer.h"
+#include "packing/PackingSearch.h"
+#include "packing/ThreadPool.h"
+
+namespace {
+
+struct BenchmarkOptions {
+    int instances = 5;
+    int searchMs = 0;                   // 0 - только жадная упаковка
+    std::vector<size_t> threads;
+    std::string output = "benchmark.json";
+    std::string baseline;
+    std::string label;
+};
+
+struct Instance {
+    std::string set;
+    Manifest manifest;
+    TrailerSpec trailer;
+    std::shared_ptr<const SegregationRules> segregation;
+};
+
+struct InstanceResult {
+    double utilisation = 0.0;
+    double milliseconds = 0.0;
+};
+
+struct SetSummary {
+    std::string name;
+    size_t instances = 0;
+    double meanUtilisation = 0.0;
+    double minUtilisation = 0.0;
+    double maxUtilisation = 0.0;
+    double meanMs = 0.0;
+    double p95Ms = 0.0;
+};
+
+struct ScalingResult {
+    size_t threads = 0;
+    double seconds = 0.0;
+    double instancesPerSecond = 0.0;
+};
+
+// Допуски регрессии относительно базового прогона
+constexpr double UTILISATION_TOLERANCE = 0.005;    // 0.5 п.п.
+constexpr double TIME_TOLERANCE = 1.25;             // +25%
+constexpr double TIME_NOISE_MS = 2.0;               // Меньшие разницы - шум таймера
+
+class Random {
+private:
+    uint64_t state;
+
+public:
+    explicit Random(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        // splitmix64
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    int range(int low, int high) {
+        return low + static_cast<int>(next() % static_cast<uint64_t>(high - low + 1));
+    }
+};
+
+// Класс BRk: число типов растет от 3 (сильно однородный груз) до 100 (сильно разнородный)
+constexpr int BR_TYPE_COUNTS[15] = {3, 5, 8, 10, 12, 15, 20, 30, 40, 50, 60, 70, 80, 90, 100};
+
+Instance generateBr(int problemClass, int index) {
+    Instance instance;
+    instance.set = "BR" + std::to_string(problemClass);
+    instance.trailer = TrailerSpec{587, 220, 233};
+
+    Random random(0xB15C0FFULL * static_cast<uint64_t>(problemClass) + static_cast<uint64_t>(index));
+    int typeCount = BR_TYPE_COUNTS[problemClass - 1];
+    for (int t = 0; t < typeCount; t++) {
+        BoxType type;
+        type.sku = "T" + std::to_string(t);
+        type.width = random.range(30, 120);
+        type.depth = random.range(25, 100);
+        type.height = random.range(20, 80);
+        type.weight = static_cast<float>(type.volume()) * 2e-4f;
+        // Как в исходных наборах: часть коробок нельзя класть на бок
+        if (random.next() % 3 == 0) type.orientations = (1u << ORIENT_WHD) | (1u << ORIENT_DHW);
+        instance.manifest.addType(type);
+    }
+
+    // Коробки случайных типов до объема контейнера: часть заведомо не помещается
+    long long volume = 0;
+    while (volume < instance.trailer.volume()) {
+        uint32_t type = static_cast<uint32_t>(random.next() % static_cast<uint64_t>(typeCount));
+        instance.manifest.addItems(type, 1);
+        volume += instance.manifest.types[type].volume();
+    }
+    return instance;
+}
+
+Instance generateTruckOrder(const TruckPreset& truck, int index) {
+    Instance instance;
+    instance.set = "truck:" + truck.name;
+    instance.trailer = truck.trailer;
+
+    Random random(0x7A0CC0DEULL + static_cast<uint64_t>(truck.trailer.width) * 131 + static_cast<uint64_t>(index));
+    int typeCount = random.range(20, 60);
+    for (int t = 0; t < typeCount; t++) {
+        BoxType type;
+        type.sku = "SKU" + std::to_string(t);
+        type.width = random.range(20, 80);
+        type.height = random.range(15, 60);
+        type.depth = random.range(20, 60);
+        type.weight = static_cast<float>(type.volume()) * 1.5e-4f;
+        if (random.next() % 10 == 0) type.maxStackLoad = 0.0f;
+        instance.manifest.addType(type);
+    }
+
+    long long target = truck.trailer.volume() * 95 / 100;
+    long long volume = 0;
+    while (volume < target) {
+        uint32_t type = static_cast<uint32_t>(random.next() % static_cast<uint64_t>(typeCount));
+        int quantity = random.range(1, 12);
+        instance.manifest.addItems(type, quantity, static_cast<uint16_t>(random.next() % 3));
+        volume += instance.manifest.types[type].volume() * quantity;
+    }
+    return instance;
+}
+
+Instance generateRollOrder(const TruckPreset& truck, int index) {
+    Instance instance;
+    instance.set = "rolls:" + truck.name;
+    instance.trailer = truck.trailer;
+
+    Random random(0x7011ED0ULL + static_cast<uint64_t>(truck.trailer.width) * 131 + static_cast<uint64_t>(index));
+    int typeCount = random.range(6, 15);
+    for (int t = 0; t < typeCount; t++) {
+        BoxType type;
+        type.sku = "ROLL" + std::to_string(t);
+        if (random.next() % 3 == 0) {
+            type.width = random.range(20, 80);
+            type.height = random.range(15, 60);
+            type.depth = random.range(20, 60);
+        } else {
+            // Диаметр и длина вдоль оси: от шин (короткие, широкие) до рулонов
+            type.shape = CargoShape::Cylinder;
+            type.width = type.depth = random.range(30, 90);
+            type.height = random.range(15, 150);
+            if (random.next() % 2 == 0) type.orientations = (1u << ORIENT_WHD) | (1u << ORIENT_DHW);
+        }
+        type.weight = static_cast<float>(type.volume()) * 1.5e-4f;
+        instance.manifest.addType(type);
+    }
+
+    long long target = truck.trailer.volume() * 95 / 100;
+    long long volume = 0;
+    while (volume < target) {
+        uint32_t type = static_cast<uint32_t>(random.next() % static_cast<uint64_t>(typeCount));
+        int quantity = random.range(4, 40);
+        instance.manifest.addItems(type, quantity, static_cast<uint16_t>(random.next() % 2));
+        volume += instance.manifest.types[type].volume() * quantity;
+    }
+    return instance;
+}
+
+Instance generateHazmatOrder(const TruckPreset& truck, int index) {
+    Instance instance = generateTruckOrder(truck, index);
+    instance.set = "hazmat:" + truck.name;
+    instance.segregation = defaultSegregationRules();
+
+    // Опасных типов немного, продуктов - около четверти
+    Random random(0x4A2A4DULL + static_cast<uint64_t>(truck.trailer.width) * 131 + static_cast<uint64_t>(index));
+    for (auto& type : instance.manifest.types) {
+        int roll = random.range(0, 19);
+        if (roll < 3) {
+            type.compatibilityClass = static_cast<uint8_t>(roll + 1);
+        } else if (roll < 8) {
+            type.compatibilityClass = 4;
+        }
+    }
+    return instance;
+}
+
+// Без поиска - жадная упаковка в вызывающем потоке; с поиском - BRKGA на общем пуле
+InstanceResult solveInstance(const Instance& instance, int searchMs, ThreadPool* searchPool) {
+    InstanceResult result;
+    auto start = std::chrono::steady_clock::now();
+    if (searchMs > 0 && searchPool) {
+        SearchOptions options;
+        options.timeBudgetMs = searchMs;
+        options.packer.segregation = instance.segregation;
+        PackingSearch search(instance.manifest, instance.trailer, *searchPool, options);
+        search.start();
+        search.wait();
+        result.utilisation = search.bestUtilisation();
+    } else {
+        PackerOptions options;
+        options.segregation = instance.segregation;
+        Packer packer(instance.manifest, options);
+        result.utilisation = packer.pack(instance.trailer).utilisation();
+    }
+    result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+SetSummary summarise(const std::string& name, std::vector<InstanceResult> results) {
+    SetSummary summary;
+    summary.name = name;
+    summary.instances = results.size();
+    if (results.empty()) return summary;
+
+    summary.minUtilisation = 1.0;
+    for (const auto& result : results) {
+        summary.meanUtilisation += result.utilisation;
+        summary.meanMs += result.milliseconds;
+        summary.minUtilisation = std::min(summary.minUtilisation, result.utilisation);
+        summary.maxUtilisation = std::max(summary.maxUtilisation, result.utilisation);
+    }
+    summary.meanUtilisation /= static_cast<double>(results.size());
+    summary.meanMs /= static_cast<double>(results.size());
+
+    std::sort(results.begin(), results.end(), [](const InstanceResult& a, const InstanceResult& b) {
+        return a.milliseconds < b.milliseconds;
+    });
+    size_t p95 = std::min(results.size() - 1, static_cast<size_t>(std::ceil(0.95 * results.size())) - 1);
+    summary.p95Ms = results[p95].milliseconds;
+    return summary;
+}
+
+std::string jsonString(const std::string& value) {
+    std::string result = "\"";
+    for (char c : value) {
+        if (c == '"' || c == '\\') result += '\\';
+        result += c;
+    }
+    return result + "\"";
+}
+
+void writeJson(const std::string& path, const BenchmarkOptions& options, const std::vector<SetSummary>& sets,
+               const std::vector<ScalingResult>& scaling) {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("Cannot write " + path);
+
+    char timestamp[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    out << "{\n";
+    out << "  \"label\": " << jsonString(options.label) << ",\n";
+    out << "  \"timestamp\": \"" << timestamp << "\",\n";
+    out << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "  \"instances_per_set\": " << options.instances << ",\n";
+    out << "  \"search_ms\": " << options.searchMs << ",\n";
+    out << "  \"sets\": [\n";
+    for (size_t i = 0; i < sets.size(); i++) {
+        const SetSummary& set = sets[i];
+        char line[512];
+        std::snprintf(line, sizeof(line),
+                      "    {\"name\": %s, \"instances\": %zu, \"mean_utilisation\": %.5f, \"min_utilisation\": %.5f, "
+                      "\"max_utilisation\": %.5f, \"mean_ms\": %.3f, \"p95_ms\": %.3f}%s\n",
+                      jsonString(set.name).c_str(), set.instances, set.meanUtilisation, set.minUtilisation,
+                      set.maxUtilisation, set.meanMs, set.p95Ms, i + 1 < sets.size() ? "," : "");
+        out << line;
+    }
+    out << "  ],\n";
+    out << "  \"scaling\": [\n";
+    for (size_t i = 0; i < scaling.size(); i++) {
+        char line[256];
+        std::snprintf(line, sizeof(line), "    {\"threads\": %zu, \"seconds\": %.4f, \"instances_per_second\": %.2f}%s\n",
+                      scaling[i].threads, scaling[i].seconds, scaling[i].instancesPerSecond,
+                      i + 1 < scaling.size() ? "," : "");
+        out << line;
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+// Читает только то, что пишет writeJson: по одному объекту набора на строку
+std::vector<SetSummary> readBaseline(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("Cannot read baseline " + path);
+
+    auto number = [](const std::string& line, const char* key) {
+        size_t pos = line.find(std::string("\"") + key + "\":");
+        return pos == std::string::npos ? 0.0 : std::atof(line.c_str() + pos + std::strlen(key) + 3);
+    };
+
+    std::vector<SetSummary> sets;
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t name = line.find("{\"name\": \"");
+        if (name == std::string::npos) continue;
+        SetSummary set;
+        size_t begin = name + 10;
+        set.name = line.substr(begin, line.find('"', begin) - begin);
+        set.meanUtilisation = number(line, "mean_utilisation");
+        set.meanMs = number(line, "mean_ms");
+        sets.push_back(set);
+    }
+    return sets;
+}
+
+bool compareWithBaseline(const std::vector<SetSummary>& sets, const std::vector<SetSummary>& baseline) {
+    bool regressed = false;
+    for (const auto& old : baseline) {
+        auto current = std::find_if(sets.begin(), sets.end(), [&old](const SetSummary& set) { return set.name == old.name; });
+        if (current == sets.end()) continue;
+
+        bool quality = current->meanUtilisation < old.meanUtilisation - UTILISATION_TOLERANCE;
+        bool speed = current->meanMs > old.meanMs * TIME_TOLERANCE && current->meanMs - old.meanMs > TIME_NOISE_MS;
+        if (quality || speed) {
+            regressed = true;
+            std::printf("REGRESSION %-18s utilisation %.4f -> %.4f, time %.2f -> %.2f ms\n", old.name.c_str(),
+                        old.meanUtilisation, current->meanUtilisation, old.meanMs, current->meanMs);
+        }
+    }
+    return regressed;
+}
+
+bool parseArguments(int argc, char** argv, BenchmarkOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) return false;
+        std::string value = argv[++i];
+        if (arg == "--instances") {
+            options.instances = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--search") {
+            options.searchMs = std::max(0, std::atoi(value.c_str()));
+        } else if (arg == "--threads") {
+            std::stringstream list(value);
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                if (std::atoi(item.c_str()) > 0) options.threads.push_back(static_cast<size_t>(std::atoi(item.c_str())));
+            }
+        } else if (arg == "--out") {
+            options.output = value;
+        } else if (arg == "--baseline") {
+            options.baseline = value;
+        } else if (arg == "--label") {
+            options.label = value;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        std::cerr << "Usage: PackingBenchmark [--instances N] [--search ms] [--threads 1,2,4] [--out result.json]"
+                     " [--baseline old.json] [--label text]" << std::endl;
+        return 2;
+    }
+    if (options.threads.empty()) {
+        // 1, 2, 4... до числа аппаратных потоков включительно
+        size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t count = 1; count < hardware; count *= 2) options.threads.push_back(count);
+        options.threads.push_back(hardware);
+    }
+
+    try {
+        std::vector<Instance> instances;
+        for (int problemClass = 1; problemClass <= 15; problemClass++) {
+            for (int i = 0; i < options.instances; i++) instances.push_back(generateBr(problemClass, i));
+        }
+        for (const auto& truck : defaultTruckPresets()) {
+            for (int i = 0; i < options.instances; i++) instances.push_back(generateTruckOrder(truck, i));
+        }
+        for (const auto& truck : defaultTruckPresets()) {
+            for (int i = 0; i < options.instances; i++) instances.push_back(generateRollOrder(truck, i));
+        }
+        for (const auto& truck : defaultTruckPresets()) {
+            for (int i = 0; i < options.instances; i++) instances.push_back(generateHazmatOrder(truck, i));
+        }
+
+        // Качество и время одной задачи - последовательно, чтобы задачи не мешали друг другу
+        std::unique_ptr<ThreadPool> searchPool;
+        if (options.searchMs > 0) searchPool = std::make_unique<ThreadPool>();
+
+        std::vector<SetSummary> sets;
+        std::vector<InstanceResult> current;
+        for (size_t i = 0; i < instances.size(); i++) {
+            current.push_back(solveInstance(instances[i], options.searchMs, searchPool.get()));
+            if (i + 1 == instances.size() || instances[i + 1].set != instances[i].set) {
+                sets.push_back(summarise(instances[i].set, std::move(current)));
+                current.clear();
+                const SetSummary& set = sets.back();
+                std::printf("%-18s utilisation %.4f [%.4f..%.4f]  %8.2f ms (p95 %.2f)\n", set.name.c_str(),
+                            set.meanUtilisation, set.minUtilisation, set.maxUtilisation, set.meanMs, set.p95Ms);
+            }
+        }
+        searchPool.reset();
+
+        // Пропускная способность: независимые жадные упаковки на пуле
+        std::vector<ScalingResult> scaling;
+        for (size_t threads : options.threads) {
+            ThreadPool pool(threads);
+            auto start = std::chrono::steady_clock::now();
+            std::vector<std::future<InstanceResult>> results;
+            results.reserve(instances.size());
+            for (const auto& instance : instances) {
+                results.push_back(pool.async([&instance]() { return solveInstance(instance, 0, nullptr); }));
+            }
+            // get() передает исключение задачи в общий обработчик ошибок бенчмарка
+            for (auto& result : results) result.get();
+
+            ScalingResult result;
+            result.threads = threads;
+            result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            result.instancesPerSecond = static_cast<double>(instances.size()) / result.seconds;
+            scaling.push_back(result);
+            std::printf("threads %2zu: %.3f s, %.1f instances/s\n", threads, result.seconds, result.instancesPerSecond);
+        }
+
+        // Базовый файл читается до записи: --out и --baseline могут совпадать
+        std::vector<SetSummary> baseline;
+        if (!options.baseline.empty()) baseline = readBaseline(options.baseline);
+
+        writeJson(options.output, options, sets, scaling);
+        std::cout << "Results: " << options.output << std::endl;
+
+        if (!options.baseline.empty() && compareWithBaseline(sets, baseline)) return 1;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Benchmark error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,399 @@
+// Микробенчмарк отрисовки без видимого окна: сцена из тягача, колес и N коробок груза,
+// для каждого пути отрисовки - время формирования кадра на CPU и время GPU.
+//
+//   RenderBenchmark [--boxes 1000,10000,100000] [--frames N] [--warmup N] [--size WxH]
+//                   [--assets каталог] [--out render.json] [--osmesa]
+//
+// Пути:
+//   per_object - каждая коробка - свой GameObject (uniform model + glDrawElements);
+//   instanced  - все коробки одним Mesh::drawInstances;
+//   indirect   - Mesh::drawInstancesIndirect, по команде на полосу из 1024 коробок
+//                (только при GL 4.3, иначе путь пропускается).
+// Кадр рисуется во внеэкранный framebuffer, окно GLFW скрыто. В CI на Mesa llvmpipe:
+//   xvfb-run -a env LIBGL_ALWAYS_SOFTWARE=1 ./RenderBenchmark
+// С --osmesa (GLFW 3.4+) не нужен и X-сервер: контекст OSMesa на платформе GLFW "null".
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "graphics/Mesh.h"
+#include "graphics/Model.h"
+#include "graphics/Shader.h"
+#include "scene/GameObject.h"
+#include "scene/Scene.h"
+
+namespace {
+
+struct BenchmarkOptions {
+    std::vector<size_t> boxes = {1000, 10000, 100000};
+    int frames = 30;
+    int warmup = 5;
+    int width = 1280;
+    int height = 720;
+    std::string assets = "assets";
+    std::string output = "render_benchmark.json";
+    bool osmesa = false;
+};
+
+struct PathResult {
+    std::string path;
+    size_t boxes = 0;
+    size_t drawCalls = 0;
+    double cpuMeanMs = 0.0;
+    double cpuP95Ms = 0.0;
+    double gpuMeanMs = 0.0;      // < 0 - таймерные запросы недоступны
+};
+
+constexpr size_t LANE_SIZE = 1024;
+
+// Внеэкранная цель: результат не зависит от наличия и размера окна
+class Framebuffer {
+private:
+    GLuint framebuffer = 0;
+    GLuint color = 0;
+    GLuint depth = 0;
+
+public:
+    Framebuffer(int width, int height) {
+        glGenFramebuffers(1, &framebuffer);
+        glGenRenderbuffers(1, &color);
+        glGenRenderbuffers(1, &depth);
+
+        glBindRenderbuffer(GL_RENDERBUFFER, color);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, depth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            throw std::runtime_error("Offscreen framebuffer is incomplete");
+        }
+        glViewport(0, 0, width, height);
+    }
+
+    ~Framebuffer() {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &color);
+        glDeleteRenderbuffers(1, &depth);
+    }
+};
+
+// Груз - плотная решетка коробок внутри прицепа, камера видит ее целиком (без отсечения)
+void buildCargo(size_t count, std::vector<glm::mat4>& transforms, std::vector<glm::vec3>& colors) {
+    transforms.clear();
+    colors.clear();
+    transforms.reserve(count);
+    colors.reserve(count);
+
+    size_t side = static_cast<size_t>(std::ceil(std::cbrt(static_cast<double>(count))));
+    float step = 2.4f / static_cast<float>(side);
+    for (size_t i = 0; i < count; i++) {
+        size_t x = i % side;
+        size_t y = (i / side) % side;
+        size_t z = i / (side * side);
+
+        glm::vec3 position(-4.0f + step * (static_cast<float>(x) * 5.0f + 0.5f),
+                           step * (static_cast<float>(y) + 0.5f),
+                           -1.2f + step * (static_cast<float>(z) + 0.5f));
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
+        transforms.push_back(glm::scale(model, glm::vec3(step * 0.9f)));
+
+        // Та же палитра, что и у Scene::cargoColor: цвета повторяются по типам
+        float hue = static_cast<float>(i % 16) / 16.0f;
+        colors.push_back(glm::vec3(0.5f + 0.5f * std::sin(6.283f * hue),
+                                   0.5f + 0.5f * std::sin(6.283f * (hue + 0.33f)),
+                                   0.5f + 0.5f * std::sin(6.283f * (hue + 0.67f))));
+    }
+}
+
+std::shared_ptr<Model> loadBundledModel(const std::string& assets, const std::string& name) {
+    for (const char* extension : {".glb", ".obj"}) {
+        std::string path = assets + "/models/" + name + extension;
+        if (std::filesystem::exists(path)) return std::make_shared<Model>(path);
+    }
+    std::cerr << "Warning: model " << name << " not found in " << assets << "/models" << std::endl;
+    return nullptr;
+}
+
+void setFrameUniforms(const Shader& shader, int width, int height) {
+    glm::vec3 eye(2.0f, 4.0f, 9.0f);
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), static_cast<float>(width) / static_cast<float>(height),
+                                            0.1f, 100.0f);
+    glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f, 0.5f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    shader.use();
+    shader.setMat4("projection", projection);
+    shader.setMat4("view", view);
+    shader.setVec3("lightPos", glm::vec3(10.0f, 15.0f, 10.0f));
+    shader.setVec3("lightColor", glm::vec3(1.2f, 1.2f, 1.0f));
+    shader.setVec3("viewPos", eye);
+    shader.setVec3("ambientStrength", glm::vec3(0.3f, 0.3f, 0.3f));
+    shader.setFloat("materialBrightness", 1.0f);
+    shader.setBool("enhanceContrast", true);
+    shader.setBool("use_instancing", false);
+    shader.setBool("use_material_override", false);
+}
+
+// drawCargo рисует только груз; тягач и колеса - общие для всех путей
+PathResult measure(const std::string& path, size_t boxes, const BenchmarkOptions& options, const Shader& shader,
+                   const std::vector<GameObject>& vehicle, const std::function<size_t()>& drawCargo) {
+    GLuint query = 0;
+    bool timerQueries = GLAD_GL_VERSION_3_3 != 0;
+    if (timerQueries) glGenQueries(1, &query);
+
+    std::vector<double> cpu;
+    double gpuTotal = 0.0;
+    size_t drawCalls = 0;
+
+    for (int frame = 0; frame < options.warmup + options.frames; frame++) {
+        auto start = std::chrono::steady_clock::now();
+        if (timerQueries) glBeginQuery(GL_TIME_ELAPSED, query);
+
+        glClearColor(0.35f, 0.35f, 0.35f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        setFrameUniforms(shader, options.width, options.height);
+        for (const auto& object : vehicle) object.render(shader);
+
+        shader.setBool("use_material_override", path != "per_object");
+        drawCalls = drawCargo();
+        shader.setBool("use_material_override", false);
+
+        if (timerQueries) glEndQuery(GL_TIME_ELAPSED);
+        auto submitted = std::chrono::steady_clock::now();
+        glFinish();
+
+        if (frame < options.warmup) continue;
+        cpu.push_back(std::chrono::duration<double, std::milli>(submitted - start).count());
+        if (timerQueries) {
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+            gpuTotal += static_cast<double>(elapsed) * 1e-6;
+        }
+    }
+    if (timerQueries) glDeleteQueries(1, &query);
+
+    PathResult result;
+    result.path = path;
+    result.boxes = boxes;
+    result.drawCalls = drawCalls;
+    for (double ms : cpu) result.cpuMeanMs += ms;
+    result.cpuMeanMs /= static_cast<double>(cpu.size());
+    std::sort(cpu.begin(), cpu.end());
+    result.cpuP95Ms = cpu[std::min(cpu.size() - 1, static_cast<size_t>(std::ceil(0.95 * cpu.size())) - 1)];
+    result.gpuMeanMs = timerQueries ? gpuTotal / static_cast<double>(cpu.size()) : -1.0;
+    return result;
+}
+
+std::string jsonString(const std::string& value) {
+    std::string result = "\"";
+    for (char c : value) {
+        if (c == '"' || c == '\\') result += '\\';
+        result += c;
+    }
+    return result + "\"";
+}
+
+void writeJson(const std::string& path, const BenchmarkOptions& options, const std::vector<PathResult>& results) {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("Cannot write " + path);
+
+    const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    out << "{\n";
+    out << "  \"renderer\": " << jsonString(renderer ? renderer : "") << ",\n";
+    out << "  \"gl_version\": " << jsonString(version ? version : "") << ",\n";
+    out << "  \"width\": " << options.width << ",\n";
+    out << "  \"height\": " << options.height << ",\n";
+    out << "  \"frames\": " << options.frames << ",\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const PathResult& result = results[i];
+        char line[320];
+        std::snprintf(line, sizeof(line),
+                      "    {\"path\": %s, \"boxes\": %zu, \"cargo_draw_calls\": %zu, \"cpu_ms_mean\": %.4f, "
+                      "\"cpu_ms_p95\": %.4f, \"gpu_ms_mean\": %.4f}%s\n",
+                      jsonString(result.path).c_str(), result.boxes, result.drawCalls, result.cpuMeanMs,
+                      result.cpuP95Ms, result.gpuMeanMs, i + 1 < results.size() ? "," : "");
+        out << line;
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+bool parseArguments(int argc, char** argv, BenchmarkOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--osmesa") {
+            options.osmesa = true;
+            continue;
+        }
+        if (i + 1 >= argc) return false;
+        std::string value = argv[++i];
+        if (arg == "--boxes") {
+            options.boxes.clear();
+            std::stringstream list(value);
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                if (std::atol(item.c_str()) > 0) options.boxes.push_back(static_cast<size_t>(std::atol(item.c_str())));
+            }
+        } else if (arg == "--frames") {
+            options.frames = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--warmup") {
+            options.warmup = std::max(0, std::atoi(value.c_str()));
+        } else if (arg == "--size") {
+            if (std::sscanf(value.c_str(), "%dx%d", &options.width, &options.height) != 2) return false;
+        } else if (arg == "--assets") {
+            options.assets = value;
+        } else if (arg == "--out") {
+            options.output = value;
+        } else {
+            return false;
+        }
+    }
+    return !options.boxes.empty() && options.width > 0 && options.height > 0;
+}
+
+GLFWwindow* createHiddenContext(const BenchmarkOptions& options) {
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+    if (options.osmesa) glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#else
+    if (options.osmesa) throw std::runtime_error("--osmesa needs GLFW 3.4 or newer");
+#endif
+    if (!glfwInit()) throw std::runtime_error("Failed to initialize GLFW");
+
+    // Сначала 4.3 ради indirect-пути, затем 3.3 - минимум для шейдеров симулятора
+    const int versions[2][2] = {{4, 3}, {3, 3}};
+    for (const auto& version : versions) {
+        glfwDefaultWindowHints();
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, version[0]);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, version[1]);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        if (options.osmesa) glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+
+        GLFWwindow* window = glfwCreateWindow(options.width, options.height, "RenderBenchmark", nullptr, nullptr);
+        if (window) return window;
+    }
+    glfwTerminate();
+    throw std::runtime_error("Failed to create an OpenGL 3.3 context");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchmarkOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        std::cerr << "Usage: RenderBenchmark [--boxes 1000,10000,100000] [--frames N] [--warmup N] [--size WxH]"
+                     " [--assets dir] [--out render.json] [--osmesa]" << std::endl;
+        return 2;
+    }
+
+    GLFWwindow* window = nullptr;
+    try {
+        window = createHiddenContext(options);
+        glfwMakeContextCurrent(window);
+        glfwSwapInterval(0);
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+            throw std::runtime_error("Failed to initialize GLAD");
+        }
+        std::cout << "Renderer: " << glGetString(GL_RENDERER) << ", GL " << glGetString(GL_VERSION) << std::endl;
+
+        std::vector<PathResult> results;
+        {
+            Framebuffer target(options.width, options.height);
+            glEnable(GL_DEPTH_TEST);
+            glEnable(GL_CULL_FACE);
+
+            Shader shader((options.assets + "/shaders/model.vs").c_str(), (options.assets + "/shaders/model.fs").c_str());
+
+            // Тягач и колеса как в Scene: по GameObject на модель
+            std::vector<GameObject> vehicle;
+            const std::pair<const char*, glm::vec3> parts[2] = {
+                {"lorry", glm::vec3(-4.0f, -1.25f, 0.0f)},
+                {"weel", glm::vec3(0.5f, -1.25f, 0.0f)}
+            };
+            for (const auto& part : parts) {
+                std::shared_ptr<Model> model = loadBundledModel(options.assets, part.first);
+                if (!model) continue;
+                GameObject object(part.first);
+                object.setModel(model);
+                object.transform.position = part.second;
+                vehicle.push_back(object);
+            }
+
+            std::shared_ptr<Model> boxModel = std::make_shared<Model>(Scene::createUnitCube());
+            std::unique_ptr<Mesh> cargoMesh = Scene::createUnitCube();
+
+            std::vector<glm::mat4> transforms;
+            std::vector<glm::vec3> colors;
+            for (size_t boxes : options.boxes) {
+                buildCargo(boxes, transforms, colors);
+
+                std::vector<GameObject> objects(boxes);
+                for (size_t i = 0; i < boxes; i++) {
+                    objects[i].setModel(boxModel);
+                    objects[i].transform.position = glm::vec3(transforms[i][3]);
+                    objects[i].transform.scale = glm::vec3(transforms[i][0][0]);
+                }
+                cargoMesh->setInstances(transforms, colors);
+
+                std::vector<std::pair<size_t, size_t>> lanes;
+                for (size_t first = 0; first < boxes; first += LANE_SIZE) {
+                    lanes.emplace_back(first, std::min(LANE_SIZE, boxes - first));
+                }
+
+                results.push_back(measure("per_object", boxes, options, shader, vehicle, [&]() {
+                    for (const auto& object : objects) object.render(shader);
+                    return objects.size();
+                }));
+                results.push_back(measure("instanced", boxes, options, shader, vehicle, [&]() {
+                    cargoMesh->drawInstances(shader, 0, boxes);
+                    return size_t(1);
+                }));
+                if (Mesh::supportsIndirect()) {
+                    results.push_back(measure("indirect", boxes, options, shader, vehicle, [&]() {
+                        cargoMesh->drawInstancesIndirect(shader, lanes);
+                        return size_t(1);
+                    }));
+                }
+
+                for (size_t r = results.size() - (Mesh::supportsIndirect() ? 3 : 2); r < results.size(); r++) {
+                    const PathResult& result = results[r];
+                    std::printf("%-10s %7zu boxes: cpu %8.3f ms (p95 %8.3f), gpu %8.3f ms, %zu cargo draw calls\n",
+                                result.path.c_str(), result.boxes, result.cpuMeanMs, result.cpuP95Ms,
+                                result.gpuMeanMs, result.drawCalls);
+                }
+            }
+        }
+
+        writeJson(options.output, options, results);
+        std::cout << "Results: " << options.output << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Render benchmark error: " << e.what() << std::endl;
+        if (window) glfwDestroyWindow(window);
+        glfwTerminate();
+        return -1;
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
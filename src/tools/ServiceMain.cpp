@@ -0,0 +1,126 @@
+// Резидентный решатель: держит таблицу SKU и пресеты прицепов в памяти и отвечает
+// на запросы "поместится ли" по локальному сокету (протокол - в SolverService.h).
+//
+//   TruckLoadingService [--socket путь | --port N] [--skus skus.csv] [--trucks trucks.csv]
+//                       [--rules segregation.csv] [--jobs N] [--batch N] [--window мкс] [--cache N] [--clients N] [--max-items N]
+//
+// Без --socket и --port слушает 127.0.0.1:7878, без --rules действуют правила
+// совместимости классов симулятора.
+
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "io/ManifestImporter.h"
+#include "io/SegregationPresets.h"
+#include "io/TruckPresets.h"
+#include "packing/ThreadPool.h"
+#include "service/SocketServer.h"
+#include "service/SolverService.h"
+
+namespace {
+
+struct DaemonOptions {
+    std::string socketPath;
+    uint16_t port = 7878;
+    std::string skus;
+    std::string trucks;
+    std::string rules;
+    size_t jobs = 0;
+    size_t clients = 64;
+    ServiceOptions service;
+};
+
+SocketServer* activeServer = nullptr;
+
+void handleSignal(int) {
+    if (activeServer) activeServer->stop();
+}
+
+void printUsage() {
+    std::cerr << "Usage: TruckLoadingService [--socket path | --port N] [--skus skus.csv] [--trucks trucks.csv]"
+                 " [--rules segregation.csv] [--jobs N] [--batch N] [--window us] [--cache N] [--clients N] [--max-items N]" << std::endl;
+}
+
+bool parseArguments(int argc, char** argv, DaemonOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) return false;
+        const char* value = argv[++i];
+        if (arg == "--socket") {
+            options.socketPath = value;
+        } else if (arg == "--port") {
+            options.port = static_cast<uint16_t>(std::strtoul(value, nullptr, 10));
+        } else if (arg == "--skus") {
+            options.skus = value;
+        } else if (arg == "--trucks") {
+            options.trucks = value;
+        } else if (arg == "--rules") {
+            options.rules = value;
+        } else if (arg == "--jobs") {
+            options.jobs = static_cast<size_t>(std::strtoul(value, nullptr, 10));
+        } else if (arg == "--batch") {
+            options.service.maxBatch = std::max<size_t>(1, std::strtoul(value, nullptr, 10));
+        } else if (arg == "--window") {
+            options.service.batchWindow = std::chrono::microseconds(std::strtoul(value, nullptr, 10));
+        } else if (arg == "--cache") {
+            options.service.cacheSize = static_cast<size_t>(std::strtoul(value, nullptr, 10));
+        } else if (arg == "--clients") {
+            options.clients = std::max<size_t>(1, std::strtoul(value, nullptr, 10));
+        } else if (arg == "--max-items") {
+            options.service.maxItems = std::max(1LL, std::strtoll(value, nullptr, 10));
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    DaemonOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    try {
+        options.service.packer.segregation = options.rules.empty() ? defaultSegregationRules()
+                                                                   : readSegregationRules(options.rules);
+        ThreadPool pool(options.jobs);
+        SolverService service(pool, options.service);
+
+        for (const auto& truck : options.trucks.empty() ? defaultTruckPresets() : readTruckPresets(options.trucks)) {
+            service.addTruck(truck.name, truck.trailer);
+        }
+        if (!options.skus.empty()) {
+            ImportReport report;
+            service.setSkuTable(ManifestImporter(&pool).load(options.skus, &report));
+            std::cout << "Loaded " << report.types << " SKUs from " << options.skus << std::endl;
+        }
+
+        SocketServer server(service, options.clients);
+        if (!options.socketPath.empty()) {
+            server.listenUnix(options.socketPath);
+            std::cout << "Listening on " << options.socketPath << std::endl;
+        } else {
+            server.listenTcp(options.port);
+            std::cout << "Listening on 127.0.0.1:" << options.port << std::endl;
+        }
+
+        activeServer = &server;
+        std::signal(SIGINT, handleSignal);
+        std::signal(SIGTERM, handleSignal);
+
+        service.start();
+        server.run();
+        activeServer = nullptr;
+        service.stop();
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Service error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#pragma once
+
+#include <cstdio>
+
+// Минимальные проверки для тестов ядра: без фреймворка, код возврата - число ошибок
+namespace check {
+inline int failures = 0;
+}
+
+#define CHECK(condition)                                                              \
+    do {                                                                              \
+        if (!(condition)) {                                                           \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            check::failures++;                                                        \
+        }                                                                             \
+    } while (0)
+
+#define CHECK_THROWS(expression)                                                      \
+    do {                                                                              \
+        bool thrown = false;                                                          \
+        try {                                                                         \
+            expression;                                                               \
+        } catch (...) {                                                               \
+            thrown = true;                                                            \
+        }                                                                             \
+        if (!thrown) {                                                                \
+            std::fprintf(stderr, "%s:%d: %s did not throw\n", __FILE__, __LINE__, #expression); \
+            check::failures++;                                                        \
+        }                                                                             \
+    } while (0)
+
+#endif //CHECK_H
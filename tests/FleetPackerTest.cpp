@@ -0,0 +1,55 @@
+// Распределение по парку: груз, который не помещается ни в одну машину,
+// уходит в unplaced и не порождает пустых рейсов
+#include "packing/FleetPacker.h"
+#include "Check.h"
+
+namespace {
+
+BoxType makeType(const char* sku, int width, int height, int depth) {
+    BoxType type;
+    type.sku = sku;
+    type.width = width;
+    type.height = height;
+    type.depth = depth;
+    type.weight = 10.0f;
+    return type;
+}
+
+void oversizedBoxWithUnlimitedVehicle(ThreadPool& pool) {
+    Manifest manifest;
+    manifest.addItems(manifest.addType(makeType("huge", 5000, 400, 400)), 1);
+    manifest.addItems(manifest.addType(makeType("small", 100, 100, 100)), 3);
+
+    FleetVehicle vehicle;
+    vehicle.name = "unlimited";
+    vehicle.trailer = TrailerSpec{1360, 260, 245};
+    vehicle.available = -1;
+
+    FleetPlan plan = FleetPacker(manifest, {vehicle}, pool).pack();
+    CHECK(plan.loads.size() == 1);
+    CHECK(plan.placedCount() == 3);
+    CHECK(plan.unplaced.size() == 1);
+    CHECK(plan.totalCost == vehicle.cost);
+}
+
+void onlyOversizedBoxes(ThreadPool& pool) {
+    Manifest manifest;
+    manifest.addItems(manifest.addType(makeType("huge", 5000, 400, 400)), 2);
+
+    FleetVehicle small{"small", TrailerSpec{590, 239, 235}, -1, 1.0, {}};
+    FleetVehicle large{"large", TrailerSpec{1360, 260, 245}, -1, 2.0, {}};
+
+    FleetPlan plan = FleetPacker(manifest, {small, large}, pool).pack();
+    CHECK(plan.loads.empty());
+    CHECK(plan.unplaced.size() == 2);
+    CHECK(plan.totalCost == 0.0);
+}
+
+} // namespace
+
+int main() {
+    ThreadPool pool(2);
+    oversizedBoxWithUnlimitedVehicle(pool);
+    onlyOversizedBoxes(pool);
+    return check::failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+// Импорт манифеста: количества, размеры и масса проверяются до приведения к целому,
+// ошибка указывает номер строки, манифест сверх предела не загружается
+#include "io/ManifestImporter.h"
+#include <stdexcept>
+#include <string>
+#include "Check.h"
+
+namespace {
+
+void rowQuantityOverLimit() {
+    std::string csv =
+        "sku,width,height,depth,weight,quantity\n"
+        "A,50,40,30,10,5\n"
+        "B,50,40,30,10,3000000000\n"
+        "C,50,40,30,10,1e300\n"
+        "A,50,40,30,10,2\n";
+
+    ImportReport report;
+    Manifest manifest = ManifestImporter().parse(csv, false, &report);
+    CHECK(report.rows == 4);
+    CHECK(report.skipped == 2);
+    CHECK(manifest.types.size() == 1);
+    CHECK(manifest.items.size() == 7);
+    CHECK(report.firstError.compare(0, 7, "line 3:") == 0);
+}
+
+void negativeQuantityInJson() {
+    std::string json = "[\n{\"sku\": \"A\", \"width\": 10, \"height\": 10, \"depth\": 10, \"qty\": 1},\n"
+                       "{\"sku\": \"B\", \"width\": 10, \"height\": 10, \"depth\": 10, \"qty\": -4}\n]";
+
+    ImportReport report;
+    Manifest manifest = ManifestImporter().parse(json, true, &report);
+    CHECK(report.skipped == 1);
+    CHECK(manifest.items.size() == 1);
+    CHECK(report.firstError.compare(0, 7, "line 3:") == 0);
+}
+
+void nonFiniteFields() {
+    // "nan" и "inf" разбираются from_chars, но NaN в ключе типа не равен сам себе
+    std::string csv =
+        "sku,width,height,depth,weight,quantity\n"
+        "A,10,10,10,nan,1\n"
+        "A,10,10,10,nan,1\n"
+        "A,10,10,10,5,1\n"
+        "B,inf,10,10,5,1\n"
+        "C,10,10,10,5,-inf\n";
+
+    ImportReport report;
+    Manifest manifest = ManifestImporter().parse(csv, false, &report);
+    CHECK(report.rows == 5);
+    CHECK(report.skipped == 4);
+    CHECK(manifest.types.size() == 1);
+    CHECK(manifest.items.size() == 1);
+    CHECK(report.firstError.compare(0, 7, "line 2:") == 0);
+}
+
+void dimensionsOverLimit() {
+    // Размер сверх int отбрасывается до округления, как и огромная масса
+    std::string json = "[\n{\"sku\": \"A\", \"width\": 1e12, \"height\": 10, \"depth\": 10},\n"
+                       "{\"sku\": \"B\", \"width\": 10, \"height\": 10, \"depth\": 10, \"weight\": 1e30},\n"
+                       "{\"sku\": \"C\", \"width\": 10, \"height\": 10, \"depth\": 10, \"weight\": 2}\n]";
+
+    ImportReport report;
+    Manifest manifest = ManifestImporter().parse(json, true, &report);
+    CHECK(report.skipped == 2);
+    CHECK(manifest.types.size() == 1);
+    CHECK(manifest.types[0].sku == "C");
+    CHECK(report.firstError.compare(0, 7, "line 2:") == 0);
+}
+
+void totalOverLimit() {
+    // Каждая строка в пределе, сумма по типу - нет; куски разбираются на пуле
+    std::string csv = "sku,width,height,depth,quantity\n";
+    for (int i = 0; i < 3; i++) csv += "A,50,40,30,4000000\n";
+
+    ThreadPool pool(2);
+    ManifestImporter importer(&pool);
+    importer.setChunkSize(16);
+    CHECK_THROWS(importer.parse(csv, false));
+}
+
+} // namespace
+
+int main() {
+    rowQuantityOverLimit();
+    negativeQuantityInJson();
+    nonFiniteFields();
+    dimensionsOverLimit();
+    totalOverLimit();
+    return check::failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,171 @@
+// Снятие коробок с рабочего состояния: после place -> removeLast -> place
+// состояние совпадает с упакованным заново, а сборка поддона добирает
+// освободившееся после снятия перегруза место легкими коробками
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include "packing/PackState.h"
+#include "packing/Packer.h"
+#include "packing/PalletBuilder.h"
+#include "Check.h"
+
+namespace {
+
+BoxType makeType(const char* sku, int width, int height, int depth, float weight) {
+    BoxType type;
+    type.sku = sku;
+    type.width = width;
+    type.height = height;
+    type.depth = depth;
+    type.weight = weight;
+    return type;
+}
+
+Manifest mixedManifest() {
+    Manifest manifest;
+    manifest.addItems(manifest.addType(makeType("large", 120, 80, 100, 200.0f)), 6, 1);
+    manifest.addItems(manifest.addType(makeType("medium", 60, 50, 40, 40.0f)), 12, 0);
+    manifest.addItems(manifest.addType(makeType("small", 30, 30, 30, 8.0f)), 20, 1);
+    manifest.addItems(manifest.addType(makeType("flat", 100, 20, 80, 25.0f)), 8, 0);
+    return manifest;
+}
+
+bool samePlacements(const std::vector<Placement>& a, const std::vector<Placement>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].item != b[i].item || a[i].x != b[i].x || a[i].y != b[i].y || a[i].z != b[i].z ||
+            a[i].width != b[i].width || a[i].height != b[i].height || a[i].depth != b[i].depth) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sameSpaces(const PackState& a, const PackState& b) {
+    auto key = [](const FreeSpaceIndex::Space& s) {
+        return std::make_tuple(s.minX, s.minY, s.minZ, s.maxX, s.maxY, s.maxZ);
+    };
+    auto less = [&](const FreeSpaceIndex::Space& l, const FreeSpaceIndex::Space& r) { return key(l) < key(r); };
+    std::vector<FreeSpaceIndex::Space> left = a.getFreeSpace().getSpaces();
+    std::vector<FreeSpaceIndex::Space> right = b.getFreeSpace().getSpaces();
+    std::sort(left.begin(), left.end(), less);
+    std::sort(right.begin(), right.end(), less);
+    if (left.size() != right.size()) return false;
+    for (size_t i = 0; i < left.size(); i++) {
+        if (key(left[i]) != key(right[i])) return false;
+    }
+    return true;
+}
+
+bool sameLoads(const PackState& a, const PackState& b) {
+    const SupportGraph& left = a.getSupports();
+    const SupportGraph& right = b.getSupports();
+    if (left.size() != right.size()) return false;
+    for (uint32_t node = 0; node < left.size(); node++) {
+        if (std::fabs(left.getLoadOnTop(node) - right.getLoadOnTop(node)) > 0.01f) return false;
+    }
+    return std::fabs(a.getBalance().getMass() - b.getBalance().getMass()) < 0.01 &&
+           std::fabs(a.getBalance().centerX() - b.getBalance().centerX()) < 0.01 &&
+           std::fabs(a.getBalance().centerY() - b.getBalance().centerY()) < 0.01 &&
+           std::fabs(a.getBalance().centerZ() - b.getBalance().centerZ()) < 0.01;
+}
+
+void removeThenPlaceMatchesFreshPack() {
+    Manifest manifest = mixedManifest();
+    Packer packer(manifest);
+    TrailerSpec trailer{400, 200, 240};
+    std::vector<uint32_t> order = packer.defaultOrder();
+
+    PackState fresh = packer.createState(trailer);
+    LoadPlan freshPlan;
+    freshPlan.trailer = trailer;
+    for (uint32_t item : order) packer.placeItem(fresh, item, freshPlan);
+
+    // Та же последовательность, но каждые несколько коробок последние снимаются
+    // и ставятся снова
+    PackState live = packer.createState(trailer);
+    LoadPlan livePlan;
+    livePlan.trailer = trailer;
+    for (size_t i = 0; i < order.size(); i++) {
+        packer.placeItem(live, order[i], livePlan);
+        if (i % 5 != 4) continue;
+
+        std::vector<uint32_t> removed;
+        while (removed.size() < 3 && !livePlan.placements.empty()) {
+            uint32_t item = livePlan.placements.back().item;
+            CHECK(live.removeLast(manifest.typeOf(item), manifest.stopOf(item)));
+            livePlan.placements.pop_back();
+            removed.push_back(item);
+        }
+        for (auto it = removed.rbegin(); it != removed.rend(); ++it) packer.placeItem(live, *it, livePlan);
+    }
+
+    CHECK(!freshPlan.placements.empty());
+    CHECK(samePlacements(freshPlan.placements, livePlan.placements));
+    CHECK(samePlacements(fresh.getPlacements(), live.getPlacements()));
+    CHECK(sameSpaces(fresh, live));
+    CHECK(sameLoads(fresh, live));
+}
+
+void removeRestoresEarlierState() {
+    Manifest manifest = mixedManifest();
+    Packer packer(manifest);
+    TrailerSpec trailer{400, 200, 240};
+    std::vector<uint32_t> order = packer.defaultOrder();
+    size_t prefix = order.size() / 2;
+
+    PackState fresh = packer.createState(trailer);
+    LoadPlan freshPlan;
+    for (size_t i = 0; i < prefix; i++) packer.placeItem(fresh, order[i], freshPlan);
+
+    PackState live = packer.createState(trailer);
+    LoadPlan livePlan;
+    for (uint32_t item : order) packer.placeItem(live, item, livePlan);
+    while (live.getPlacements().size() > fresh.getPlacements().size()) {
+        uint32_t item = live.getPlacements().back().item;
+        CHECK(live.removeLast(manifest.typeOf(item), manifest.stopOf(item)));
+    }
+
+    CHECK(samePlacements(fresh.getPlacements(), live.getPlacements()));
+    CHECK(sameSpaces(fresh, live));
+    CHECK(sameLoads(fresh, live));
+
+    // Пустое состояние снимать нечего
+    PackState empty = packer.createState(trailer);
+    CHECK(!empty.removeLast(manifest.typeOf(0), 0));
+}
+
+void overweightPalletIsToppedUpWithLightCartons(ThreadPool& pool) {
+    Manifest manifest;
+    manifest.addItems(manifest.addType(makeType("heavy", 60, 40, 40, 300.0f)), 6);
+    manifest.addItems(manifest.addType(makeType("light", 30, 20, 20, 5.0f)), 40);
+
+    PalletOptions options;
+    options.specs = {PalletSpec::euro()};
+    PalletizedPlan plan = PalletBuilder(manifest, options, pool).build(TrailerSpec{1360, 260, 245});
+
+    CHECK(!plan.built.empty());
+    CHECK(plan.unpalletised.empty());
+    for (const auto& pallet : plan.built) {
+        float cargo = 0.0f;
+        size_t heavy = 0;
+        for (const auto& placement : pallet.cartons.placements) {
+            cargo += manifest.typeOf(placement.item).weight;
+            if (manifest.typeOf(placement.item).sku == "heavy") heavy++;
+        }
+        CHECK(cargo <= options.specs[0].maxWeight);
+        // Три тяжелые коробки оставляют 100 кг - это двадцать легких
+        CHECK(heavy == 3 && pallet.cartons.placements.size() == 23);
+    }
+    CHECK(plan.built.size() == 2);
+}
+
+} // namespace
+
+int main() {
+    ThreadPool pool(2);
+    removeThenPlaceMatchesFreshPack();
+    removeRestoresEarlierState();
+    overweightPalletIsToppedUpWithLightCartons(pool);
+    return check::failures == 0 ? 0 : 1;
+}
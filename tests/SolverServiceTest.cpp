@@ -0,0 +1,69 @@
+// Совместимость классов в сервисе: несовместимые коробки расходятся на зазор правил,
+// а если в кузове на него не хватает места, заказ не помещается
+#include <string>
+#include "service/SolverService.h"
+#include "io/SegregationPresets.h"
+#include "Check.h"
+
+namespace {
+
+std::string ask(SolverService& service, const std::string& line) {
+    return service.submit(line).get();
+}
+
+bool fits(const std::string& response) {
+    return response.compare(0, 5, "OK 1 ") == 0;
+}
+
+void separatedClassesNeedDistance(ThreadPool& pool) {
+    ServiceOptions options;
+    options.packer.segregation = defaultSegregationRules();
+    SolverService service(pool, options);
+    service.start();
+
+    // Взрывчатые (1) и легковоспламеняющиеся (2) - не ближе 6 м: класс 2 встает
+    // только за обычным грузом, который отодвигает его от класса 1
+    CHECK(!fits(ask(service, "FITBOX 500x260x245 100x100x100#1*1 100x100x100#2*1")));
+    CHECK(!fits(ask(service, "FITBOX 800x260x245 200x200x200#1*1 100x260x245*5 100x100x100#2*1")));
+    CHECK(fits(ask(service, "FITBOX 1000x260x245 200x200x200#1*1 100x260x245*7 100x100x100#2*1")));
+    CHECK(fits(ask(service, "FITBOX 500x260x245 100x100x100#1*1 100x100x100#1*1")));
+    CHECK(ask(service, "FITBOX 500x260x245 100x100x100#64*1").compare(0, 4, "ERR ") == 0);
+    service.stop();
+}
+
+void skuClassesFromTable(ThreadPool& pool) {
+    Manifest table;
+    BoxType hazard;
+    hazard.sku = "oxidizer";
+    hazard.width = hazard.height = hazard.depth = 100;
+    hazard.compatibilityClass = 3;
+    BoxType food = hazard;
+    food.sku = "food";
+    food.compatibilityClass = 4;
+    table.addType(hazard);
+    table.addType(food);
+
+    // Окислитель и продукты не должны касаться: вплотную помещаются только без правил
+    ServiceOptions options;
+    SolverService unrestricted(pool, options);
+    unrestricted.setSkuTable(table);
+    unrestricted.start();
+    CHECK(fits(ask(unrestricted, "FIT 200x100x100 oxidizer food")));
+    unrestricted.stop();
+
+    options.packer.segregation = defaultSegregationRules();
+    SolverService service(pool, options);
+    service.setSkuTable(table);
+    service.start();
+    CHECK(!fits(ask(service, "FIT 200x100x100 oxidizer food")));
+    service.stop();
+}
+
+} // namespace
+
+int main() {
+    ThreadPool pool(2);
+    separatedClassesNeedDistance(pool);
+    skuClassesFromTable(pool);
+    return check::failures == 0 ? 0 : 1;
+}